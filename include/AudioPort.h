@@ -129,6 +129,10 @@ private:
 	bool m_extOutputEnabled;
 	fx_ch_t m_nextFxChannel;
 
+	// last output slot of MixerWorkerThread claimed for this port in
+	// current period (-1 = none)
+	AtomicInt m_lastOutputSlot;
+
 	QString m_name;
 	
 	EffectChain * m_effects;
@@ -26,12 +26,10 @@
 #ifndef _AUDIO_SAMPLE_RECORDER_H
 #define _AUDIO_SAMPLE_RECORDER_H
 
-#include <QtCore/QList>
-#include <QtCore/QPair>
-
 #include "AudioDevice.h"
 
 class SampleBuffer;
+class SampleStreamWriter;
 
 
 class AudioSampleRecorder : public AudioDevice
@@ -50,8 +48,11 @@ private:
 						const fpp_t _frames,
 						const float _master_gain );
 
-	typedef QList<QPair<sampleFrame *, fpp_t> > BufferList;
-	BufferList m_buffers;
+	// recorded frames are streamed to disk while recording
+	SampleStreamWriter * m_writer;
+	// surround frames are converted into this buffer before writing
+	sampleFrame * m_buffer;
+	fpp_t m_bufferSize;
 
 } ;
 
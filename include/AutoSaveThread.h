@@ -0,0 +1,60 @@
+/*
+ * AutoSaveThread.h - writes recovery files in background
+ *
+ * Copyright (c) 2014 Tobias Doerffel <tobydox/at/users.sourceforge.net>
+ *
+ * This file is part of Linux MultiMedia Studio - http://lmms.sourceforge.net
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef AUTO_SAVE_THREAD_H
+#define AUTO_SAVE_THREAD_H
+
+#include <QtCore/QString>
+#include <QtCore/QThread>
+
+class DataFile;
+
+
+/*! \brief Serializes, compresses and writes a project snapshot to disk
+ *
+ * The snapshot (a DataFile filled by song::saveProjectData()) is created
+ * in GUI thread which is cheap compared to generating the XML text,
+ * compressing and syncing it to disk - that part is done here.
+ */
+class AutoSaveThread : public QThread
+{
+public:
+	AutoSaveThread();
+	virtual ~AutoSaveThread();
+
+	// takes ownership of dataFile - returns false if a previous save is
+	// still in progress, in which case dataFile is deleted
+	bool save( DataFile * dataFile, const QString & fileName );
+
+
+private:
+	virtual void run();
+
+	DataFile * m_dataFile;
+	QString m_fileName;
+
+} ;
+
+
+#endif
@@ -188,6 +188,10 @@ public:
 		m_centerValue = centerVal;
 	}
 
+	/*! \brief Records current value in project journal - much cheaper
+				than a full snapshot of the model */
+	virtual void addJournalCheckPoint();
+
 	static void linkModels( AutomatableModel* m1, AutomatableModel* m2 );
 	static void unlinkModels( AutomatableModel* m1, AutomatableModel* m2 );
 
@@ -273,6 +277,9 @@ private:
 	static float s_copiedValue;
 
 
+	friend class ProjectJournal;
+
+
 signals:
 	void initValueChanged( float val );
 	void destroyed( jo_id_t id );
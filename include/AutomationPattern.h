@@ -86,6 +86,13 @@ public:
 
 	void applyDragValue();
 
+	// putting many values (importers, paste): between beginBatchEdit() and
+	// commitBatchEdit() the mixer stays locked and putValue() only stores
+	// the value - tangents, length and change signal are updated once at
+	// commit; calls may be nested
+	void beginBatchEdit();
+	void commitBatchEdit();
+
 
 	bool isDragging() const
 	{
@@ -180,6 +187,8 @@ private:
 
 	bool m_dragging;
 
+	int m_batchEditDepth;
+
 	static const float DEFAULT_MIN_VALUE;
 	static const float DEFAULT_MAX_VALUE;
 
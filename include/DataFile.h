@@ -27,6 +27,10 @@
 #ifndef DATA_FILE_H
 #define DATA_FILE_H
 
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
 #include <QtXml/QDomDocument>
 #include <QTextStream>
 
@@ -34,6 +38,9 @@
 #include "lmms_basics.h"
 
 
+class QFile;
+
+
 class EXPORT DataFile : public QDomDocument
 {
 public:
@@ -60,7 +67,9 @@ public:
 	QString nameWithExtension( const QString& fn ) const;
 
 	void write( QTextStream& strm );
-	bool writeFile( const QString& fn );
+	// write document to given file - set showErrors to false when calling
+	// from a thread other than the GUI thread
+	bool writeFile( const QString& fn, bool showErrors = true );
 
 	QDomElement& content()
 	{
@@ -77,8 +86,48 @@ public:
 		return m_type;
 	}
 
+	// whether given attribute of element holds embedded binary data (e.g.
+	// of a sample) - either base64 encoded or as separate chunk of a
+	// binary project (*.mmpb)
+	static bool hasEmbeddedData( const QDomElement & element,
+											const QString & attribute );
+
+	// returns decoded data of given attribute - only valid as long as the
+	// DataFile the element belongs to exists
+	static QByteArray embeddedData( const QDomElement & element,
+											const QString & attribute );
+
+	// stores binary data in given attribute of element - base64 encoded
+	// unless element belongs to a DataFile which keeps embedded data raw
+	static void setEmbeddedData( QDomElement & element,
+						const QString & attribute, const QByteArray & data );
+
+	// keep data passed to setEmbeddedData() as is instead of base64
+	// encoding it - must be called before filling the document and the
+	// document must only be written via writeFile() afterwards
+	void setKeepEmbeddedDataRaw();
+
 
 private:
+	enum BinarySections
+	{
+		Section_End,
+		Section_Document,		// qCompress'ed XML document
+		Section_EmbeddedData	// raw data formerly stored as base64
+	} ;
+
+	DataFile( const DataFile & );
+
+	bool writeBinary( QIODevice & outDevice );
+	void loadBinary( const QString & sourceFile );
+
+	// base64 encode data kept by setEmbeddedData() into the document
+	void inlineEmbeddedData();
+
+	// returns embedded data with given ID - sections of binary projects
+	// are only mapped into memory (or read) when being accessed first
+	QByteArray embeddedDataChunk( int id );
+
 	static Type type( const QString& typeName );
 	static QString typeName( Type type );
 
@@ -100,6 +149,19 @@ private:
 	QDomElement m_head;
 	Type m_type;
 
+	// file of binary project - kept open as embedded data is mapped into
+	// memory instead of being read
+	QFile * m_binaryFile;
+	// offset and size of embedded data sections not accessed yet
+	QMap<int, QPair<qint64, qint64> > m_embeddedDataSections;
+	QMap<int, QByteArray> m_embeddedData;
+	bool m_keepEmbeddedDataRaw;
+
+	// files holding embedded data outside of the document - guarded by
+	// s_binaryFilesMutex as auto-save writes files in background
+	static QList<DataFile *> s_binaryFiles;
+	static QMutex s_binaryFilesMutex;
+
 } ;
 
 
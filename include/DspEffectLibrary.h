@@ -233,6 +233,16 @@ namespace DspEffectLibrary
 			m_ratio = _ratio;
 		}
 
+		// zeroes state once it has decayed below audibility so it doesn't
+		// end up as denormal - call once per period
+		void flushDenormals()
+		{
+			if( fabsf( m_cap ) < 1.0e-10f )
+			{
+				m_cap = 0.0f;
+			}
+		}
+
 	private:
 		FastBassBoost() :
 			m_cap( 0.0 )
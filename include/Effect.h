@@ -30,6 +30,7 @@
 #include "engine.h"
 #include "Mixer.h"
 #include "AutomatableModel.h"
+#include "Oversampler.h"
 #include "TempoSyncKnobModel.h"
 
 
@@ -165,8 +166,61 @@ public:
 
 
 protected:
+	/*! \brief Per-period view of a model for use in processing loops
+
+	    Reading a model's value for every frame is costly, so effects take
+	    one snapshot per period instead.  Models driven by a sample-exact
+	    controller are followed by a linear ramp from the value at the
+	    beginning to the value at the end of the period, so fast modulation
+	    does not turn into steps. */
+	class ValueRamp
+	{
+	public:
+		ValueRamp( const FloatModel & _model, const fpp_t _frames ) :
+			m_value( _model.value() ),
+			m_step( 0.0f )
+		{
+			if( _frames > 1 )
+			{
+				m_step = ( _model.value( _frames - 1 ) - m_value ) /
+								( _frames - 1 );
+			}
+		}
+
+		inline bool isConstant() const
+		{
+			return m_step == 0.0f;
+		}
+
+		inline float value() const
+		{
+			return m_value;
+		}
+
+		// returns current value and advances by one frame
+		inline float next()
+		{
+			const float v = m_value;
+			m_value += m_step;
+			return v;
+		}
+
+	private:
+		float m_value;
+		float m_step;
+
+	} ;
+
 	void checkGate( double _out_sum );
 
+	// calculates energy of given (output) buffer and checks it against gate
+	void checkGate( const sampleFrame * _buf, const fpp_t _frames );
+
+	// mixes _wet into _buf (which holds the dry signal) according to
+	// wet/dry knob
+	void mixDryWet( sampleFrame * _buf, const sampleFrame * _wet,
+							const fpp_t _frames );
+
 	virtual PluginView * instantiateView( QWidget * );
 
 	// some effects might not be capable of higher sample-rates so they can
@@ -192,9 +246,27 @@ protected:
 	}
 	void reinitSRC();
 
+	// nonlinear processing (waveshaping, distortion etc.) aliases less when
+	// running at a multiple of the engine's sample rate - effects opt in by
+	// processing the buffer returned by upsample() and passing it to
+	// downsample() afterwards, the factor follows the oversampling setting
+	// of current quality settings
+	sampleFrame * upsample( const sampleFrame * _buf, const fpp_t _frames );
+	inline void downsample( const sampleFrame * _buf, sampleFrame * _out,
+							const fpp_t _frames )
+	{
+		m_oversampler.downsample( _buf, _out, _frames );
+	}
+
+	inline int oversamplingFactor() const
+	{
+		return m_oversampler.factor();
+	}
+
 
 private:
 	EffectChain * m_parent;
+	Oversampler m_oversampler;
 	void resample( int _i, const sampleFrame * _src_buf,
 					sample_rate_t _src_sr,
 					sampleFrame * _dst_buf, sample_rate_t _dst_sr,
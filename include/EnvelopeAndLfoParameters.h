@@ -41,6 +41,8 @@ public:
 	class LfoInstances
 	{
 	public:
+		typedef QList<EnvelopeAndLfoParameters *> LfoList;
+
 		LfoInstances()
 		{
 		}
@@ -60,9 +62,12 @@ public:
 		void add( EnvelopeAndLfoParameters * lfo );
 		void remove( EnvelopeAndLfoParameters * lfo );
 
+		// returns all LFOs whose shape has to be computed for current
+		// period
+		LfoList activeLfos();
+
 	private:
 		QMutex m_lfoListMutex;
-		typedef QList<EnvelopeAndLfoParameters *> LfoList;
 		LfoList m_lfos;
 
 	} ;
@@ -90,6 +95,16 @@ public:
 		return m_used;
 	}
 
+	inline bool isLfoActive() const
+	{
+		return m_used && !m_lfoAmountIsZero;
+	}
+
+	// computes LFO shape for current period - called by mixer for all
+	// active LFOs before rendering any notes so fillLevel() only has to
+	// read the shape data afterwards
+	void updateLfoShapeData();
+
 
 	virtual void saveSettings( QDomDocument & _doc, QDomElement & _parent );
 	virtual void loadSettings( const QDomElement & _this );
@@ -115,6 +130,7 @@ public slots:
 
 protected:
 	void fillLfoLevel( float * _buf, f_cnt_t _frame, const fpp_t _frames );
+	inline float pahdLevel( f_cnt_t _frame ) const;
 
 
 private:
@@ -136,8 +152,17 @@ private:
 	float  m_amountAdd;
 	f_cnt_t m_pahdFrames;
 	f_cnt_t m_rFrames;
-	sample_t * m_pahdEnv;
-	sample_t * m_rEnv;
+
+	// envelope segments - levels are evaluated per period in fillLevel()
+	// instead of being stored for every single frame
+	f_cnt_t m_predelayFrames;
+	f_cnt_t m_attackFrames;
+	f_cnt_t m_holdFrames;
+	f_cnt_t m_decayFrames;
+	float m_attackStep;
+	float m_decayStep;
+	float m_releaseStep;
+	float m_peakLevel;
 
 
 	FloatModel m_lfoPredelayModel;
@@ -157,7 +182,6 @@ private:
 	float m_lfoAmount;
 	bool m_lfoAmountIsZero;
 	sample_t * m_lfoShapeData;
-	bool m_bad_lfoShapeData;
 	SampleBuffer m_userWave;
 
 	enum LfoShapes
@@ -170,10 +194,6 @@ private:
 		NumLfoShapes
 	} ;
 
-	sample_t lfoShapeSample( fpp_t _frame_offset );
-	void updateLfoShapeData();
-
-
 
 	friend class EnvelopeAndLfoView;
 	friend class FlpImport;
@@ -25,13 +25,26 @@
 #ifndef _FX_MIXER_H
 #define _FX_MIXER_H
 
+#include <QtCore/QVector>
+
 #include "Model.h"
 #include "Mixer.h"
 #include "EffectChain.h"
 #include "JournallingObject.h"
 
 
-const int NumFxChannels = 64;
+// send from one FX channel to another one
+struct FxSend
+{
+	FxSend( fx_ch_t _target, float _amount, Model * _parent );
+
+	fx_ch_t m_target;
+	FloatModel m_amountModel;
+
+} ;
+
+typedef QVector<FxSend *> FxSendVector;
+
 
 
 struct FxChannel
@@ -40,10 +53,14 @@ struct FxChannel
 	~FxChannel();
 
 	EffectChain m_fxChain;
+	// channels the output of this channel is sent to
+	FxSendVector m_sends;
 	bool m_used;
 	bool m_stillRunning;
 	float m_peakLeft;
 	float m_peakRight;
+	// NULL as long as the channel is idle - buffers of idle channels are
+	// given back to FxMixer's buffer pool
 	sampleFrame * m_buffer;
 	BoolModel m_muteModel;
 	FloatModel m_volumeModel;
@@ -66,7 +83,34 @@ public:
 	void prepareMasterMix();
 	void masterMix( sampleFrame * _buf );
 
+	// returns all channels (except master) on given level of the routing
+	// graph which received audio in current period or whose effects are
+	// still running - only these have to be processed; channels on the
+	// same level do not depend on each other and thus can be processed
+	// in parallel
+	const QVector<fx_ch_t> & activeChannels( int _level ) const
+	{
+		return m_activeChannels[_level];
+	}
+
+	// number of levels of the routing graph (without master)
+	int numLevels() const
+	{
+		return m_numLevels;
+	}
+
+	// adds a send from one channel to another one - an existing send is
+	// left untouched including its amount - returns false if this would
+	// create a cycle
+	bool addSend( fx_ch_t _from, fx_ch_t _to, float _amount = 1.0f );
+	void removeSend( fx_ch_t _from, fx_ch_t _to );
 
+	// returns whether audio of one channel reaches the other channel
+	// through sends
+	bool isRoutedTo( fx_ch_t _from, fx_ch_t _to ) const;
+
+
+	// removes all channels except master and resets master
 	void clear();
 
 	virtual void saveSettings( QDomDocument & _doc, QDomElement & _parent );
@@ -77,9 +121,22 @@ public:
 		return "fxmixer";
 	}
 
+	// number of channels including master
+	int numChannels() const
+	{
+		return m_fxChannels.size();
+	}
+
+	// appends a new channel and returns its index
+	fx_ch_t createChannel();
+
+	// creates channels until given channel index is valid - returns false
+	// if index is negative
+	bool ensureChannelExists( int _ch );
+
 	FxChannel * effectChannel( int _ch )
 	{
-		if( _ch >= 0 && _ch <= NumFxChannels )
+		if( _ch >= 0 && _ch < m_fxChannels.size() )
 		{
 			return m_fxChannels[_ch];
 		}
@@ -88,7 +145,32 @@ public:
 
 
 private:
-	FxChannel * m_fxChannels[NumFxChannels+1];	// +1 = master
+	void resetChannel( int _ch );
+	void clearSends( int _ch );
+
+	// adds given buffer to given channel - activates channel if required
+	void addToChannel( const sampleFrame * _buf, fx_ch_t _ch, float _gain );
+
+	// recalculates level of each channel in routing graph and sorts
+	// active channels by their new level - has to be called with mixer
+	// locked whenever sends are changed
+	void updateLevels();
+	int calculateLevel( fx_ch_t _ch, QVector<int> & _levels ) const;
+
+	// assigns a buffer to channel and adds it to the list of active
+	// channels - channel has to be locked
+	void activateChannel( fx_ch_t _ch );
+
+	QVector<FxChannel *> m_fxChannels;	// index 0 = master
+
+	QVector<int> m_levels;
+	int m_numLevels;
+
+	// active channels by level - kept up to date when channels get
+	// (de)activated so they don't have to be collected in every period
+	QVector<QVector<fx_ch_t> > m_activeChannels;
+	QVector<sampleFrame *> m_bufferPool;
+	QMutex m_activeChannelsLock;
 
 
 	friend class MixerWorkerThread;
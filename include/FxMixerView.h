@@ -25,6 +25,7 @@
 #ifndef _FX_MIXER_VIEW_H
 #define _FX_MIXER_VIEW_H
 
+#include <QtCore/QVector>
 #include <QtGui/QWidget>
 
 #include "FxMixer.h"
@@ -32,6 +33,8 @@
 
 class QStackedLayout;
 class QButtonGroup;
+class QHBoxLayout;
+class QVBoxLayout;
 class fader;
 class FxLine;
 class EffectRackView;
@@ -56,11 +59,16 @@ public:
 	void setCurrentFxLine( FxLine * _line );
 	void setCurrentFxLine( int _line );
 
+	// shows context menu for managing sends of given FX line
+	void showSendsMenu( FxLine * _line, const QPoint & _pos );
+
 	void clear();
 
 
 private slots:
 	void updateFaders();
+	void updateChannelViews();
+	void addChannel();
 
 
 private:
@@ -72,11 +80,19 @@ private:
 		fader * m_fader;
 	} ;
 
-	FxChannelView m_fxChannelViews[NumFxChannels+1];
+	// add/remove view for last FX channel
+	void addChannelView();
+	void removeChannelView();
+	void addBank();
+
+	QVector<FxChannelView> m_fxChannelViews;
+	QVector<QHBoxLayout *> m_banks;
 
+	QHBoxLayout * m_mainLayout;
 	QStackedLayout * m_fxRacksLayout;
 	QStackedLayout * m_fxLineBanks;
 	QButtonGroup * m_bankButtons;
+	QVBoxLayout * m_bankButtonsLayout;
 	FxLine * m_currentFxLine;
 
 } ;
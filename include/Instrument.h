@@ -99,6 +99,16 @@ public:
 		return NoFlags;
 	}
 
+	// single-streamed instruments can re-implement this for telling
+	// whether they currently have no active voices - if additionally
+	// their output is silent for a few periods, they're put to sleep,
+	// i.e. play() isn't called anymore until the instrument receives a
+	// MIDI event or one of its parameters changes
+	virtual bool isIdle()
+	{
+		return false;
+	}
+
 	// sub-classes can re-implement this for receiving all incoming
 	// MIDI-events
 	inline virtual bool handleMidiEvent( const MidiEvent&, const MidiTime& = MidiTime() )
@@ -119,6 +129,23 @@ public:
 
 	virtual bool isFromTrack( const track * _track ) const;
 
+	// whether play() can be skipped as instrument is not producing any
+	// sound at the moment (see isIdle())
+	bool isSleeping() const
+	{
+		return m_sleeping;
+	}
+
+	void wakeUp()
+	{
+		m_idlePeriods = 0;
+		m_sleeping = false;
+	}
+
+	// called by InstrumentTrack after each period rendered by a
+	// single-streamed instrument
+	void updateSleepState( bool _silent );
+
 
 protected:
 	inline InstrumentTrack * instrumentTrack() const
@@ -135,6 +162,9 @@ protected:
 private:
 	InstrumentTrack * m_instrumentTrack;
 
+	volatile bool m_sleeping;
+	int m_idlePeriods;
+
 } ;
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Instrument::Flags)
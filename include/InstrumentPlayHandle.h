@@ -45,6 +45,11 @@ public:
 
 	virtual void play( sampleFrame * _working_buffer )
 	{
+		// nothing to render until instrument is woken up again
+		if( m_instrument->isSleeping() )
+		{
+			return;
+		}
 		m_instrument->play( _working_buffer );
 	}
 
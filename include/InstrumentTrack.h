@@ -219,9 +219,13 @@ protected slots:
 	void updateBaseNote();
 	void updatePitch();
 	void updatePitchRange();
+	void updateEffectChannelRange();
+	void wakeUpInstrument();
 
 
 private:
+	void connectInstrumentModels();
+
 	AudioPort m_audioPort;
 	MidiPort m_midiPort;
 
@@ -53,7 +53,7 @@ public:
 		m_journalling = m_journallingStateStack.pop();
 	}
 
-	void addJournalCheckPoint();
+	virtual void addJournalCheckPoint();
 
 	virtual QDomElement saveState( QDomDocument & _doc,
 									QDomElement & _parent );
@@ -65,6 +65,9 @@ typedef struct PortDescription
 	LADSPA_Data def;
 	LADSPA_Data value;
 	LADSPA_Data * buffer;
+	// audio rate inputs only: buffer holds nothing but value, i.e. it does
+	// not need to be filled again as long as value does not change
+	bool constantBuffer;
 	LadspaControl * control;
 } port_desc_t;
 
@@ -30,6 +30,8 @@
 #include <QtCore/QList>
 #include <QtGui/QMainWindow>
 
+#include "AutoSaveThread.h"
+
 class QAction;
 class QDomElement;
 class QGridLayout;
@@ -158,6 +160,8 @@ private:
 
 	QBasicTimer m_updateTimer;
 	QTimer m_autoSaveTimer;
+	AutoSaveThread m_autoSaveThread;
+	int m_autoSaveRevision;
 
 
 	friend class engine;
@@ -32,6 +32,9 @@ namespace MixHelpers
 
 bool isSilent( const sampleFrame* src, int frames );
 
+/*! \brief Return sum of squares of all samples in src (e.g. for gate/RMS calculations) */
+double energy( const sampleFrame* src, int frames );
+
 /*! \brief Add samples from src to dst */
 void add( sampleFrame* dst, const sampleFrame* src, int frames );
 
@@ -44,6 +44,7 @@
 #include <QtCore/QWaitCondition>
 
 
+#include "atomic_int.h"
 #include "lmms_basics.h"
 #include "note.h"
 #include "fifo_buffer.h"
@@ -144,6 +145,10 @@ public:
 		{
 		}
 
+		// oversampling factor selected by these settings - the engine
+		// itself always runs at output sample rate, only effects and
+		// instruments with nonlinear processing oversample on their own
+		// (see Oversampler)
 		int sampleRateMultiplier() const
 		{
 			switch( oversampling )
@@ -228,6 +233,7 @@ public:
 			return true;
 		}
 
+		handle->unlink();
 		delete handle;
 
 		return false;
@@ -242,8 +248,23 @@ public:
 
 	void removePlayHandles( track * _track );
 
+	// unlinks given play-handle and deletes it later in a low priority
+	// thread so its destruction doesn't cost time in audio thread - must
+	// be called with mixer locked so there's only one writer to the
+	// deletion ring at a time
+	void deletePlayHandle( PlayHandle * _ph );
+
 	bool hasNotePlayHandles();
 
+	typedef void (* ParallelJobFunc)( void * _context, int _index );
+
+	// for instruments and effects which can split their work into
+	// independent parts while being processed: calls
+	// _func( _context, i ) for every i below _count on idle worker threads
+	// and the calling thread and returns when all calls have finished -
+	// when not called from within a mixer job, calls are made serially
+	void runParallel( ParallelJobFunc _func, void * _context, int _count );
+
 
 	// methods providing information for other classes
 	inline fpp_t framesPerPeriod() const
@@ -393,6 +414,24 @@ private:
 
 	} ;
 
+	// deletes play-handles scheduled by deletePlayHandle() - they've been
+	// unlinked already, so this doesn't need the mixer lock
+	class playHandleReclaimer : public QThread
+	{
+	public:
+		playHandleReclaimer( Mixer * _mixer );
+
+		void finish();
+
+
+	private:
+		Mixer * m_mixer;
+		volatile bool m_running;
+
+		virtual void run();
+
+	} ;
+
 
 	Mixer();
 	virtual ~Mixer();
@@ -407,6 +446,9 @@ private:
 
 	const surroundSampleFrame * renderNextBuffer();
 
+	// deletes all play-handles queued by deletePlayHandle() so far
+	void deleteUnlinkedPlayHandles();
+
 
 
 	QVector<AudioPort *> m_audioPorts;
@@ -443,6 +485,13 @@ private:
 
 	PlayHandleList m_playHandles;
 	ConstPlayHandleList m_playHandlesToRemove;
+	// preallocated single-reader/single-writer ring of unlinked
+	// play-handles which m_playHandleReclaimer deletes without taking
+	// the mixer lock
+	PlayHandle * * m_playHandlesToDelete;
+	AtomicInt m_playHandlesToDeleteReadPos;
+	AtomicInt m_playHandlesToDeleteWritePos;
+	playHandleReclaimer * m_playHandleReclaimer;
 
 	struct qualitySettings m_qualitySettings;
 	float m_masterGain;
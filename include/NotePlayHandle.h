@@ -90,6 +90,13 @@ public:
 	/*! Renders one chunk using the attached instrument into the buffer */
 	virtual void play( sampleFrame* buffer );
 
+	/*! Appends sub-notes (chords, arpeggios) so the mixer can render them as separate jobs */
+	virtual void appendSubPlayHandles( PlayHandleList& list );
+
+	/*! Removes sub-notes which finished playing in current period */
+	virtual void releaseFinishedSubPlayHandles();
+	virtual void unlink();
+
 	/*! Returns whether playback of note is finished and thus handle can be deleted */
 	virtual bool isFinished() const
 	{
@@ -268,6 +275,8 @@ private:
 											// release of note
 	NotePlayHandleList m_subNotes;			// used for chords and arpeggios
 	volatile bool m_released;				// indicates whether note is released
+	bool m_unlinked;						// indicates whether unlink() has
+											// been called already
 	bool m_topNote;							// indicates whether note is a
 											// base-note (i.e. no sub-note)
 	bool m_partOfArpeggio;					// indicates whether note is part of
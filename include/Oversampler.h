@@ -0,0 +1,97 @@
+/*
+ * Oversampler.h - polyphase up- and downsampling for nonlinear processing
+ *
+ * Copyright (c) 2014 Tobias Doerffel <tobydox/at/users.sourceforge.net>
+ *
+ * This file is part of Linux MultiMedia Studio - http://lmms.sourceforge.net
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef OVERSAMPLER_H
+#define OVERSAMPLER_H
+
+#include "export.h"
+#include "lmms_basics.h"
+
+
+/*! \brief Runs nonlinear parts of an effect or instrument at a higher rate
+ *
+ * The engine always runs at output sample rate. Plugins whose processing
+ * creates aliasing (waveshaping, distortion etc.) upsample their buffer
+ * with upsample(), process the returned buffer and call downsample()
+ * afterwards. Factors 2, 4 and 8 are realized as cascade of 2x halfband
+ * stages, each implemented as polyphase FIR so only the non-trivial branch
+ * of the filter has to be computed. All stages and buffers are allocated
+ * for the maximum factor at construction, so changing the factor is
+ * realtime-safe.
+ */
+class EXPORT Oversampler
+{
+public:
+	enum
+	{
+		MaxStages = 3,
+		MaxFactor = 1 << MaxStages
+	} ;
+
+	// _maxFrames is the maximum number of frames passed to upsample(),
+	// _factor must be 1, 2, 4 or 8
+	Oversampler( fpp_t _maxFrames, int _factor = 1 );
+	~Oversampler();
+
+	inline int factor() const
+	{
+		return 1 << m_numStages;
+	}
+
+	// changes factor and resets filter states if factor differs
+	void setFactor( int _factor );
+
+	// clears filter histories, e.g. when playback restarts
+	void reset();
+
+	// upsamples _frames (at most _maxFrames) frames and returns internal
+	// buffer holding _frames * factor() frames which stays valid until
+	// next call
+	sampleFrame * upsample( const sampleFrame * _in, const fpp_t _frames );
+
+	// downsamples _frames * factor() frames from _in to _frames frames in
+	// _out - _in may be buffer returned by upsample() or oversampledBuffer()
+	void downsample( const sampleFrame * _in, sampleFrame * _out,
+							const fpp_t _frames );
+
+	// buffer for _maxFrames * factor() frames, e.g. for instruments which
+	// generate their output at oversampled rate and only downsample it
+	inline sampleFrame * oversampledBuffer()
+	{
+		return m_buffers[0];
+	}
+
+
+private:
+	class HalfbandStage;
+
+	HalfbandStage * m_stages[MaxStages];
+	int m_numStages;
+	sampleFrame * m_buffers[2];
+
+
+} ;
+
+
+#endif
@@ -25,12 +25,17 @@
 #ifndef PLAY_HANDLE_H
 #define PLAY_HANDLE_H
 
+#include <QtCore/QList>
 #include <QtCore/QThread>
 #include <QtCore/QVector>
 
 #include "lmms_basics.h"
 
 class track;
+class PlayHandle;
+
+typedef QList<PlayHandle *> PlayHandleList;
+typedef QList<const PlayHandle *> ConstPlayHandleList;
 
 
 class PlayHandle
@@ -90,6 +95,28 @@ public:
 
 	virtual bool isFromTrack( const track * _track ) const = 0;
 
+	// appends play-handles owned by this play-handle (e.g. sub-notes of
+	// chords and arpeggios) which the mixer has to render as separate jobs
+	// after play() has been called for the current period
+	virtual void appendSubPlayHandles( PlayHandleList & )
+	{
+	}
+
+	// called by the mixer after all sub-play-handles of the current period
+	// have been rendered - gives a chance to remove finished ones
+	virtual void releaseFinishedSubPlayHandles()
+	{
+	}
+
+	// called by the mixer when this play-handle is scheduled for deletion -
+	// must release everything belonging to other objects (plugin data,
+	// references to it etc.) as the actual deletion happens later in a
+	// different thread without mixer being locked, so destructors may only
+	// free own memory afterwards - must be safe to call more than once
+	virtual void unlink()
+	{
+	}
+
 
 private:
 	Type m_type;
@@ -99,8 +126,4 @@ private:
 } ;
 
 
-typedef QList<PlayHandle *> PlayHandleList;
-typedef QList<const PlayHandle *> ConstPlayHandleList;
-
-
 #endif
@@ -0,0 +1,124 @@
+/*
+ * PluginManifest.h - cached information about available plugins
+ *
+ * Copyright (c) 2014 Tobias Doerffel <tobydox/at/users.sourceforge.net>
+ *
+ * This file is part of Linux MultiMedia Studio - http://lmms.sourceforge.net
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef PLUGIN_MANIFEST_H
+#define PLUGIN_MANIFEST_H
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+#include "Plugin.h"
+
+class QLibrary;
+
+
+/*! \brief Cache of plugin descriptors which can be used without loading
+ *			the plugin libraries
+ *
+ * The manifest is stored in configManager::cacheDir() and each entry is
+ * validated by size and modification time of the according library, so
+ * only new or changed plugins have to be loaded for querying their
+ * descriptor. Everything which needs more than the plain descriptor data
+ * (logos, sub-plugin features) can load the library of single entries via
+ * descriptor() or all libraries of one plugin type via descriptorsOfType().
+ */
+class EXPORT PluginManifest
+{
+public:
+	struct Entry
+	{
+		Entry() :
+			size( 0 ),
+			lastModified( 0 ),
+			version( 0 ),
+			type( Plugin::Undefined ),
+			hasSubPlugins( false )
+		{
+		}
+
+		// name of plugin as passed to Plugin::instantiate()
+		QString name;
+		QString displayName;
+		QString description;
+		QString author;
+		QString supportedFileTypes;
+
+		// library file this entry was generated from
+		QString fileName;
+		qint64 size;
+		uint lastModified;
+
+		int version;
+		Plugin::PluginTypes type;
+		bool hasSubPlugins;
+
+		bool supportsFileType( const QString & ext ) const
+		{
+			return supportedFileTypes.split( QChar( ',' ) ).contains( ext );
+		}
+	} ;
+
+	typedef QList<Entry> EntryList;
+
+	// returns entries of all available plugins - (re)generates manifest
+	// when called for the first time
+	static const EntryList & entries();
+
+	// rescan plugin directory and update manifest on disk if neccessary
+	static void refresh();
+
+	// list of all libraries in plugin directory
+	static QFileInfoList pluginFiles();
+
+	// loads library of given entry and returns its descriptor or NULL if
+	// entry is not a valid plugin or library could not be loaded
+	static Plugin::Descriptor * descriptor( const Entry & e );
+
+	// appends descriptors of all plugins of given type - libraries of other
+	// plugin types are not loaded
+	static void descriptorsOfType( Plugin::PluginTypes type,
+										Plugin::DescriptorList & descs );
+
+	// returns descriptor of plugin in given (already loaded) library
+	static Plugin::Descriptor * resolveDescriptor( QLibrary & lib,
+													const QFileInfo & file );
+
+	// load all plugins of type Plugin::Library so libraries depending on
+	// them can be loaded
+	static void loadLibraryPlugins();
+
+
+private:
+	static QString manifestFile();
+	static bool load( QList<Entry> & entries );
+	static void save();
+
+	static EntryList s_entries;
+	static bool s_initialized;
+
+} ;
+
+
+#endif
@@ -41,6 +41,10 @@ public:
 	virtual void play( sampleFrame* buffer );
 	virtual bool isFinished() const;
 
+	virtual void appendSubPlayHandles( PlayHandleList& list );
+	virtual void releaseFinishedSubPlayHandles();
+	virtual void unlink();
+
 	virtual bool isFromTrack( const track * _track ) const;
 
 	static void init();
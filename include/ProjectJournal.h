@@ -25,13 +25,18 @@
 #ifndef _PROJECT_JOURNAL_H
 #define _PROJECT_JOURNAL_H
 
+#include <QtCore/QByteArray>
 #include <QtCore/QHash>
-#include <QtCore/QStack>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QTime>
 
 #include "lmms_basics.h"
+#include "atomic_int.h"
 #include "DataFile.h"
 
 class JournallingObject;
+class AutomatableModel;
 
 
 class ProjectJournal
@@ -43,8 +48,22 @@ public:
 	void undo();
 	void redo();
 
+	// record a full snapshot of given object - used for structural changes
 	void addJournalCheckPoint( JournallingObject *jo );
 
+	// record a simple value change of given model - repeated changes of
+	// the same model within an interaction are merged into one entry
+	void addValueCheckPoint( AutomatableModel *model, float oldValue );
+
+	// everything recorded between these calls (e.g. from pressing a knob
+	// until releasing it, including changes of linked models) is undone
+	// in a single step - calls can be nested, the outermost pair counts;
+	// if _mergeWithPrevious is set, the step may also continue the
+	// previous one if that changed the same model just before (e.g. when
+	// turning the mouse wheel)
+	void beginInteraction( bool _mergeWithPrevious = false );
+	void endInteraction();
+
 	bool isJournalling() const
 	{
 		return m_journalling;
@@ -73,13 +92,38 @@ public:
 
 	void clearJournal();
 
+	// maximum amount of memory (in bytes) occupied by undo/redo history,
+	// oldest entries get dropped when exceeding it
+	void setMaxMemoryUsage( int bytes );
+
+	int maxMemoryUsage() const
+	{
+		return m_maxMemoryUsage;
+	}
+
+	int memoryUsage() const
+	{
+		return m_memoryUsage;
+	}
+
+	// increased with every change to any journalling object, no matter
+	// whether journalling is enabled - can be used to find out whether
+	// project has changed since a given point in time - atomic as models
+	// also get changed from mixer threads (e.g. by automation)
+	int revision() const
+	{
+		return m_revision;
+	}
+
+	void markModified()
+	{
+		m_revision.fetchAndAddOrdered( 1 );
+	}
+
 	JournallingObject * journallingObject( const jo_id_t _id )
 	{
-		if( m_joIDs.contains( _id ) )
-		{
-			return m_joIDs[_id];
-		}
-		return NULL;
+		QMutexLocker ml( &m_joIDsMutex );
+		return m_joIDs.value( _id, NULL );
 	}
 
 
@@ -88,23 +132,78 @@ private:
 
 	struct CheckPoint
 	{
-		CheckPoint( jo_id_t initID = 0, const DataFile&initData = DataFile( DataFile::JournalData ) ) :
+		enum Types
+		{
+			Snapshot,		// compressed XML state of the whole object
+			ValueChange		// old value of an AutomatableModel
+		} ;
+
+		CheckPoint( Types initType = Snapshot, jo_id_t initID = 0 ) :
+			type( initType ),
 			joID( initID ),
-			data( initData )
+			interaction( 0 ),
+			data(),
+			value( 0 ),
+			lastChange()
+		{
+		}
+
+		int memoryUsage() const
 		{
+			return sizeof( CheckPoint ) + data.size();
 		}
+
+		Types type;
 		jo_id_t joID;
-		DataFile data;
+		// entries of the same (non-zero) interaction form one step
+		int interaction;
+		QByteArray data;
+		float value;
+		QTime lastChange;
 	} ;
-	typedef QStack<CheckPoint> CheckPointStack;
+	typedef QList<CheckPoint> CheckPointList;
+
+	// changes of same model within this interval are merged if not
+	// within an explicit interaction
+	static const int ValueChangeMergeInterval = 1000;
+
+	// default for "app/journalsize" setting (in MB)
+	static const int DefaultMaxMemoryUsage = 32;
+
+	CheckPoint createCheckPoint( CheckPoint::Types type,
+									JournallingObject * jo ) const;
+	void restoreCheckPoint( const CheckPoint & c, JournallingObject * jo );
+
+	void pushCheckPoint( CheckPointList & list, const CheckPoint & c );
+	CheckPoint popCheckPoint( CheckPointList & list );
+	void clearCheckPoints( CheckPointList & list );
+	void enforceMemoryLimit();
+
+	bool step( CheckPointList & from, CheckPointList & to );
+
+	// whether last undo step contains a value change of given object
+	bool lastStepChanges( jo_id_t _id ) const;
 
 	JoIdMap m_joIDs;
+	// objects also get deleted outside GUI thread (e.g. when play-handles
+	// are unlinked by the mixer)
+	mutable QMutex m_joIDsMutex;
+
+	CheckPointList m_undoCheckPoints;
+	CheckPointList m_redoCheckPoints;
 
-	CheckPointStack m_undoCheckPoints;
-	CheckPointStack m_redoCheckPoints;
+	int m_memoryUsage;
+	int m_maxMemoryUsage;
+
+	AtomicInt m_revision;
 
 	bool m_journalling;
 
+	int m_interactionDepth;
+	int m_interaction;	// 0 if no interaction is running
+	int m_lastInteraction;
+	bool m_mergeWithPrevious;
+
 } ;
 
 
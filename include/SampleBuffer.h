@@ -29,6 +29,7 @@
 #include <QtCore/QMutex>
 #include <QtCore/QObject>
 #include <QtCore/QRect>
+#include <QtCore/QVector>
 
 #include <samplerate.h>
 
@@ -40,6 +41,7 @@
 
 
 class QPainter;
+class SamplePeakBuilder;
 
 
 class EXPORT SampleBuffer : public QObject, public sharedObject
@@ -62,6 +64,10 @@ public:
 			m_frameIndex = _index;
 		}
 
+		// rewind and clear resampler so the state can be reused for
+		// another playback
+		void reset();
+
 
 
 	private:
@@ -88,6 +94,9 @@ public:
 				const float _freq,
 				const bool _looped = false );
 
+	// draws waveform of given range - for strongly zoomed out views a
+	// min/max peak pyramid is built in background on first call and
+	// used afterwards, so drawing costs O(width) instead of O(frames)
 	void visualize( QPainter & _p, const QRect & _dr, const QRect & _clip, f_cnt_t _from_frame = 0, f_cnt_t _to_frame = 0 );
 	inline void visualize( QPainter & _p, const QRect & _dr, f_cnt_t _from_frame = 0, f_cnt_t _to_frame = 0 )
 	{
@@ -177,6 +186,8 @@ public:
 	QString openAndSetWaveformFile();
 	
 	QString & toBase64( QString & _dst ) const;
+	// data as encoded by toBase64() (FLAC stream or raw sample frames)
+	QByteArray toData() const;
 
 
 	static SampleBuffer * resample( sampleFrame * _data,
@@ -223,6 +234,8 @@ public:
 public slots:
 	void setAudioFile( const QString & _audio_file );
 	void loadFromBase64( const QString & _data );
+	// load data as produced by toBase64() before encoding it
+	void loadFromData( const QByteArray & _data );
 	void setStartFrame( const f_cnt_t _s );
 	void setEndFrame( const f_cnt_t _e );
 	void setAmplification( float _a );
@@ -230,8 +243,22 @@ public slots:
 
 
 private:
+	struct Peak
+	{
+		sample_t min;
+		sample_t max;
+	} ;
+	typedef QVector<Peak> PeakLevel;
+
+	// number of frames covered by one peak of lowest pyramid level -
+	// every further level doubles it
+	static const f_cnt_t PeakBlockFrames = 32;
+
 	void update( bool _keep_settings = false );
 
+	void buildPeaks();
+	void stopPeakBuilder();
+
     void convertIntToFloat ( int_sample_t * & _ibuf, f_cnt_t _frames, int _channels);
     void directFloatWrite ( sample_t * & _fbuf, f_cnt_t _frames, int _channels);
 
@@ -262,14 +289,28 @@ private:
 	float m_frequency;
 	sample_rate_t m_sampleRate;
 
+	QMutex m_peakLock;
+	QVector<PeakLevel> m_peaks;
+	SamplePeakBuilder * m_peakBuilder;
+	volatile bool m_abortPeakBuilder;
+
+	// result of toData() - kept until the sample data changes so saving
+	// unchanged samples (e.g. on every auto-save) doesn't re-encode them
+	mutable QByteArray m_encodedData;
+	mutable sample_rate_t m_encodedDataSampleRate;
+
 	sampleFrame * getSampleFragment( f_cnt_t _start, f_cnt_t _frames,
 						bool _looped,
 						sampleFrame * * _tmp ) const;
 	f_cnt_t getLoopedIndex( f_cnt_t _index ) const;
 
+	friend class SamplePeakBuilder;
+
 
 signals:
 	void sampleUpdated();
+	// emitted (possibly from another thread) when peak pyramid is ready
+	void peaksReady();
 
 } ;
 
@@ -53,6 +53,7 @@ public:
 	virtual bool isFinished() const;
 
 	virtual bool isFromTrack( const track * _track ) const;
+	virtual void unlink();
 
 	f_cnt_t totalFrames() const;
 	inline f_cnt_t framesDone() const
@@ -26,14 +26,11 @@
 #ifndef _SAMPLE_RECORD_HANDLE_H
 #define _SAMPLE_RECORD_HANDLE_H
 
-#include <QtCore/QList>
-#include <QtCore/QPair>
-
 #include "Mixer.h"
-#include "SampleBuffer.h"
 
 class bbTrack;
 class pattern;
+class SampleStreamWriter;
 class SampleTCO;
 class track;
 
@@ -48,17 +45,15 @@ public:
 	virtual bool isFinished() const;
 
 	virtual bool isFromTrack( const track * _track ) const;
+	virtual void unlink();
 
 	f_cnt_t framesRecorded() const;
-	void createSampleBuffer( SampleBuffer * * _sample_buf );
 
 
 private:
-	virtual void writeBuffer( const sampleFrame * _ab,
-						const f_cnt_t _frames );
-
-	typedef QList<QPair<sampleFrame *, f_cnt_t> > bufferList;
-	bufferList m_buffers;
+	// recorded frames are streamed to disk while recording - owned by
+	// SampleTCO which opens it when recording gets armed
+	SampleStreamWriter * m_writer;
 	f_cnt_t m_framesRecorded;
 	MidiTime m_minLength;
 
@@ -0,0 +1,100 @@
+/*
+ * SampleStreamWriter.h - streams recorded audio to disk in background
+ *
+ * Copyright (c) 2014 Tobias Doerffel <tobydox/at/users.sourceforge.net>
+ *
+ * This file is part of Linux MultiMedia Studio - http://lmms.sourceforge.net
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef SAMPLE_STREAM_WRITER_H
+#define SAMPLE_STREAM_WRITER_H
+
+#include <QtCore/QString>
+#include <QtCore/QThread>
+
+#include <sndfile.h>
+
+#include "atomic_int.h"
+#include "lmms_basics.h"
+
+
+/*! \brief Writes recorded frames to a WAV file without blocking the caller
+ *
+ * write() only copies the frames into a preallocated single-reader/
+ * single-writer ring and thus can be called from realtime threads. A
+ * background thread empties the ring into the file. The WAV header is kept
+ * up to date while recording so a take survives a crash.
+ */
+class SampleStreamWriter : public QThread
+{
+public:
+	SampleStreamWriter( const QString & _file, sample_rate_t _sample_rate );
+	virtual ~SampleStreamWriter();
+
+	// returns a new unique file name in user's sample directory
+	static QString newRecordingFile();
+
+	inline bool isOpen() const
+	{
+		return m_sndFile != NULL;
+	}
+
+	inline const QString & fileName() const
+	{
+		return m_fileName;
+	}
+
+	// frames accepted by write() so far
+	inline f_cnt_t framesWritten() const
+	{
+		return m_framesWritten;
+	}
+
+	// realtime-safe - frames which don't fit into ring anymore are dropped
+	void write( const sampleFrame * _ab, const f_cnt_t _frames );
+
+	// realtime-safe - lets writer thread quit without waiting for it,
+	// further frames are ignored
+	void stop();
+
+	// writes out all pending frames and closes file - blocks until writer
+	// thread has quit, so don't call it from realtime threads
+	void finish();
+
+
+private:
+	virtual void run();
+	void flush();
+
+	QString m_fileName;
+	SNDFILE * m_sndFile;
+
+	sampleFrame * m_ring;
+	f_cnt_t m_ringSize;
+	AtomicInt m_readPos;
+	AtomicInt m_writePos;
+
+	f_cnt_t m_framesWritten;
+	AtomicInt m_framesDropped;
+	volatile bool m_quit;
+
+} ;
+
+
+#endif
@@ -33,6 +33,7 @@
 class EffectRackView;
 class knob;
 class SampleBuffer;
+class SampleStreamWriter;
 
 
 class SampleTCO : public trackContentObject
@@ -60,6 +61,11 @@ public:
 
 	MidiTime sampleLength() const;
 
+	// called by SampleRecordHandle from mixer thread - returns writer
+	// opened when recording was armed or NULL if there's none or it's
+	// used already
+	SampleStreamWriter * startRecording();
+
 	virtual trackContentObjectView * createView( trackView * _tv );
 
 
@@ -68,12 +74,24 @@ public slots:
 	void setSampleFile( const QString & _sf );
 	void updateLength( bpm_t = 0 );
 	void toggleRecord();
+	// closes recorded file and loads it - invoked by SampleRecordHandle
+	// through a queued connection once it's done
+	void finishRecording();
+
+
+private slots:
+	void updateRecordWriter();
 
 
 private:
 	SampleBuffer* m_sampleBuffer;
 	BoolModel m_recordModel;
 
+	// opened in GUI thread as soon as recording is armed so mixer thread
+	// does not have to do any file I/O
+	SampleStreamWriter * m_recordWriter;
+	bool m_recordWriterInUse;
+
 
 	friend class SampleTCOView;
 
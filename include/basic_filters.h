@@ -142,6 +142,51 @@ public:
 		}
 	}
 
+	// zeroes in/out history which has decayed below audibility - filter
+	// tails would otherwise decay into denormals which are very slow to
+	// compute with, so call it once per period
+	inline void flushDenormals()
+	{
+		for( ch_cnt_t _chnl = 0; _chnl < CHANNELS; ++_chnl )
+		{
+			flushDenormal( m_ou1[_chnl] );
+			flushDenormal( m_ou2[_chnl] );
+			flushDenormal( m_in1[_chnl] );
+			flushDenormal( m_in2[_chnl] );
+
+			flushDenormal( m_y1[_chnl] );
+			flushDenormal( m_y2[_chnl] );
+			flushDenormal( m_y3[_chnl] );
+			flushDenormal( m_y4[_chnl] );
+			flushDenormal( m_oldx[_chnl] );
+			flushDenormal( m_oldy1[_chnl] );
+			flushDenormal( m_oldy2[_chnl] );
+			flushDenormal( m_oldy3[_chnl] );
+
+			flushDenormal( m_rclp0[_chnl] );
+			flushDenormal( m_rcbp0[_chnl] );
+			flushDenormal( m_rchp0[_chnl] );
+			flushDenormal( m_rclast0[_chnl] );
+			flushDenormal( m_rclp1[_chnl] );
+			flushDenormal( m_rcbp1[_chnl] );
+			flushDenormal( m_rchp1[_chnl] );
+			flushDenormal( m_rclast1[_chnl] );
+
+			for( int i = 0; i < 6; ++i )
+			{
+				flushDenormal( m_vflp[i][_chnl] );
+				flushDenormal( m_vfbp[i][_chnl] );
+				flushDenormal( m_vfhp[i][_chnl] );
+				flushDenormal( m_vflast[i][_chnl] );
+			}
+		}
+
+		if( m_subFilter != NULL )
+		{
+			m_subFilter->flushDenormals();
+		}
+	}
+
 	inline sample_t update( sample_t _in0, ch_cnt_t _chnl )
 	{
 		sample_t out;
@@ -636,6 +681,14 @@ public:
 
 
 private:
+	static inline void flushDenormal( sample_t & _s )
+	{
+		if( fabsf( _s ) < 1.0e-10f )
+		{
+			_s = 0.0f;
+		}
+	}
+
 	// filter coeffs
 	float m_b0a0, m_b1a0, m_b2a0, m_a1a0, m_a2a0;
 
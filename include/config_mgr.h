@@ -45,6 +45,7 @@ const QString SAMPLES_PATH = "samples/";
 const QString DEFAULT_THEME_PATH = "themes/default/";
 const QString TRACK_ICON_PATH = "track_icons/";
 const QString LOCALE_PATH = "locale/";
+const QString CACHE_PATH = ".cache/";
 
 
 class EXPORT configManager
@@ -84,6 +85,13 @@ public:
 		return( workingDir() + SAMPLES_PATH );
 	}
 
+	// directory for data which can be regenerated at any time (plugin
+	// manifests etc.)
+	QString cacheDir() const
+	{
+		return( workingDir() + CACHE_PATH );
+	}
+
 	QString factoryProjectsDir() const
 	{
 		return( dataDir() + PROJECTS_PATH );
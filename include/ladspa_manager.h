@@ -30,8 +30,11 @@
 
 #include <ladspa.h>
 
+#include <QtCore/QFileInfo>
 #include <QtCore/QMap>
+#include <QtCore/QMutex>
 #include <QtCore/QPair>
+#include <QtCore/QVector>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 
@@ -72,7 +75,11 @@ enum ladspaPluginType
 
 typedef struct ladspaManagerStorage
 {
+	// NULL as long as library has not been loaded (plugin information
+	// was taken from the plugin index)
 	LADSPA_Descriptor_Function descriptorFunction;
+	// absolute path of library containing the plugin
+	QString filePath;
 	uint32_t index;
 	ladspaPluginType type;
 	uint16_t inputChannels;
@@ -323,16 +330,53 @@ public:
 						LADSPA_Handle _instance );
 
 private:
-	void  addPlugins( LADSPA_Descriptor_Function _descriptor_func,
-						const QString & _file );
+	// information about all plug-ins of a library - descriptors either
+	// belong to loaded library or have been read from plugin index
+	struct libraryInfo
+	{
+		libraryInfo() :
+			size( 0 ),
+			lastModified( 0 ),
+			fromIndex( false )
+		{
+		}
+
+		qint64 size;
+		uint lastModified;
+		bool fromIndex;
+		QVector<const LADSPA_Descriptor *> descriptors;
+	} ;
+	typedef QMap<QString, libraryInfo> libraryInfoMap;
+
+	void  addPlugins( const libraryInfo & _library,
+				LADSPA_Descriptor_Function _descriptor_func,
+						const QFileInfo & _file );
 	uint16_t  getPluginInputs( const LADSPA_Descriptor * _descriptor );
 	uint16_t  getPluginOutputs( const LADSPA_Descriptor * _descriptor );
+
+	// returns descriptor suitable for querying plug-in information -
+	// does not require library to be loaded
+	const LADSPA_Descriptor * metaDescriptor(
+						const ladspa_key_t & _plugin );
+	// returns real descriptor of plug-in, loads library if neccessary -
+	// also called from mixer threads, so library is loaded with
+	// m_loadMutex held
+	const LADSPA_Descriptor * loadedDescriptor(
+						const ladspa_key_t & _plugin );
+
+	static QString indexFile();
+	void loadIndex( libraryInfoMap & _index );
+	void saveIndex();
 	
 	typedef QMap<ladspa_key_t, ladspaManagerDescription *>
 						ladspaManagerMapType;
 	ladspaManagerMapType m_ladspaManagerMap;
 	l_sortable_plugin_t m_sortedPlugins;
 
+	libraryInfoMap m_libraries;
+
+	QMutex m_loadMutex;
+
 } ;
 
 #endif
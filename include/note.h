@@ -213,6 +213,10 @@ protected:
 							QDomElement & _parent );
 	virtual void loadSettings( const QDomElement & _this );
 
+	// drops reference to detuning information, e.g. when a play-handle
+	// doesn't need it anymore
+	void releaseDetuning();
+
 
 private:
 	// for piano roll editing
@@ -78,6 +78,13 @@ public:
 	void rearrangeAllNotes();
 	void clearNotes();
 
+	// adding many notes (importers, paste): between beginBatchEdit() and
+	// commitBatchEdit() the mixer stays locked and addNote() just appends
+	// - notes are sorted, length and type updated and changes signalled
+	// once at commit; calls may be nested
+	void beginBatchEdit();
+	void commitBatchEdit();
+
 	inline const NoteVector & notes() const
 	{
 		return m_notes;
@@ -137,6 +144,8 @@ private:
 	NoteVector m_notes;
 	int m_steps;
 
+	int m_batchEditDepth;
+
 	friend class patternView;
 	friend class bbEditor;
 
@@ -29,7 +29,7 @@
 #include <QtGui/QPixmap>
 
 #include "SideBarWidget.h"
-#include "Plugin.h"
+#include "PluginManifest.h"
 
 
 class trackContainer;
@@ -44,8 +44,6 @@ public:
 
 
 private:
-	Plugin::DescriptorList m_pluginDescriptors;
-
 	QWidget * m_view;
 
 } ;
@@ -57,7 +55,7 @@ class pluginDescWidget : public QWidget
 {
 	Q_OBJECT
 public:
-	pluginDescWidget( const Plugin::Descriptor & _pd, QWidget * _parent );
+	pluginDescWidget( const PluginManifest::Entry & _pe, QWidget * _parent );
 	virtual ~pluginDescWidget();
 
 
@@ -73,10 +71,15 @@ private slots:
 
 
 private:
+	// loads plugin library for getting the logo when needed for the
+	// first time
+	const QPixmap & logo();
+
 	QTimer m_updateTimer;
 
-	const Plugin::Descriptor & m_pluginDescriptor;
+	PluginManifest::Entry m_pluginEntry;
 	QPixmap m_logo;
+	bool m_logoLoaded;
 
 	bool m_mouseOver;
 	int m_targetHeight;
@@ -35,6 +35,7 @@
 #include "VstSyncController.h"
 
 class AutomationTrack;
+class DataFile;
 class pattern;
 class timeLine;
 
@@ -211,6 +212,8 @@ public:
 	bool guiSaveProject();
 	bool guiSaveProjectAs( const QString & _filename );
     bool saveProjectFile( const QString & _filename );
+	// fill given data file with complete state of the project
+	void saveProjectData( DataFile & dataFile );
 	inline const QString & projectFileName() const
 	{
 		return m_fileName;
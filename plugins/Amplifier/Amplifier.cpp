@@ -71,39 +71,38 @@ bool AmplifierEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 		return( false );
 	}
 
-	double outSum = 0.0;
 	const float d = dryLevel();
 	const float w = wetLevel();
+
+	Effect::ValueRamp volume( m_ampControls.m_volumeModel, frames );
+	Effect::ValueRamp pan( m_ampControls.m_panModel, frames );
+	Effect::ValueRamp left( m_ampControls.m_leftModel, frames );
+	Effect::ValueRamp right( m_ampControls.m_rightModel, frames );
+
 	for( fpp_t f = 0; f < frames; ++f )
 	{
-//		qDebug( "offset %d, value %f", f, m_ampControls.m_volumeModel.value( f ) );
-		
 		sample_t s[2] = { buf[f][0], buf[f][1] };
 
+		const float vol = volume.next();
+		const float p = pan.next();
+
 		// convert vol/pan values to left/right values
-		const float left1 = m_ampControls.m_volumeModel.value( f ) *
-			( m_ampControls.m_panModel.value( f ) <= 0
-			? 1.0
-			: 1.0 - m_ampControls.m_panModel.value( f ) / 100.0 );
-		const float right1 = m_ampControls.m_volumeModel.value( f ) *
-			( m_ampControls.m_panModel.value( f ) >= 0
-			? 1.0
-			: 1.0 + m_ampControls.m_panModel.value( f ) / 100.0 );
+		const float left1 = vol * ( p <= 0 ? 1.0f : 1.0f - p / 100.0f );
+		const float right1 = vol * ( p >= 0 ? 1.0f : 1.0f + p / 100.0f );
 
 		// first stage amplification
-		s[0] *= ( left1 / 100.0 );
-		s[1] *= ( right1 / 100.0 );
+		s[0] *= ( left1 / 100.0f );
+		s[1] *= ( right1 / 100.0f );
 
 		// second stage amplification
-		s[0] *= ( m_ampControls.m_leftModel.value( f ) / 100.0 );
-		s[1] *= ( m_ampControls.m_rightModel.value( f ) / 100.0 );
+		s[0] *= ( left.next() / 100.0f );
+		s[1] *= ( right.next() / 100.0f );
 
 		buf[f][0] = d * buf[f][0] + w * s[0];
 		buf[f][1] = d * buf[f][1] + w * s[1];
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
 	}
 
-	checkGate( outSum / frames );
+	checkGate( buf, frames );
 
 	return isRunning();
 }
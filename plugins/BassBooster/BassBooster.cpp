@@ -71,7 +71,6 @@ bool BassBoosterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 		return( false );
 	}
 
-	double outSum = 0.0;
 	const float d = dryLevel();
 	const float w = wetLevel();
 	for( fpp_t f = 0; f < frames; ++f )
@@ -81,11 +80,13 @@ bool BassBoosterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 
 		buf[f][0] = d * buf[f][0] + w * s[0];
 		buf[f][1] = d * buf[f][1] + w * s[1];
-
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
 	}
 
-	checkGate( outSum / frames );
+	// filter tails decay into denormals which are slow to compute with
+	m_bbFX.leftFX().flushDenormals();
+	m_bbFX.rightFX().flushDenormals();
+
+	checkGate( buf, frames );
 
 	return isRunning();
 }
@@ -80,7 +80,6 @@ bool DualFilterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 		return( false );
 	}
 
-	double outSum = 0.0;
 	const float d = dryLevel();
 	const float w = wetLevel();
 
@@ -102,7 +101,10 @@ bool DualFilterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 		m_filter2changed = false;
 	}
 
-	
+	Effect::ValueRamp mix( m_dfControls.m_mixModel, frames );
+	Effect::ValueRamp gain1( m_dfControls.m_gain1Model, frames );
+	Effect::ValueRamp gain2( m_dfControls.m_gain2Model, frames );
+
 	// buffer processing loop
 	for( fpp_t f = 0; f < frames; ++f )
 	{
@@ -111,8 +113,10 @@ bool DualFilterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 		sample_t s2[2] = { buf[f][0], buf[f][1] };	// filter 2
 
 		// get mix amounts for wet signals of both filters
-		const float mix1 = 1.0f - ( ( m_dfControls.m_mixModel.value( f ) + 1.0f ) / 2.0f );
-		const float mix2 = ( ( m_dfControls.m_mixModel.value( f ) + 1.0f ) / 2.0f );
+		const float mix2 = ( ( mix.next() + 1.0f ) / 2.0f );
+		const float mix1 = 1.0f - mix2;
+		const float g1 = gain1.next() / 100.0f;
+		const float g2 = gain2.next() / 100.0f;
 
 		// update filter 1
 		if( enabled1 )
@@ -121,8 +125,8 @@ bool DualFilterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 			s1[1] = m_filter1->update( s1[1], 1 );
 
 			// apply gain
-			s1[0] *= ( m_dfControls.m_gain1Model.value( f ) / 100.0f );
-			s1[1] *= ( m_dfControls.m_gain1Model.value( f ) / 100.0f );
+			s1[0] *= g1;
+			s1[1] *= g1;
 
 			// apply mix
 			s[0] += ( s1[0] * mix1 );
@@ -136,8 +140,8 @@ bool DualFilterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 			s2[1] = m_filter2->update( s2[1], 1 );
 
 			//apply gain
-			s2[0] *= ( m_dfControls.m_gain2Model.value( f ) / 100.0f );
-			s2[1] *= ( m_dfControls.m_gain2Model.value( f ) / 100.0f );
+			s2[0] *= g2;
+			s2[1] *= g2;
 
 			// apply mix
 			s[0] += ( s2[0] * mix2 );
@@ -147,10 +151,14 @@ bool DualFilterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 		// do another mix with dry signal
 		buf[f][0] = d * buf[f][0] + w * s[0];
 		buf[f][1] = d * buf[f][1] + w * s[1];
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
 	}
 
-	checkGate( outSum / frames );
+	// resonant filters ring out into denormals which are slow to compute
+	// with
+	m_filter1->flushDenormals();
+	m_filter2->flushDenormals();
+
+	checkGate( buf, frames );
 
 	return isRunning();
 }
@@ -256,6 +256,7 @@ bool HydrogenImport::readSong()
 		int nSize = -1;
 		nSize = LocalFileMng::readXmlInt( patternNode, "size", nSize, false, false );
 		pattern_length[sName] = nSize;
+		QList<pattern *> editedPatterns;
 		QDomNode pNoteListNode = patternNode.firstChildElement( "noteList" );
 		if ( ! pNoteListNode.isNull() ) {
 			QDomNode noteNode = pNoteListNode.firstChildElement( "note" );
@@ -284,11 +285,20 @@ bool HydrogenImport::readSong()
 				n.setVolume( fVelocity * 100 );
 				n.setPanning( ( fPan_R - fPan_L ) * 100 );
 				n.setKey( NoteKey::stringToNoteKey( sKey ) );
+				if( !editedPatterns.contains( p ) )
+				{
+					p->beginBatchEdit();
+					editedPatterns << p;
+				}
 				p->addNote( n,false );
 				pn = pn + 1;
 				noteNode = ( QDomNode ) noteNode.nextSiblingElement( "note" );
 			}        
 		}
+		foreach( pattern * p, editedPatterns )
+		{
+			p->commitBatchEdit();
+		}
 		patternNode = ( QDomNode ) patternNode.nextSiblingElement( "pattern" );
 	}
 	// Pattern sequence
@@ -67,7 +67,9 @@ LadspaEffect::LadspaEffect( Model * _parent,
 	Effect( &ladspaeffect_plugin_descriptor, _parent, _key ),
 	m_controls( NULL ),
 	m_maxSampleRate( 0 ),
-	m_key( LadspaSubPluginFeatures::subPluginKeyToLadspaKey( _key ) )
+	m_key( LadspaSubPluginFeatures::subPluginKeyToLadspaKey( _key ) ),
+	m_inPlaceBroken( true ),
+	m_resampleBuffer( NULL )
 {
 	ladspa2LMMS * manager = engine::getLADSPAManager();
 	if( manager->getDescription( m_key ) == NULL )
@@ -147,16 +149,17 @@ bool LadspaEffect::processAudioBuffer( sampleFrame * _buf,
 	if( m_maxSampleRate < engine::mixer()->processingSampleRate() )
 	{
 		o_buf = _buf;
-		_buf = new sampleFrame[_frames];
+		_buf = m_resampleBuffer;
 		sampleDown( o_buf, _buf, m_maxSampleRate );
 		frames = _frames * m_maxSampleRate /
 				engine::mixer()->processingSampleRate();
 	}
 
-	// Copy the LMMS audio buffer to the LADSPA input buffer and initialize
-	// the control ports.  Need to change this to handle non-in-place-broken
-	// plugins--would speed things up to use the same buffer for both
-	// LMMS and LADSPA.
+	// Copy the LMMS audio buffer to the LADSPA input buffers and
+	// initialize the control ports.  For plugins which are not
+	// in-place-broken, input and output ports of a channel share the same
+	// buffer (see pluginInstantiation()), so there's no separate output
+	// buffer to be touched.
 	ch_cnt_t channel = 0;
 	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
 	{
@@ -175,18 +178,39 @@ bool LadspaEffect::processAudioBuffer( sampleFrame * _buf,
 					++channel;
 					break;
 				case AUDIO_RATE_INPUT:
-					pp->value = static_cast<LADSPA_Data>( 
-										pp->control->value() / pp->scale );
-					// This only supports control rate ports, so the audio rates are
-					// treated as though they were control rate by setting the
-					// port buffer to all the same value.
-					for( fpp_t frame = 0; 
-						frame < frames; ++frame )
+				{
+					const LADSPA_Data value =
+						static_cast<LADSPA_Data>(
+							pp->control->value() /
+								pp->scale );
+					if( value != pp->value )
 					{
-						pp->buffer[frame] = 
-							pp->value;
+						// ramp to new value so changing
+						// a control doesn't click
+						const LADSPA_Data step =
+							( value - pp->value ) /
+									frames;
+						for( fpp_t frame = 0;
+							frame < frames; ++frame )
+						{
+							pp->buffer[frame] =
+								pp->value +
+								step * ( frame + 1 );
+						}
+						pp->value = value;
+						pp->constantBuffer = false;
+					}
+					else if( !pp->constantBuffer )
+					{
+						for( fpp_t frame = 0;
+							frame < frames; ++frame )
+						{
+							pp->buffer[frame] = value;
+						}
+						pp->constantBuffer = true;
 					}
 					break;
+				}
 				case CONTROL_RATE_INPUT:
 					if( pp->control == NULL )
 					{
@@ -213,8 +237,7 @@ bool LadspaEffect::processAudioBuffer( sampleFrame * _buf,
 		(m_descriptor->run)( m_handles[proc], frames );
 	}
 
-	// Copy the LADSPA output buffers to the LMMS buffer.
-	double out_sum = 0.0;
+	// Mix the LADSPA output buffers into the LMMS buffer.
 	channel = 0;
 	const float d = dryLevel();
 	const float w = wetLevel();
@@ -223,39 +246,24 @@ bool LadspaEffect::processAudioBuffer( sampleFrame * _buf,
 		for( int port = 0; port < m_portCount; ++port )
 		{
 			port_desc_t * pp = m_ports.at( proc ).at( port );
-			switch( pp->rate )
+			if( pp->rate == CHANNEL_OUT )
 			{
-				case CHANNEL_IN:
-				case AUDIO_RATE_INPUT:
-				case CONTROL_RATE_INPUT:
-					break;
-				case CHANNEL_OUT:
-					for( fpp_t frame = 0; 
-						frame < frames; ++frame )
-					{
-						_buf[frame][channel] = d * _buf[frame][channel] + w * pp->buffer[frame];
-						out_sum += _buf[frame][channel] * _buf[frame][channel];
-					}
-					++channel;
-					break;
-				case AUDIO_RATE_OUTPUT:
-				case CONTROL_RATE_OUTPUT:
-					break;
-				default:
-					break;
+				for( fpp_t frame = 0; frame < frames; ++frame )
+				{
+					_buf[frame][channel] = d * _buf[frame][channel] + w * pp->buffer[frame];
+				}
+				++channel;
 			}
 		}
 	}
 
+	checkGate( _buf, frames );
+
 	if( o_buf != NULL )
 	{
 		sampleBack( _buf, o_buf, m_maxSampleRate );
-		delete[] _buf;
 	}
 
-	checkGate( out_sum / frames );
-
-
 	bool is_running = isRunning();
 	m_pluginMutex.unlock();
 	return( is_running );
@@ -270,7 +278,19 @@ void LadspaEffect::setControl( int _control, LADSPA_Data _value )
 	{
 		return;
 	}
-	m_portControls[_control]->value = _value;
+
+	port_desc_t * pp = m_portControls[_control];
+	if( pp->control != NULL )
+	{
+		// processAudioBuffer() reads the target from the control (and
+		// ramps audio-rate ports towards it), so pp->value is only the
+		// current position of the ramp and would be overwritten
+		pp->control->setValue( _value * pp->scale );
+	}
+	else
+	{
+		pp->value = _value;
+	}
 }
 
 
@@ -279,8 +299,14 @@ void LadspaEffect::setControl( int _control, LADSPA_Data _value )
 void LadspaEffect::pluginInstantiation()
 {
 	m_maxSampleRate = maxSamplerate( displayName() );
+	if( m_maxSampleRate < engine::mixer()->processingSampleRate() )
+	{
+		m_resampleBuffer =
+			new sampleFrame[engine::mixer()->framesPerPeriod()];
+	}
 
 	ladspa2LMMS * manager = engine::getLADSPAManager();
+	m_inPlaceBroken = manager->isInplaceBroken( m_key );
 
 	// Calculate how many processing units are needed.
 	const ch_cnt_t lmms_chnls = engine::mixer()->audioDev()->channels();
@@ -301,6 +327,7 @@ void LadspaEffect::pluginInstantiation()
 			p->proc = proc;
 			p->port_id = port;
 			p->control = NULL;
+			p->constantBuffer = false;
 
 			// Determine the port's category.
 			if( manager->isPortAudio( m_key, port ) )
@@ -430,6 +457,18 @@ void LadspaEffect::pluginInstantiation()
 
 			p->value = p->def;
 
+			if( p->rate == AUDIO_RATE_INPUT )
+			{
+				// unscaled, as it is fed to the plugin
+				p->value = p->def / p->scale;
+				for( fpp_t frame = 0; frame <
+					engine::mixer()->framesPerPeriod();
+								++frame )
+				{
+					p->buffer[frame] = p->value;
+				}
+				p->constantBuffer = true;
+			}
 
 			ports.append( p );
 
@@ -445,6 +484,39 @@ void LadspaEffect::pluginInstantiation()
 		m_ports.append( ports );
 	}
 
+	// Plugins which can process in-place get the same buffer connected
+	// to the input and the output port of each channel.
+	if( !m_inPlaceBroken )
+	{
+		for( ch_cnt_t proc = 0; proc < processorCount(); proc++ )
+		{
+			multi_proc_t & ports = m_ports[proc];
+			int in = 0;
+			int out = 0;
+			while( true )
+			{
+				while( in < m_portCount &&
+						ports[in]->rate != CHANNEL_IN )
+				{
+					++in;
+				}
+				while( out < m_portCount &&
+						ports[out]->rate != CHANNEL_OUT )
+				{
+					++out;
+				}
+				if( in >= m_portCount || out >= m_portCount )
+				{
+					break;
+				}
+				delete[] ports[out]->buffer;
+				ports[out]->buffer = ports[in]->buffer;
+				++in;
+				++out;
+			}
+		}
+	}
+
 	// Instantiate the processing units.
 	m_descriptor = manager->getDescriptor( m_key );
 	if( m_descriptor == NULL )
@@ -510,6 +582,9 @@ void LadspaEffect::pluginInstantiation()
 
 void LadspaEffect::pluginDestruction()
 {
+	delete[] m_resampleBuffer;
+	m_resampleBuffer = NULL;
+
 	if( !isOkay() )
 	{
 		return;
@@ -525,8 +600,25 @@ void LadspaEffect::pluginDestruction()
 		for( int port = 0; port < m_portCount; port++ )
 		{
 			port_desc_t * pp = m_ports.at( proc ).at( port );
-			delete[] pp->buffer;
-			delete pp;
+			// output buffers of in-place capable plugins are
+			// owned by the corresponding input port
+			bool shared = false;
+			for( int in = 0; pp->rate == CHANNEL_OUT &&
+						in < m_portCount; ++in )
+			{
+				const port_desc_t * ip =
+						m_ports.at( proc ).at( in );
+				shared |= ip->rate == CHANNEL_IN &&
+						ip->buffer == pp->buffer;
+			}
+			if( !shared )
+			{
+				delete[] pp->buffer;
+			}
+		}
+		for( int port = 0; port < m_portCount; port++ )
+		{
+			delete m_ports.at( proc ).at( port );
 		}
 		m_ports[proc].clear();
 	}
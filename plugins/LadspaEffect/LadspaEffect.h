@@ -76,6 +76,10 @@ private:
 	sample_rate_t m_maxSampleRate;
 	ladspa_key_t m_key;
 	int m_portCount;
+	bool m_inPlaceBroken;
+
+	// holds input at m_maxSampleRate if plugin can't run at engine rate
+	sampleFrame * m_resampleBuffer;
 
 	const LADSPA_Descriptor * m_descriptor;
 	QVector<LADSPA_Handle> m_handles;
@@ -173,9 +173,8 @@ void audioFileProcessor::saveSettings( QDomDocument & _doc,
 	_this.setAttribute( "src", m_sampleBuffer.audioFile() );
 	if( m_sampleBuffer.audioFile() == "" )
 	{
-		QString s;
-		_this.setAttribute( "sampledata",
-						m_sampleBuffer.toBase64( s ) );
+		DataFile::setEmbeddedData( _this, "sampledata",
+						m_sampleBuffer.toData() );
 	}
 	m_reverseModel.saveSettings( _doc, _this, "reversed" );
 	m_loopModel.saveSettings( _doc, _this, "looped" );
@@ -195,9 +194,10 @@ void audioFileProcessor::loadSettings( const QDomElement & _this )
 	{
 		setAudioFile( _this.attribute( "src" ), FALSE );
 	}
-	else if( _this.attribute( "sampledata" ) != "" )
+	else if( DataFile::hasEmbeddedData( _this, "sampledata" ) )
 	{
-		m_sampleBuffer.loadFromBase64( _this.attribute( "srcdata" ) );
+		m_sampleBuffer.loadFromData(
+				DataFile::embeddedData( _this, "sampledata" ) );
 	}
 	m_reverseModel.loadSettings( _this, "reversed" );
 	m_loopModel.loadSettings( _this, "looped" );
@@ -599,6 +599,9 @@ AudioFileProcessorWaveView::AudioFileProcessorWaveView( QWidget * _parent, int _
 	setFixedSize( _w, _h );
 	setMouseTracking( true );
 
+	connect( &m_sampleBuffer, SIGNAL( peaksReady() ),
+					this, SLOT( redrawGraph() ) );
+
 	if( m_sampleBuffer.frames() > 1 )
 	{
 		const f_cnt_t marging = ( m_sampleBuffer.endFrame() - m_sampleBuffer.startFrame() ) * 0.1;
@@ -214,6 +214,15 @@ public slots:
 	void isPlaying( f_cnt_t _frames_played );
 
 
+private slots:
+	// redraw graph using peaks of sample buffer once they're available
+	void redrawGraph()
+	{
+		m_last_from = m_last_to = 0;
+		update();
+	}
+
+
 private:
 	static const int s_padding = 2;
 
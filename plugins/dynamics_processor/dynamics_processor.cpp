@@ -112,19 +112,29 @@ bool dynProcEffect::processAudioBuffer( sampleFrame * _buf,
 	float sm_peak[2] = { 0.0f, 0.0f };
 	float gain;
 
-	double out_sum = 0.0;
 	const float d = dryLevel();
 	const float w = wetLevel();
+	const float input = m_dpControls.m_inputModel.value();
+	const float output = m_dpControls.m_outputModel.value();
+	const int stereoMode = m_dpControls.m_stereomodeModel.value();
+	const float * samples = m_dpControls.m_wavegraphModel.samples();
 
 // debug code	
 //	qDebug( "peaks %f %f", currentPeak[0], currentPeak[1] );
 	
-	float att_tmp = ( 1.0f / ( m_dpControls.m_attackModel.value() / 1000.0f ) ) / engine::mixer()->processingSampleRate();
-	float rel_tmp = ( 1.0f / ( m_dpControls.m_releaseModel.value() / 1000.0f ) ) / engine::mixer()->processingSampleRate();
+	// gain changes are nonlinear processing, so do everything (including
+	// wet/dry mix to keep both signals aligned) at oversampled rate
+	sampleFrame * buf = upsample( _buf, _frames );
+	const f_cnt_t frames = _frames * oversamplingFactor();
+	const float sampleRate = engine::mixer()->processingSampleRate() *
+							oversamplingFactor();
+
+	float att_tmp = ( 1.0f / ( m_dpControls.m_attackModel.value() / 1000.0f ) ) / sampleRate;
+	float rel_tmp = ( 1.0f / ( m_dpControls.m_releaseModel.value() / 1000.0f ) ) / sampleRate;
 	
-	for( fpp_t f = 0; f < _frames; ++f )
+	for( f_cnt_t f = 0; f < frames; ++f )
 	{
-		sample_t s[2] = { _buf[f][0], _buf[f][1] };
+		sample_t s[2] = { buf[f][0], buf[f][1] };
 
 // check for nan/inf because they may cause errors?
 		if( isnanf( s[0] ) ) s[0] = 0.0f;
@@ -151,7 +161,7 @@ bool dynProcEffect::processAudioBuffer( sampleFrame * _buf,
 		}
 
 // account for stereo mode
-		switch( m_dpControls.m_stereomodeModel.value() )
+		switch( stereoMode )
 		{
 			case dynProcControls::SM_Maximum:
 			{
@@ -174,8 +184,8 @@ bool dynProcEffect::processAudioBuffer( sampleFrame * _buf,
 		}
 
 // apply input gain
-		s[0] *= m_dpControls.m_inputModel.value();
-		s[1] *= m_dpControls.m_inputModel.value();
+		s[0] *= input;
+		s[1] *= input;
 
 
 // start effect
@@ -189,19 +199,19 @@ bool dynProcEffect::processAudioBuffer( sampleFrame * _buf,
 				if ( lookup < 1 )
 				{
 					frac = lookup - truncf(lookup);
-					gain = frac * m_dpControls.m_wavegraphModel.samples()[0];
+					gain = frac * samples[0];
 				}
 				else
 				if ( lookup < 200 )
 				{
 					frac = lookup - truncf(lookup);
 					gain =
-							(( (1.0f-frac) * m_dpControls.m_wavegraphModel.samples()[ (int)truncf(lookup) - 1 ] ) +
-							( frac * m_dpControls.m_wavegraphModel.samples()[ (int)truncf(lookup) ] ));
+							(( (1.0f-frac) * samples[ (int)truncf(lookup) - 1 ] ) +
+							( frac * samples[ (int)truncf(lookup) ] ));
 				}
 				else
 				{
-					gain = m_dpControls.m_wavegraphModel.samples()[199];
+					gain = samples[199];
 				};
 				
 				s[i] *= ( gain / sm_peak[i] ); 
@@ -211,17 +221,17 @@ bool dynProcEffect::processAudioBuffer( sampleFrame * _buf,
 		}
 
 // apply output gain
-		s[0] *= m_dpControls.m_outputModel.value();
-		s[1] *= m_dpControls.m_outputModel.value();
+		s[0] *= output;
+		s[1] *= output;
 
 // mix wet/dry signals
-		_buf[f][0] = d * _buf[f][0] + w * s[0];
-		_buf[f][1] = d * _buf[f][1] + w * s[1];
-
-		out_sum += _buf[f][0]*_buf[f][0] + _buf[f][1]*_buf[f][1];
+		buf[f][0] = d * buf[f][0] + w * s[0];
+		buf[f][1] = d * buf[f][1] + w * s[1];
 	}
 
-	checkGate( out_sum / _frames );
+	downsample( buf, _buf, _frames );
+
+	checkGate( _buf, _frames );
 
 	return( isRunning() );
 }
@@ -48,6 +48,7 @@
 #include "Oscillator.h"
 #include "pattern.h"
 #include "Piano.h"
+#include "PluginManifest.h"
 #include "ProjectJournal.h"
 #include "project_notes.h"
 #include "song.h"
@@ -62,6 +63,9 @@
 #define makeID(_c0, _c1, _c2, _c3) \
 	( ( _c0 ) | ( ( _c1 ) << 8 ) | ( ( _c2 ) << 16 ) | ( ( _c3 ) << 24 ) )
 
+// number of FX channels in FL Studio (without master)
+const int NumFLFxChannels = 64;
+
 
 extern "C"
 {
@@ -537,7 +541,7 @@ struct FL_Project
 	int currentPattern;
 	int activeEditPattern;
 
-	FL_EffectChannel effectChannels[NumFxChannels+1];
+	FL_EffectChannel effectChannels[NumFLFxChannels+1];
 	int currentEffectChannel;
 
 	QString projectNotes;
@@ -887,7 +891,7 @@ bool FlpImport::tryImport( TrackContainer* tc )
 				break;
 
 			case FLP_EffectChannelMuted:
-if( p.currentEffectChannel <= NumFxChannels )
+if( p.currentEffectChannel <= NumFLFxChannels )
 {
 	p.effectChannels[p.currentEffectChannel].isMuted =
 					( data & 0x08 ) > 0 ? false : true;
@@ -1124,7 +1128,7 @@ if( p.currentEffectChannel <= NumFxChannels )
 
 			case FLP_Text_EffectChanName:
 				++p.currentEffectChannel;
-				if( p.currentEffectChannel <= NumFxChannels )
+				if( p.currentEffectChannel <= NumFLFxChannels )
 				{
 					p.effectChannels[p.currentEffectChannel].name = text;
 				}
@@ -1347,7 +1351,7 @@ if( p.currentEffectChannel <= NumFxChannels )
 					const int param = pi[i*3+1] & 0xffff;
 					const int ch = ( pi[i*3+1] >> 22 )
 									& 0x7f;
-					if( ch < 0 || ch > NumFxChannels )
+					if( ch < 0 || ch > NumFLFxChannels )
 					{
 						continue;
 					}
@@ -1486,6 +1490,7 @@ else
 		t->volumeModel()->setValue( it->volume );
 		t->panningModel()->setValue( it->panning );
 		t->baseNoteModel()->setValue( it->baseNote );
+		engine::fxMixer()->ensureChannelExists( qBound( 0, it->fxChannel, NumFLFxChannels ) );
 		t->effectChannelModel()->setValue( it->fxChannel );
 
 		InstrumentSoundShaping * iss = &t->m_soundShaping;
@@ -1548,7 +1553,9 @@ else
 			it->notes += p.channels[it->layerParent].notes;
 		}
 
-		// process all notes
+		// process all notes - patterns are edited in batch mode so
+		// they're sorted and updated only once
+		QList<pattern *> editedPatterns;
 		for( FL_Channel::noteVector::ConstIterator jt = it->notes.begin();
 						jt != it->notes.end(); ++jt )
 		{
@@ -1561,11 +1568,21 @@ else
 			pattern * p = dynamic_cast<pattern *>( t->getTCO( pat ) );
 			if( p != NULL )
 			{
+				if( !editedPatterns.contains( p ) )
+				{
+					p->beginBatchEdit();
+					editedPatterns << p;
+				}
 				p->addNote( jt->second, false );
 			}
 		}
+		foreach( pattern * p, editedPatterns )
+		{
+			p->commitBatchEdit();
+		}
 
 		// process automation data
+		QList<AutomationPattern *> editedAutomation;
 		for( QList<FL_Automation>::ConstIterator jt =
 						it->automationData.begin();
 					jt != it->automationData.end(); ++jt )
@@ -1618,9 +1635,18 @@ if( scale )
 				( m->maxValue<float>() - m->minValue<float>() );
 }
 AutomationPattern * p = AutomationPattern::globalAutomationPattern( m );
+if( !editedAutomation.contains( p ) )
+{
+	p->beginBatchEdit();
+	editedAutomation << p;
+}
 p->putValue( jt->pos, value, false );
 			}
 		}
+		foreach( AutomationPattern * p, editedAutomation )
+		{
+			p->commitBatchEdit();
+		}
 
 		progressDialog.setValue( ++cur_progress );
 		qApp->processEvents();
@@ -1629,14 +1655,10 @@ p->putValue( jt->pos, value, false );
 	// process all effects
 	EffectKeyList effKeys;
 	Plugin::DescriptorList pluginDescs;
-	Plugin::getDescriptorsOfAvailPlugins( pluginDescs );
+	PluginManifest::descriptorsOfType( Plugin::Effect, pluginDescs );
 	for( Plugin::DescriptorList::ConstIterator it = pluginDescs.begin();
 											it != pluginDescs.end(); ++it )
 	{
-		if( it->type != Plugin::Effect )
-		{
-			continue;
-		}
 		if( it->subPluginFeatures )
 		{
 			it->subPluginFeatures->listSubPluginKeys( &( *it ), effKeys );
@@ -1647,7 +1669,8 @@ p->putValue( jt->pos, value, false );
 		}
 	}
 
-	for( int fx_ch = 0; fx_ch <= NumFxChannels ; ++fx_ch )
+	engine::fxMixer()->ensureChannelExists( NumFLFxChannels );
+	for( int fx_ch = 0; fx_ch <= NumFLFxChannels ; ++fx_ch )
 	{
 		FxChannel * ch = engine::fxMixer()->effectChannel( fx_ch );
 		if( !ch )
@@ -1707,7 +1730,7 @@ p->putValue( jt->pos, value, false );
 				break;
 		}
 		if( effName.isEmpty() || it->fxChannel < 0 ||
-						it->fxChannel > NumFxChannels )
+						it->fxChannel > NumFLFxChannels )
 		{
 			continue;
 		}
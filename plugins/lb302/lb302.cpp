@@ -91,6 +91,15 @@ Plugin::Descriptor PLUGIN_EXPORT lb302_plugin_descriptor =
 
 }
 
+
+// LB302 generates its output at oversampled rate (see lb302Synth::play()) so
+// all rate dependent coefficients are based on this rate
+static inline float lb302SampleRate()
+{
+	return engine::mixer()->processingSampleRate() *
+		engine::mixer()->currentQualitySettings().sampleRateMultiplier();
+}
+
 //
 // lb302Filter
 //
@@ -108,8 +117,8 @@ void lb302Filter::recalc()
 {
 	vcf_e1 = exp(6.109 + 1.5876*(fs->envmod) + 2.1553*(fs->cutoff) - 1.2*(1.0-(fs->reso)));
 	vcf_e0 = exp(5.613 - 0.8*(fs->envmod) + 2.1553*(fs->cutoff) - 0.7696*(1.0-(fs->reso)));
-	vcf_e0*=M_PI/engine::mixer()->processingSampleRate();
-	vcf_e1*=M_PI/engine::mixer()->processingSampleRate();
+	vcf_e0*=M_PI/lb302SampleRate();
+	vcf_e1*=M_PI/lb302SampleRate();
 	vcf_e1 -= vcf_e0;
 
 	vcf_rescoeff = exp(-1.20 + 3.455*(fs->reso));
@@ -225,14 +234,14 @@ void lb302Filter3Pole::envRecalc()
 	w = vcf_e0 + vcf_c0;
 	k = (fs->cutoff > 0.975)?0.975:fs->cutoff;
 	kfco = 50.f + (k)*((2300.f-1600.f*(fs->envmod))+(w) *
-	                   (700.f+1500.f*(k)+(1500.f+(k)*(engine::mixer()->processingSampleRate()/2.f-6000.f)) * 
+	                   (700.f+1500.f*(k)+(1500.f+(k)*(lb302SampleRate()/2.f-6000.f)) * 
 	                   (fs->envmod)) );
 	//+iacc*(.3+.7*kfco*kenvmod)*kaccent*kaccurve*2000
 
 
 #ifdef LB_24_IGNORE_ENVELOPE
 	// kfcn = fs->cutoff;
-	kfcn = 2.0 * kfco / engine::mixer()->processingSampleRate();
+	kfcn = 2.0 * kfco / lb302SampleRate();
 #else
 	kfcn = w;
 #endif
@@ -279,8 +288,8 @@ lb302Synth::lb302Synth( InstrumentTrack * _instrumentTrack ) :
 	slideToggle( false, this, tr( "Slide" ) ),
 	accentToggle( false, this, tr( "Accent" ) ),
 	deadToggle( false, this, tr( "Dead" ) ),
-	db24Toggle( false, this, tr( "24dB/oct Filter" ) )	
-
+	db24Toggle( false, this, tr( "24dB/oct Filter" ) ),
+	m_oversampler( engine::mixer()->framesPerPeriod() )
 {
 
 	connect( engine::mixer(), SIGNAL( sampleRateChanged( ) ),
@@ -327,8 +336,7 @@ lb302Synth::lb302Synth( InstrumentTrack * _instrumentTrack ) :
 	vca_a = 0;
 
 	//vca_attack = 1.0 - 0.94406088;
-	vca_attack = 1.0 - 0.96406088;
-	vca_decay = 0.99897516;
+	// vca_attack and vca_decay are set in filterChanged()
 
 	vco_shape = SAWTOOTH; 
 
@@ -414,10 +422,17 @@ void lb302Synth::filterChanged()
 
 	float d = 0.2 + (2.3*vcf_dec_knob.value());
 
-	d *= engine::mixer()->processingSampleRate();                                // d *= smpl rate
+	d *= lb302SampleRate();                                // d *= smpl rate
 	fs.envdecay = pow(0.1, 1.0/d * ENVINC);    // decay is 0.1 to the 1/d * ENVINC
 	                                           // vcf_envdecay is now adjusted for both
 	                                           // sampling rate and ENVINC
+
+	// amp envelope coefficients are per sample, so adjust them for
+	// oversampling
+	const float oversampling = engine::mixer()->
+				currentQualitySettings().sampleRateMultiplier();
+	vca_attack = 1.0 - pow(0.96406088, 1.0/oversampling);
+	vca_decay = pow(0.99897516, 1.0/oversampling);
 	recalcFilter();
 }
 
@@ -460,7 +475,7 @@ inline int MIN(int a, int b) {
 }
 
 inline float GET_INC(float freq) {
-	return freq/engine::mixer()->processingSampleRate();  // TODO: Use actual sampling rate.
+	return freq/lb302SampleRate();  // TODO: Use actual sampling rate.
 }
 
 int lb302Synth::process(sampleFrame *outbuf, const int size)
@@ -471,6 +486,11 @@ int lb302Synth::process(sampleFrame *outbuf, const int size)
 	// Hold on to the current VCF, and use it throughout this period
 	lb302Filter *filter = vcf;
 
+	// slide coefficient is applied every ENVINC samples, so adjust it for
+	// oversampling
+	const float slide_dec = pow(0.9+(slide_dec_knob.value()*0.0999),
+					1.0/m_oversampler.factor());
+
 	if( delete_freq == current_freq ) {
 		// Normal release
 		delete_freq = -1;
@@ -510,7 +530,7 @@ int lb302Synth::process(sampleFrame *outbuf, const int size)
 			if (vco_slide) {
 					vco_inc=vco_slidebase-vco_slide;
 					// Calculate coeff from dec_knob on knob change.
-					vco_slide*= 0.9+(slide_dec_knob.value()*0.0999); // TODO: Adjust for Hz and ENVINC
+					vco_slide*= slide_dec; // TODO: Adjust for Hz and ENVINC
 
 			}
 		}
@@ -633,7 +653,7 @@ int lb302Synth::process(sampleFrame *outbuf, const int size)
 		// Handle Envelope
 		if(vca_mode==0) {
 			vca_a+=(vca_a0-vca_a)*vca_attack;
-			if(sample_cnt>=0.5*engine::mixer()->processingSampleRate()) 
+			if(sample_cnt>=0.5*lb302SampleRate()) 
 				vca_mode = 2;
 		}
 		else if(vca_mode == 1) {
@@ -773,7 +793,14 @@ void lb302Synth::play( sampleFrame * _working_buffer )
 	//printf(".");
 	const fpp_t frames = engine::mixer()->framesPerPeriod();
 
-	process( _working_buffer, frames); 
+	// oscillator shapes and distortion alias less when being generated at
+	// oversampled rate, the factor follows current quality settings
+	m_oversampler.setFactor( engine::mixer()->
+			currentQualitySettings().sampleRateMultiplier() );
+	sampleFrame * buf = m_oversampler.oversampledBuffer();
+	process( buf, frames * m_oversampler.factor() );
+	m_oversampler.downsample( buf, _working_buffer, frames );
+
 	instrumentTrack()->processAudioBuffer( _working_buffer, frames,
 									NULL );
 }
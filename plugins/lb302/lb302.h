@@ -38,6 +38,7 @@
 #include "led_checkbox.h"
 #include "knob.h"
 #include "Mixer.h"
+#include "Oversampler.h"
 
 static const int NUM_FILTERS = 2;
 
@@ -236,6 +237,8 @@ private:
 	float delete_freq;
 	float true_freq;
 
+	Oversampler m_oversampler;
+
 	void recalcFilter();
 
 	int process(sampleFrame *outbuf, const int size);
@@ -167,6 +167,7 @@ public:
 
 	void clear()
 	{
+		finishPattern();
 		at = NULL;
 		ap = NULL;
 		lastPos = 0;
@@ -177,20 +178,32 @@ public:
 	{
 		if( !ap || time > lastPos + DefaultTicksPerTact )
 		{
+			finishPattern();
 			MidiTime pPos = MidiTime( time.getTact(), 0 );
 			ap = dynamic_cast<AutomationPattern*>(
 				at->createTCO(0) );
 			ap->movePosition( pPos );
+			ap->beginBatchEdit();
 		}
 		ap->addObject( objModel );
 
 		lastPos = time;
 		time = time - ap->startPosition();
 		ap->putValue( time, value, false );
-		ap->changeLength( MidiTime( time.getTact() + 1, 0 ) ); 
 
 		return *this;
 	}
+
+
+	void finishPattern()
+	{
+		if( ap )
+		{
+			const MidiTime time = lastPos - ap->startPosition();
+			ap->changeLength( MidiTime( time.getTact() + 1, 0 ) );
+			ap->commitBatchEdit();
+		}
+	}
 };
 
 
@@ -205,7 +218,8 @@ public:
 		it_inst( NULL ),
 		isSF2( false ),
 		hasNotes( false ),
-		lastEnd( 0 )
+		lastEnd( 0 ),
+		editing( false )
 	{ }
 	
 	InstrumentTrack * it;
@@ -214,6 +228,7 @@ public:
 	bool isSF2; 
 	bool hasNotes;
 	MidiTime lastEnd;
+	bool editing;
 	
 	smfMidiChannel * create( TrackContainer* tc )
 	{
@@ -248,16 +263,32 @@ public:
 	{
 		if( !p || n.pos() > lastEnd + DefaultTicksPerTact )
 		{
+			finishPattern();
 			MidiTime pPos = MidiTime( n.pos().getTact(), 0 );
 			p = dynamic_cast<pattern *>( it->createTCO( 0 ) );
 			p->movePosition( pPos );
 		}
+		if( !editing )
+		{
+			p->beginBatchEdit();
+			editing = true;
+		}
 		hasNotes = true;
 		lastEnd = n.pos() + n.length();
 		n.setPos( n.pos( p->startPosition() ) );
 		p->addNote( n, false );
 	}
 
+
+	void finishPattern()
+	{
+		if( editing )
+		{
+			p->commitBatchEdit();
+			editing = false;
+		}
+	}
+
 };
 
 
@@ -296,6 +327,8 @@ bool MidiImport::readSMF( TrackContainer* tc )
 	double ticksPerBeat = DefaultTicksPerTact / beatsPerTact;
 
 	// Time-sig changes
+	timeSigNumeratorPat->beginBatchEdit();
+	timeSigDenominatorPat->beginBatchEdit();
 	Alg_time_sigs * timeSigs = &seq->time_sig;
 	for( int s = 0; s < timeSigs->length(); ++s )
 	{
@@ -313,6 +346,8 @@ bool MidiImport::readSMF( TrackContainer* tc )
 		}
 
 	}
+	timeSigNumeratorPat->commitBatchEdit();
+	timeSigDenominatorPat->commitBatchEdit();
 
 	pd.setValue( 2 );
 
@@ -321,6 +356,7 @@ bool MidiImport::readSMF( TrackContainer* tc )
 	if( tap )
 	{
 		tap->clear();
+		tap->beginBatchEdit();
 		Alg_time_map * timeMap = seq->get_time_map();
 		Alg_beats & beats = timeMap->beats;
 		for( int i = 0; i < beats.len - 1; i++ )
@@ -335,6 +371,7 @@ bool MidiImport::readSMF( TrackContainer* tc )
 			Alg_beat_ptr b = &( beats[beats.len - 1] );
 			tap->putValue( b->beat * ticksPerBeat, timeMap->last_tempo * 60.0 );
 		}
+		tap->commitBatchEdit();
 	}
 
 	// Song events
@@ -355,11 +392,6 @@ bool MidiImport::readSMF( TrackContainer* tc )
 		Alg_track_ptr trk = seq->track( t );
 		pd.setValue( t + preTrackSteps );
 
-		for( int c = 0; c < 129; c++ )
-		{
-			ccs[c].clear();
-		}
-
 		// Now look at events
 		for( int e = 0; e < trk->length(); ++e )
 		{
@@ -480,6 +512,17 @@ bool MidiImport::readSMF( TrackContainer* tc )
 				}
 			}
 		}
+
+		// finish this track's patterns - sorts notes, updates lengths
+		// and notifies views once per pattern
+		for( int c = 0; c < 129; c++ )
+		{
+			ccs[c].clear();
+		}
+		for( int c = 0; c < 256; c++ )
+		{
+			chs[c].finishPattern();
+		}
 	}
 
 	delete seq;
@@ -153,7 +153,7 @@ opl2instrument::opl2instrument( InstrumentTrack * _instrument_track ) :
 	emulatorMutex.unlock();
 
 	//Initialize voice values
-	voiceNote[0] = 0;
+	voiceNote[0] = OPL2_VOICE_FREE;
 	voiceLRU[0] = 0;
 	for(int i=1; i<9; ++i) {
 		voiceNote[i] = OPL2_VOICE_FREE;
@@ -406,6 +406,19 @@ void opl2instrument::play( sampleFrame * _working_buffer )
 }
 
 
+// no voice assigned to a key anymore - release tails are covered by
+// InstrumentTrack checking for silent output
+bool opl2instrument::isIdle()
+{
+	for( int v = 0; v < 9; ++v ) {
+		if( voiceNote[v] != OPL2_VOICE_FREE ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
 void opl2instrument::saveSettings( QDomDocument & _doc, QDomElement & _this )
 {
 	op1_a_mdl.saveSettings( _doc, _this, "op1_a" );
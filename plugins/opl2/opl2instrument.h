@@ -55,6 +55,7 @@ public:
 
 	virtual bool handleMidiEvent( const MidiEvent& event, const MidiTime& time );
 	virtual void play( sampleFrame * _working_buffer );
+	virtual bool isIdle();
 
 	void saveSettings( QDomDocument & _doc, QDomElement & _this );
 	void loadSettings( const QDomElement & _this );
@@ -628,6 +628,23 @@ void sf2Instrument::playNote( NotePlayHandle * _n, sampleFrame * )
 
 // Could we get iph-based instruments support sample-exact models by using a
 // frame-length of 1 while rendering?
+bool sf2Instrument::isIdle()
+{
+	// FluidSynth only lists voices which are still playing (including
+	// release phase) - reverb and chorus tails are covered by
+	// InstrumentTrack checking for silent output
+	fluid_voice_t * voices[1];
+
+	m_synthMutex.lock();
+	fluid_synth_get_voicelist( m_synth, voices, 1, -1 );
+	m_synthMutex.unlock();
+
+	return voices[0] == NULL;
+}
+
+
+
+
 void sf2Instrument::play( sampleFrame * _working_buffer )
 {
 	const fpp_t frames = engine::mixer()->framesPerPeriod();
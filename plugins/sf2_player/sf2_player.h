@@ -58,6 +58,8 @@ public:
 
 	virtual void play( sampleFrame * _working_buffer );
 
+	virtual bool isIdle();
+
 	virtual void playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer );
 	virtual void deleteNotePluginData( NotePlayHandle * _n );
@@ -36,6 +36,7 @@ float frnd(float range)
 }
 
 
+#include <QtCore/QTimer>
 #include <QtXml/QDomElement>
 
 #include "sfxr.h"
@@ -352,6 +353,38 @@ sfxrInstrument::sfxrInstrument( InstrumentTrack * _instrument_track ) :
 	m_hpFilCutSweepModel(0.0f, this, "HP Filter Cutoff Sweep"),
 	m_waveFormModel( SQR_WAVE, 0, WAVES_NUM-1, this, tr( "Wave Form" ) )
 {
+	m_sample = renderSample();
+	m_sampleDirty = false;
+
+	m_numNoteData = 0;
+	m_notePool.reserve( InitialNotePoolSize );
+	for( int i = 0; i < InitialNotePoolSize; ++i )
+	{
+		NoteData * data = new NoteData;
+		data->sample = NULL;
+		data->state = new SampleBuffer::handleState( true );
+		m_notePool.push_back( data );
+		++m_numNoteData;
+	}
+
+	Model * models[] = { &m_attModel, &m_holdModel, &m_susModel, &m_decModel,
+		&m_startFreqModel, &m_minFreqModel, &m_slideModel, &m_dSlideModel,
+		&m_vibDepthModel, &m_vibSpeedModel,
+		&m_changeAmtModel, &m_changeSpeedModel,
+		&m_sqrDutyModel, &m_sqrSweepModel,
+		&m_repeatSpeedModel,
+		&m_phaserOffsetModel, &m_phaserSweepModel,
+		&m_lpFilCutModel, &m_lpFilCutSweepModel, &m_lpFilResoModel,
+		&m_hpFilCutModel, &m_hpFilCutSweepModel,
+		&m_waveFormModel } ;
+	for( unsigned int i = 0; i < sizeof( models ) / sizeof( models[0] ); ++i )
+	{
+		// models might be changed by automation within the mixer
+		// thread, the sound has to be rendered in our own thread though
+		connect( models[i], SIGNAL( dataChanged() ),
+					this, SLOT( invalidateSample() ),
+					Qt::QueuedConnection );
+	}
 }
 
 
@@ -359,6 +392,13 @@ sfxrInstrument::sfxrInstrument( InstrumentTrack * _instrument_track ) :
 
 sfxrInstrument::~sfxrInstrument()
 {
+	// all notes have been released already
+	for( int i = 0; i < m_notePool.size(); ++i )
+	{
+		delete m_notePool[i]->state;
+		delete m_notePool[i];
+	}
+	sharedObject::unref( m_sample );
 }
 
 
@@ -436,6 +476,9 @@ void sfxrInstrument::loadSettings( const QDomElement & _this )
 
 	m_waveFormModel.loadSettings( _this, "waveForm" );
 
+	// make the loaded sound available right away
+	m_sampleDirty = true;
+	updateSample();
 }
 
 
@@ -451,50 +494,161 @@ QString sfxrInstrument::nodeName() const
 
 void sfxrInstrument::playNote( NotePlayHandle * _n, sampleFrame * _working_buffer )
 {
-	float currentSampleRate = engine::mixer()->processingSampleRate();
-
-    fpp_t frameNum = _n->framesLeftForCurrentPeriod();
+	const fpp_t frameNum = _n->framesLeftForCurrentPeriod();
 	if ( _n->totalFramesPlayed() == 0 || _n->m_pluginData == NULL )
 	{
-		_n->m_pluginData = new SfxrSynth( this );
+		if( _n->m_pluginData != NULL )
+		{
+			deleteNotePluginData( _n );
+		}
+
+		NoteData * data = acquireNoteData();
+
+		// the sound is rendered by updateSample() whenever the
+		// settings change so just pick up the current one
+		m_sampleMutex.lock();
+		data->sample = sharedObject::ref( m_sample );
+		m_sampleMutex.unlock();
+
+		_n->m_pluginData = data;
 	}
-	else if( static_cast<SfxrSynth*>(_n->m_pluginData)->isPlaying() == false )
+
+	NoteData * data = static_cast<NoteData *>( _n->m_pluginData );
+	if( !data->sample->play( _working_buffer, data->state, frameNum,
+							_n->frequency() ) )
 	{
+		// the sound is over
 		_n->noteOff();
 		return;
 	}
 
-	int32_t pitchedFrameNum = (_n->frequency()/BaseFreq)*frameNum;
+	applyRelease( _working_buffer, _n );
+
+	instrumentTrack()->processAudioBuffer( _working_buffer, frameNum, _n );
+
+}
 
-	pitchedFrameNum /= ( currentSampleRate / 44100 );
 
-// debug code
-//	qDebug( "pFN %d", pitchedFrameNum );
 
-	sampleFrame * pitchedBuffer = new sampleFrame[pitchedFrameNum];
-	static_cast<SfxrSynth*>(_n->m_pluginData)->update( pitchedBuffer, pitchedFrameNum );
-	for( fpp_t i=0; i<frameNum; i++ )
+
+void sfxrInstrument::deleteNotePluginData( NotePlayHandle * _n )
+{
+	NoteData * data = static_cast<NoteData *>( _n->m_pluginData );
+	sharedObject::unref( data->sample );
+	data->sample = NULL;
+	releaseNoteData( data );
+	_n->m_pluginData = NULL;
+}
+
+
+
+
+sfxrInstrument::NoteData * sfxrInstrument::acquireNoteData()
+{
+	m_notePoolMutex.lock();
+	NoteData * data;
+	if( m_notePool.isEmpty() )
 	{
-		for( ch_cnt_t j=0; j<DEFAULT_CHANNELS; j++ )
-		{
-			_working_buffer[i][j] = pitchedBuffer[i*pitchedFrameNum/frameNum][j];
-		}
+		// more notes than ever before - grow the pool, so the entry
+		// can be given back later without reallocating it
+		++m_numNoteData;
+		m_notePool.reserve( m_numNoteData );
+		m_notePoolMutex.unlock();
+
+		data = new NoteData;
+		data->sample = NULL;
+		// always resample, notes can be detuned at any time
+		data->state = new SampleBuffer::handleState( true );
+		return data;
 	}
+	data = m_notePool.last();
+	m_notePool.pop_back();
+	m_notePoolMutex.unlock();
+
+	// state has been reset when being released
+	return data;
+}
 
-	delete[] pitchedBuffer;
 
-	applyRelease( _working_buffer, _n );
 
-	instrumentTrack()->processAudioBuffer( _working_buffer, frameNum, _n );
 
+void sfxrInstrument::releaseNoteData( NoteData * _data )
+{
+	_data->state->reset();
+	m_notePoolMutex.lock();
+	// capacity has been reserved in acquireNoteData()
+	m_notePool.push_back( _data );
+	m_notePoolMutex.unlock();
 }
 
 
 
 
-void sfxrInstrument::deleteNotePluginData( NotePlayHandle * _n )
+void sfxrInstrument::invalidateSample()
+{
+	// render only once for a bunch of changes (e.g. when loading a
+	// preset or moving a knob)
+	if( !m_sampleDirty )
+	{
+		m_sampleDirty = true;
+		QTimer::singleShot( 0, this, SLOT( updateSample() ) );
+	}
+}
+
+
+
+
+void sfxrInstrument::updateSample()
+{
+	if( !m_sampleDirty )
+	{
+		return;
+	}
+	m_sampleDirty = false;
+
+	SampleBuffer * sample = renderSample();
+
+	m_sampleMutex.lock();
+	SampleBuffer * oldSample = m_sample;
+	m_sample = sample;
+	m_sampleMutex.unlock();
+
+	// notes still playing the old sound keep their own reference
+	sharedObject::unref( oldSample );
+}
+
+
+
+
+SampleBuffer * sfxrInstrument::renderSample()
 {
-	delete static_cast<SfxrSynth *>( _n->m_pluginData );
+	// sfxr always renders at 44100 Hz - every sound ends with its volume
+	// envelope at the latest
+	const float att = m_attModel.value();
+	const float hold = m_holdModel.value();
+	const float dec = m_decModel.value();
+	const f_cnt_t maxFrames = (f_cnt_t)( att * att * 100000.0f ) +
+				(f_cnt_t)( hold * hold * 100000.0f ) +
+				(f_cnt_t)( dec * dec * 100000.0f ) + 3;
+
+	const fpp_t chunkSize = 256;
+	sampleFrame * buffer = new sampleFrame[maxFrames + chunkSize];
+	f_cnt_t frames = 0;
+
+	SfxrSynth synth( this );
+	while( frames < maxFrames && synth.isPlaying() )
+	{
+		synth.update( buffer + frames, chunkSize );
+		frames += chunkSize;
+	}
+
+	SampleBuffer * sample = new SampleBuffer( buffer,
+						qMin( frames, maxFrames ) );
+	sample->setFrequency( BaseFreq );
+	sample->setSampleRate( 44100 );
+	delete[] buffer;
+
+	return sample;
 }
 
 
@@ -28,8 +28,12 @@
 #ifndef SFXR_H
 #define SFXR_H
 
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+
 #include "Instrument.h"
 #include "InstrumentView.h"
+#include "SampleBuffer.h"
 #include "knob.h"
 #include "graph.h"
 #include "pixmap_button.h"
@@ -183,7 +187,38 @@ public:
 	void resetModels();
 
 
+private slots:
+	void invalidateSample();
+	void updateSample();
+
+
 private:
+	// renders the whole sound for the current settings at BaseFreq
+	SampleBuffer * renderSample();
+
+	struct NoteData
+	{
+		SampleBuffer * sample;
+		SampleBuffer::handleState * state;
+	} ;
+
+	NoteData * acquireNoteData();
+	void releaseNoteData( NoteData * _data );
+
+	// the sound only depends on the settings and the pitch, so it is
+	// rendered once (outside the mixer) and then resampled for each note
+	SampleBuffer * m_sample;
+	bool m_sampleDirty;
+	// only guards replacing m_sample
+	QMutex m_sampleMutex;
+
+	// note data is kept in a pool so starting a note doesn't allocate
+	// (and set up a resampler) within the mixer threads
+	static const int InitialNotePoolSize = 16;
+	QVector<NoteData *> m_notePool;
+	int m_numNoteData;
+	QMutex m_notePoolMutex;
+
 	SfxrZeroToOneFloatModel m_attModel;
 	SfxrZeroToOneFloatModel m_holdModel;
 	SfxrZeroToOneFloatModel m_susModel;
@@ -51,6 +51,10 @@ cSID::cSID()
   bus_value_ttl = 0;
 
   ext_in = 0;
+
+  for (int i = 0; i < 3; i++) {
+    voice_volume[i] = 256;
+  }
 }
 
 
@@ -107,6 +111,14 @@ void cSID::input(int sample)
   ext_in = (sample << 4)*3;
 }
 
+// ----------------------------------------------------------------------------
+// Set gain of a voice (8.8 fixed point).
+// ----------------------------------------------------------------------------
+void cSID::set_voice_volume(int i, int volume)
+{
+  voice_volume[i] = volume;
+}
+
 // ----------------------------------------------------------------------------
 // Read sample from audio output.
 // Both 16-bit and n-bit output is provided.
@@ -638,7 +650,9 @@ void cSID::clock()
   }
 
   // Clock filter.
-  filter.clock(voice[0].output(), voice[1].output(), voice[2].output(), ext_in);
+  filter.clock((voice[0].output()*voice_volume[0]) >> 8,
+	       (voice[1].output()*voice_volume[1]) >> 8,
+	       (voice[2].output()*voice_volume[2]) >> 8, ext_in);
 
   // Clock external filter.
   extfilt.clock(filter.output());
@@ -718,7 +732,9 @@ void cSID::clock(cycle_count delta_t)
 
   // Clock filter.
   filter.clock(delta_t,
-	       voice[0].output(), voice[1].output(), voice[2].output(), ext_in);
+	       (voice[0].output()*voice_volume[0]) >> 8,
+	       (voice[1].output()*voice_volume[1]) >> 8,
+	       (voice[2].output()*voice_volume[2]) >> 8, ext_in);
 
   // Clock external filter.
   extfilt.clock(delta_t, filter.output());
@@ -43,6 +43,11 @@ public:
   void fc_default(const fc_point*& points, int& count);
   PointPlotter<sound_sample> fc_plotter();
 
+  // Gain of a single voice before it enters the filter, 8.8 fixed point
+  // (256 = unity). Used to apply note volumes when one chip plays
+  // several notes.
+  void set_voice_volume(int i, int volume);
+
   void clock();
   void clock(cycle_count delta_t);
   int clock(cycle_count& delta_t, short* buf, int n, int interleave = 1);
@@ -110,6 +115,9 @@ protected:
   // External audio input.
   int ext_in;
 
+  // Voice gains (8.8 fixed point).
+  int voice_volume[3];
+
   // Resampling constants.
   // The error in interpolated lookup is bounded by 1.234/L^2,
   // while the error in non-interpolated lookup is bounded by
@@ -34,7 +34,9 @@
 #include "sid_instrument.h"
 #include "engine.h"
 #include "InstrumentTrack.h"
+#include "InstrumentPlayHandle.h"
 #include "knob.h"
+#include "led_checkbox.h"
 #include "NotePlayHandle.h"
 #include "pixmap_button.h"
 #include "tooltip.h"
@@ -126,17 +128,44 @@ sidInstrument::sidInstrument( InstrumentTrack * _instrument_track ) :
 	// misc
 	m_voice3OffModel( false, this, tr( "Voice 3 off" ) ),
 	m_volumeModel( 15.0f, 0.0f, 15.0f, 1.0f, this, tr( "Volume" ) ),
-	m_chipModel( sidMOS8580, 0, NumChipModels-1, this, tr( "Chip model" ) )
+	m_chipModel( sidMOS8580, 0, NumChipModels-1, this, tr( "Chip model" ) ),
+	m_sharedChipModel( false, this, tr( "Shared chip" ) ),
+	m_sharedPlayHandleAdded( false ),
+	m_sharedSid( new cSID() ),
+	m_sharedNoteCounter( 0 ),
+	m_sharedTailFrames( 0 ),
+	m_sharedBuffer( new short[engine::mixer()->framesPerPeriod()] )
 {
 	for( int i = 0; i < 3; ++i )
 	{
 		m_voice[i] = new voiceObject( this, i );
+
+		m_sharedNotes[i] = NULL;
+		m_sharedNoteStart[i] = 0;
+		m_sharedFrequency[i] = 440.0f;
+		m_sharedVolume[i] = 256;
+		m_sharedRetrigger[i] = false;
 	}
+
+	m_sharedSid->set_sampling_parameters( C64_PAL_CYCLES_PER_SEC,
+			SAMPLE_FAST, engine::mixer()->processingSampleRate() );
+	m_sharedSid->enable_filter( true );
+	m_sharedSid->reset();
+
+	// might be changed by automation within the mixer thread
+	connect( &m_sharedChipModel, SIGNAL( dataChanged() ),
+			this, SLOT( updateSharedChipMode() ),
+			Qt::QueuedConnection );
+	connect( engine::mixer(), SIGNAL( sampleRateChanged() ),
+					this, SLOT( updateSampleRate() ) );
 }
 
 
 sidInstrument::~sidInstrument()
 {
+	engine::mixer()->removePlayHandles( instrumentTrack() );
+	delete m_sharedSid;
+	delete[] m_sharedBuffer;
 }
 
 
@@ -181,6 +210,7 @@ void sidInstrument::saveSettings( QDomDocument & _doc,
 	m_voice3OffModel.saveSettings( _doc, _this, "voice3Off" );
 	m_volumeModel.saveSettings( _doc, _this, "volume" );
 	m_chipModel.saveSettings( _doc, _this, "chipModel" );
+	m_sharedChipModel.saveSettings( _doc, _this, "sharedChip" );
 }
 
 
@@ -215,6 +245,7 @@ void sidInstrument::loadSettings( const QDomElement & _this )
 	m_voice3OffModel.loadSettings( _this, "voice3Off" );
 	m_volumeModel.loadSettings( _this, "volume" );
 	m_chipModel.loadSettings( _this, "chipModel" );
+	m_sharedChipModel.loadSettings( _this, "sharedChip" );
 }
 
 
@@ -299,6 +330,115 @@ static int sid_fillbuffer(unsigned char* sidreg, cSID *sid, int tdelta, short *p
 
 
 
+void sidInstrument::updateChipModel( cSID * _sid ) const
+{
+	if( (ChipModel)m_chipModel.value() == sidMOS6581 )
+	{
+		_sid->set_chip_model( MOS6581 );
+	}
+	else
+	{
+		_sid->set_chip_model( MOS8580 );
+	}
+}
+
+
+
+
+void sidInstrument::writeVoiceRegisters( unsigned char * _sidreg, int _base,
+						const voiceObject * _v, float _freq,
+						bool _gate ) const
+{
+	const int clockrate = C64_PAL_CYCLES_PER_SEC;
+
+	reg8 data8 = 0;
+	reg8 data16 = 0;
+	float note = 0.0;
+
+	// freq ( Fn = Fout / Fclk * 16777216 ) + coarse detuning
+	note = 69.0 + 12.0 * log( _freq / 440.0 ) / log( 2 );
+	note += _v->m_coarseModel.value();
+	_freq = 440.0 * pow( 2.0, (note-69.0)/12.0 );
+	data16 = int( _freq / float(clockrate) * 16777216.0 );
+
+	_sidreg[_base+0] = data16&0x00FF;
+	_sidreg[_base+1] = (data16>>8)&0x00FF;
+	// pw
+	data16 = (int)_v->m_pulseWidthModel.value();
+	
+	_sidreg[_base+2] = data16&0x00FF;
+	_sidreg[_base+3] = (data16>>8)&0x000F;
+	// control: wave form, (test), ringmod, sync, gate
+	data8 = _gate?1:0;
+	data8 += _v->m_syncModel.value()?2:0;
+	data8 += _v->m_ringModModel.value()?4:0;
+	data8 += _v->m_testModel.value()?8:0;
+	switch( _v->m_waveFormModel.value() )
+	{	
+		default: break;
+		case voiceObject::NoiseWave:	data8 += 128; break;
+		case voiceObject::SquareWave:	data8 += 64; break;
+		case voiceObject::SawWave:		data8 += 32; break;
+		case voiceObject::TriangleWave:	data8 += 16; break;
+	}
+	_sidreg[_base+4] = data8&0x00FF;
+	// ad
+	data16 = (int)_v->m_attackModel.value();
+
+	data8 = (data16&0x0F)<<4;
+	data16 = (int)_v->m_decayModel.value();
+
+	data8 += (data16&0x0F);
+	_sidreg[_base+5] = data8&0x00FF;
+	// sr
+	data16 = (int)_v->m_sustainModel.value();
+
+	data8 = (data16&0x0F)<<4;
+	data16 = (int)_v->m_releaseModel.value();
+
+	data8 += (data16&0x0F);
+	_sidreg[_base+6] = data8&0x00FF;
+}
+
+
+
+
+void sidInstrument::writeFilterRegisters( unsigned char * _sidreg,
+						int _filtered, bool _voice3Off ) const
+{
+	reg8 data8 = 0;
+	reg8 data16 = 0;
+
+	// FC (FilterCutoff)
+	data16 = (int)m_filterFCModel.value();
+	_sidreg[21] = data16&0x0007;
+	_sidreg[22] = (data16>>3)&0x00FF;
+	
+	// res, filt ex,3,2,1
+	data16 = (int)m_filterResonanceModel.value();
+	data8 = (data16&0x000F)<<4;
+	data8 += _filtered&0x07;
+	_sidreg[23] = data8&0x00FF;
+
+	// mode vol
+	data16 = (int)m_volumeModel.value();
+	data8 = data16&0x000F;
+	data8 += _voice3Off?128:0;
+
+	switch( m_filterModeModel.value() )
+	{	
+		default: break;
+		case LowPass:	data8 += 16; break;
+		case BandPass:	data8 += 32; break;
+		case HighPass:	data8 += 64; break;
+	}
+
+	_sidreg[24] = data8&0x00FF;
+}
+
+
+
+
 void sidInstrument::playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer )
 {
@@ -309,6 +449,16 @@ void sidInstrument::playNote( NotePlayHandle * _n,
 
 	if ( tfp == 0 )
 	{
+		// the mode only applies to notes starting from now on, running
+		// notes stay where they are if it gets switched
+		if( m_sharedChipModel.value() && m_sharedPlayHandleAdded )
+		{
+			// note is rendered by play() on one of the voices of
+			// the shared chip
+			_n->m_pluginData = NULL;
+			allocateSharedVoice( _n );
+			return;
+		}
 		cSID *sid = new cSID();
 		sid->set_sampling_parameters( clockrate, SAMPLE_FAST, samplerate );
 		sid->set_chip_model( MOS8580 );
@@ -316,6 +466,14 @@ void sidInstrument::playNote( NotePlayHandle * _n,
 		sid->reset();
 		_n->m_pluginData = sid;
 	}
+
+	// shared-chip notes keep running on the shared chip even if the mode
+	// has been switched off in the meantime
+	if( _n->m_pluginData == NULL )
+	{
+		return;
+	}
+
 	const fpp_t frames = _n->framesLeftForCurrentPeriod();
 
 	cSID *sid = static_cast<cSID *>( _n->m_pluginData );
@@ -328,113 +486,213 @@ void sidInstrument::playNote( NotePlayHandle * _n,
 		sidreg[c] = 0x00;
 	}
 
-	if( (ChipModel)m_chipModel.value() == sidMOS6581 )
+	updateChipModel( sid );
+
+	// voices
+	for( int i = 0 ; i < 3 ; ++i )
 	{
-		sid->set_chip_model( MOS6581 );
+		writeVoiceRegisters( sidreg, i*7, m_voice[i], _n->frequency(),
+							!_n->isReleased() );
 	}
-	else
+
+	// filtered
+	writeFilterRegisters( sidreg,
+			( m_voice[2]->m_filteredModel.value() ? 4 : 0 ) +
+			( m_voice[1]->m_filteredModel.value() ? 2 : 0 ) +
+			( m_voice[0]->m_filteredModel.value() ? 1 : 0 ),
+						m_voice3OffModel.value() );
+		
+	int num = sid_fillbuffer(sidreg, sid,delta_t,buf, frames);
+	if(num!=frames)
+		printf("!!!Not enough samples\n");
+
+	for( fpp_t frame = 0; frame < frames; ++frame )
 	{
-		sid->set_chip_model( MOS8580 );
+		sample_t s = float(buf[frame])/32768.0;
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			_working_buffer[frame][ch] = s;
+		}
 	}
 
-	// voices
-	reg8 data8 = 0;
-	reg8 data16 = 0;
-	reg8 base = 0;
-	float freq = 0.0;
-	float note = 0.0;
-	for( reg8 i = 0 ; i < 3 ; ++i )
+	instrumentTrack()->processAudioBuffer( _working_buffer, frames, _n );
+}
+
+
+
+
+void sidInstrument::allocateSharedVoice( NotePlayHandle * _n )
+{
+	m_sharedSidMutex.lock();
+
+	// prefer a free voice, then the oldest released one, then the oldest
+	// one at all
+	int voice = -1;
+	for( int i = 0; i < 3 && voice < 0; ++i )
 	{
-		base = i*7;
-		// freq ( Fn = Fout / Fclk * 16777216 ) + coarse detuning
-		freq = _n->frequency();
-		note = 69.0 + 12.0 * log( freq / 440.0 ) / log( 2 );
-		note += m_voice[i]->m_coarseModel.value();
-		freq = 440.0 * pow( 2.0, (note-69.0)/12.0 );
-		data16 = int( freq / float(clockrate) * 16777216.0 );
-
-		sidreg[base+0] = data16&0x00FF;
-		sidreg[base+1] = (data16>>8)&0x00FF;
-		// pw
-		data16 = (int)m_voice[i]->m_pulseWidthModel.value();
-		
-		sidreg[base+2] = data16&0x00FF;
-		sidreg[base+3] = (data16>>8)&0x000F;
-		// control: wave form, (test), ringmod, sync, gate
-		data8 = _n->isReleased()?0:1;
-		data8 += m_voice[i]->m_syncModel.value()?2:0;
-		data8 += m_voice[i]->m_ringModModel.value()?4:0;
-		data8 += m_voice[i]->m_testModel.value()?8:0;
-		switch( m_voice[i]->m_waveFormModel.value() )
-		{	
-			default: break;
-			case voiceObject::NoiseWave:	data8 += 128; break;
-			case voiceObject::SquareWave:	data8 += 64; break;
-			case voiceObject::SawWave:		data8 += 32; break;
-			case voiceObject::TriangleWave:	data8 += 16; break;
+		if( m_sharedNotes[i] == NULL )
+		{
+			voice = i;
+		}
+	}
+	for( int pass = 0; pass < 2 && voice < 0; ++pass )
+	{
+		for( int i = 0; i < 3; ++i )
+		{
+			if( ( pass > 0 || m_sharedNotes[i]->isReleased() ) &&
+				( voice < 0 || m_sharedNoteStart[i] <
+						m_sharedNoteStart[voice] ) )
+			{
+				voice = i;
+			}
 		}
-		sidreg[base+4] = data8&0x00FF;
-		// ad
-		data16 = (int)m_voice[i]->m_attackModel.value();
+	}
+
+	m_sharedNotes[voice] = _n;
+	m_sharedNoteStart[voice] = ++m_sharedNoteCounter;
+	m_sharedRetrigger[voice] = true;
+
+	m_sharedSidMutex.unlock();
+}
+
+
 
-		data8 = (data16&0x0F)<<4;
-		data16 = (int)m_voice[i]->m_decayModel.value();
 
-		data8 += (data16&0x0F);
-		sidreg[base+5] = data8&0x00FF;
-		// sr
-		data16 = (int)m_voice[i]->m_sustainModel.value();
+void sidInstrument::play( sampleFrame * _working_buffer )
+{
+	const fpp_t frames = engine::mixer()->framesPerPeriod();
 
-		data8 = (data16&0x0F)<<4;
-		data16 = (int)m_voice[i]->m_releaseModel.value();
+	m_sharedSidMutex.lock();
 
-		data8 += (data16&0x0F);
-		sidreg[base+6] = data8&0x00FF;
+	bool notesActive = false;
+	for( int i = 0; i < 3; ++i )
+	{
+		notesActive = notesActive || m_sharedNotes[i] != NULL;
 	}
-	// filtered
 
-	// FC (FilterCutoff)
-	data16 = (int)m_filterFCModel.value();
-	sidreg[21] = data16&0x0007;
-	sidreg[22] = (data16>>3)&0x00FF;
-	
-	// res, filt ex,3,2,1
-	data16 = (int)m_filterResonanceModel.value();
-	data8 = (data16&0x000F)<<4;
-	data8 += m_voice[2]->m_filteredModel.value()?4:0;
-	data8 += m_voice[1]->m_filteredModel.value()?2:0;
-	data8 += m_voice[0]->m_filteredModel.value()?1:0;
-	sidreg[23] = data8&0x00FF;
+	// after the last note keep clocking the chip until its release tail
+	// has faded out - no matter whether the mode is still switched on
+	if( notesActive )
+	{
+		m_sharedTailFrames = desiredReleaseFrames();
+	}
+	else if( m_sharedTailFrames > 0 )
+	{
+		m_sharedTailFrames -= frames;
+	}
+	else
+	{
+		m_sharedSidMutex.unlock();
+		return;
+	}
 
-	// mode vol
-	data16 = (int)m_volumeModel.value();
-	data8 = data16&0x000F;
-	data8 += m_voice3OffModel.value()?128:0;
+	const int clockrate = C64_PAL_CYCLES_PER_SEC;
+	const int samplerate = engine::mixer()->processingSampleRate();
 
-	switch( m_filterModeModel.value() )
-	{	
-		default: break;
-		case LowPass:	data8 += 16; break;
-		case BandPass:	data8 += 32; break;
-		case HighPass:	data8 += 64; break;
+	int delta_t = clockrate * frames / samplerate + 4;
+	short * buf = m_sharedBuffer;
+	unsigned char sidreg[NUMSIDREGS];
+
+	for (int c = 0; c < NUMSIDREGS; c++)
+	{
+		sidreg[c] = 0x00;
 	}
 
-	sidreg[24] = data8&0x00FF;
-		
-	int num = sid_fillbuffer(sidreg, sid,delta_t,buf, frames);
-	if(num!=frames)
-		printf("!!!Not enough samples\n");
+	updateChipModel( m_sharedSid );
+
+	// every voice of the chip uses its own settings - sync and ring
+	// modulation would couple unrelated notes though
+	for( int i = 0; i < 3; ++i )
+	{
+		const NotePlayHandle * n = m_sharedNotes[i];
+		// keep frequency of voices in release phase
+		const float freq = n != NULL ? n->frequency() :
+							m_sharedFrequency[i];
+		writeVoiceRegisters( sidreg, i*7, m_voice[i], freq,
+						n != NULL && !n->isReleased() );
+		sidreg[i*7+4] &= ~0x06;
+		m_sharedFrequency[i] = freq;
+
+		// the chip's output isn't processed per note, so apply the
+		// volume (velocity) of each note to its voice directly
+		if( n != NULL )
+		{
+			m_sharedVolume[i] = n->getVolume() * 256 / DefaultVolume;
+		}
+		m_sharedSid->set_voice_volume( i, m_sharedVolume[i] );
+
+		// gate has to go low for at least one write so that a stolen
+		// voice restarts its envelope
+		if( m_sharedRetrigger[i] )
+		{
+			m_sharedSid->write( i*7+4, sidreg[i*7+4] & ~0x01 );
+			m_sharedSid->clock( SIDWRITEDELAY );
+			delta_t -= SIDWRITEDELAY;
+			m_sharedRetrigger[i] = false;
+		}
+	}
+
+	// voice 3 can't be switched off as it plays notes as well
+	writeFilterRegisters( sidreg,
+			( m_voice[2]->m_filteredModel.value() ? 4 : 0 ) +
+			( m_voice[1]->m_filteredModel.value() ? 2 : 0 ) +
+			( m_voice[0]->m_filteredModel.value() ? 1 : 0 ),
+									false );
+
+	// clock the chip once for all notes of this period
+	int num = sid_fillbuffer( sidreg, m_sharedSid, delta_t, buf, frames );
+
+	m_sharedSidMutex.unlock();
+
+	if( num != frames )
+	{
+		// fill the gap rather than leaving stale data in the buffer
+		for( fpp_t frame = num; frame < frames; ++frame )
+		{
+			buf[frame] = num > 0 ? buf[num-1] : 0;
+		}
+	}
 
+	bool silent = true;
 	for( fpp_t frame = 0; frame < frames; ++frame )
 	{
+		silent = silent && buf[frame] == 0;
 		sample_t s = float(buf[frame])/32768.0;
 		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
 		{
 			_working_buffer[frame][ch] = s;
 		}
 	}
+	if( silent && !notesActive )
+	{
+		m_sharedTailFrames = 0;
+	}
 
-	instrumentTrack()->processAudioBuffer( _working_buffer, frames, _n );
+	instrumentTrack()->processAudioBuffer( _working_buffer, frames, NULL );
+}
+
+
+
+
+void sidInstrument::updateSharedChipMode()
+{
+	// play() isn't needed until the shared chip is used for the first
+	// time - afterwards it returns early while there's nothing to play
+	if( m_sharedChipModel.value() && !m_sharedPlayHandleAdded )
+	{
+		m_sharedPlayHandleAdded = engine::mixer()->addPlayHandle(
+					new InstrumentPlayHandle( this ) );
+	}
+}
+
+
+
+
+void sidInstrument::updateSampleRate()
+{
+	QMutexLocker m( &m_sharedSidMutex );
+	m_sharedSid->set_sampling_parameters( C64_PAL_CYCLES_PER_SEC,
+			SAMPLE_FAST, engine::mixer()->processingSampleRate() );
 }
 
 
@@ -442,7 +700,21 @@ void sidInstrument::playNote( NotePlayHandle * _n,
 
 void sidInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<cSID *>( _n->m_pluginData );
+	if( _n->m_pluginData != NULL )
+	{
+		delete static_cast<cSID *>( _n->m_pluginData );
+		return;
+	}
+
+	// release voice on shared chip unless it has been stolen already
+	QMutexLocker m( &m_sharedSidMutex );
+	for( int i = 0; i < 3; ++i )
+	{
+		if( m_sharedNotes[i] == _n )
+		{
+			m_sharedNotes[i] = NULL;
+		}
+	}
 }
 
 
@@ -527,6 +799,16 @@ sidInstrumentView::sidInstrumentView( Instrument * _instrument,
 	m_offButton->setInactiveGraphic( PLUGIN_NAME::getIconPixmap( "3off" ) );
 	toolTip::add( m_offButton, tr( "Voice3 Off ") );
 
+	m_sharedChipButton = new ledCheckBox( "", this, tr( "Shared chip" ),
+							ledCheckBox::Green );
+	m_sharedChipButton->move( 100, 66 );
+	toolTip::add( m_sharedChipButton,
+		tr( "Play up to three notes on the voices of one chip, "
+			"each using the settings of its voice and the volume "
+			"of its note (sync, ring modulation, voice 3 off, "
+			"note panning and the track's envelopes are "
+			"ignored)" ) );
+
 	pixmapButton * mos6581_btn = new pixmapButton( this, NULL );
 	mos6581_btn->move( 170, 59 );
 	mos6581_btn->setActiveGraphic( PLUGIN_NAME::getIconPixmap( "6581red" ) );
@@ -757,6 +1039,7 @@ void sidInstrumentView::modelChanged()
 	m_passBtnGrp->setModel( &k->m_filterModeModel );
 	m_offButton->setModel(  &k->m_voice3OffModel );
 	m_sidTypeBtnGrp->setModel(  &k->m_chipModel );
+	m_sharedChipButton->setModel( &k->m_sharedChipModel );
 
 	for( int i = 0; i < 3; ++i )
 	{
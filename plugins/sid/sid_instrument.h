@@ -27,6 +27,7 @@
 #ifndef _SID_H
 #define _SID_H
 
+#include <QtCore/QMutex>
 #include <QtCore/QObject>
 #include "Instrument.h"
 #include "InstrumentView.h"
@@ -36,6 +37,8 @@
 class sidInstrumentView;
 class NotePlayHandle;
 class automatableButtonGroup;
+class cSID;
+class ledCheckBox;
 class pixmapButton;
 
 class voiceObject : public Model
@@ -91,6 +94,7 @@ public:
 	sidInstrument( InstrumentTrack * _instrument_track );
 	virtual ~sidInstrument();
 
+	virtual void play( sampleFrame * _working_buffer );
 	virtual void playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer );
 	virtual void deleteNotePluginData( NotePlayHandle * _n );
@@ -110,7 +114,20 @@ public:
 	void updateKnobHint();
 	void updateKnobToolTip();*/
 
+private slots:
+	void updateSharedChipMode();
+	void updateSampleRate();
+
 private:
+	void updateChipModel( cSID * _sid ) const;
+	void writeVoiceRegisters( unsigned char * _sidreg, int _base,
+						const voiceObject * _v, float _freq,
+						bool _gate ) const;
+	void writeFilterRegisters( unsigned char * _sidreg, int _filtered,
+						bool _voice3Off ) const;
+
+	void allocateSharedVoice( NotePlayHandle * _n );
+
 	// voices
 	voiceObject * m_voice[3];
 
@@ -125,6 +142,22 @@ private:
 
 	IntModel m_chipModel;
 
+	// shared chip - one cSID hosting up to three notes which gets
+	// clocked once per period from play()
+	BoolModel m_sharedChipModel;
+	volatile bool m_sharedPlayHandleAdded;
+	cSID * m_sharedSid;
+	NotePlayHandle * m_sharedNotes[3];
+	unsigned int m_sharedNoteStart[3];
+	unsigned int m_sharedNoteCounter;
+	float m_sharedFrequency[3];
+	int m_sharedVolume[3];
+	bool m_sharedRetrigger[3];
+	QMutex m_sharedSidMutex;
+	// only used by play()
+	f_cnt_t m_sharedTailFrames;
+	short * m_sharedBuffer;
+
 	friend class sidInstrumentView;
 
 } ;
@@ -192,6 +225,7 @@ private:
 	knob * m_resKnob;
 	knob * m_cutKnob;
 	pixmapButton * m_offButton;
+	ledCheckBox * m_sharedChipButton;
 
 protected slots:
 	void updateKnobHint();
@@ -77,13 +77,16 @@ bool stereoMatrixEffect::processAudioBuffer( sampleFrame * _buf,
 		return( false );
 	}
 
-	double out_sum = 0.0;
+	const float d = dryLevel();
+	const float w = wetLevel();
+
+	Effect::ValueRamp ll( m_smControls.m_llModel, _frames );
+	Effect::ValueRamp lr( m_smControls.m_lrModel, _frames );
+	Effect::ValueRamp rl( m_smControls.m_rlModel, _frames );
+	Effect::ValueRamp rr( m_smControls.m_rrModel, _frames );
 
 	for( fpp_t f = 0; f < _frames; ++f )
-	{	
-		const float d = dryLevel();
-		const float w = wetLevel();
-		
+	{
 		sample_t l = _buf[f][0];
 		sample_t r = _buf[f][1];
 
@@ -92,16 +95,11 @@ bool stereoMatrixEffect::processAudioBuffer( sampleFrame * _buf,
 		_buf[f][1] = r * d;
 
 		// Add it wet
-		_buf[f][0] += ( m_smControls.m_llModel.value( f ) * l  +
-					m_smControls.m_rlModel.value( f ) * r ) * w;
-
-		_buf[f][1] += ( m_smControls.m_lrModel.value( f ) * l  +
-					m_smControls.m_rrModel.value( f ) * r ) * w;
-		out_sum += _buf[f][0]*_buf[f][0] + _buf[f][1]*_buf[f][1];
-
+		_buf[f][0] += ( ll.next() * l + rl.next() * r ) * w;
+		_buf[f][1] += ( lr.next() * l + rr.next() * r ) * w;
 	}
 
-	checkGate( out_sum / _frames );
+	checkGate( _buf, _frames );
 
 	return( isRunning() );
 }
@@ -39,6 +39,23 @@
 #include "embed.cpp"
 
 
+// unlike ModalBar and BandedWG, TubeBell has no clear() for forgetting
+// about the note a reused voice played before
+class malletsTubeBell : public TubeBell
+{
+public:
+	void clear()
+	{
+		for( unsigned int i = 0; i < nOperators_; ++i )
+		{
+			waves_[i]->reset();
+			adsr_[i]->setValue( 0.0 );
+		}
+		twozero_.clear();
+	}
+} ;
+
+
 extern "C"
 {
 
@@ -59,6 +76,12 @@ Plugin::Descriptor PLUGIN_EXPORT malletsstk_plugin_descriptor =
 }
 
 
+
+
+QMutex malletsInstrument::s_stkMutex;
+
+
+
 malletsInstrument::malletsInstrument( InstrumentTrack * _instrument_track ):
 	Instrument( _instrument_track, &malletsstk_plugin_descriptor ),
 	m_hardnessModel(64.0f, 0.0f, 128.0f, 0.1f, this, tr( "Hardness" )),
@@ -124,6 +147,17 @@ malletsInstrument::malletsInstrument( InstrumentTrack * _instrument_track ):
 	m_scalers.append( 16.0 );
 	m_presetsModel.addItem( tr( "Tibetan Bowl" ) );
 	m_scalers.append( 7.0 );
+
+	for( int i = 0; i < NumVoices; ++i )
+	{
+		m_voices[i] = NULL;
+	}
+	updateVoices();
+
+	connect( &m_presetsModel, SIGNAL( dataChanged() ),
+					this, SLOT( updateVoices() ) );
+	connect( engine::mixer(), SIGNAL( sampleRateChanged() ),
+					this, SLOT( updateSampleRate() ) );
 }
 
 
@@ -131,6 +165,8 @@ malletsInstrument::malletsInstrument( InstrumentTrack * _instrument_track ):
 
 malletsInstrument::~malletsInstrument()
 {
+	engine::mixer()->removePlayHandles( instrumentTrack() );
+	deleteVoices();
 }
 
 
@@ -219,12 +255,18 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 	{
 		const float vel = _n->getVolume() / 100.0f;
 
-		// critical section as STK is not thread-safe
-		static QMutex m;
-		m.lock();
+		malletsSynth * voice =
+			static_cast<malletsSynth *>( _n->m_pluginData );
+		if( voice == NULL ||
+			voice->model() != malletsSynth::modelForPreset( p ) )
+		{
+			releaseVoice( voice );
+			voice = acquireVoice( p );
+		}
+
 		if( p < 9 )
 		{
-			_n->m_pluginData = new malletsSynth( freq,
+			voice->startModalBar( freq,
 						vel,
 						m_vibratoGainModel.value(),
 						m_hardnessModel.value(),
@@ -232,25 +274,22 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 						m_stickModel.value(),
 						m_vibratoFreqModel.value(),
 						p,
-						(uint8_t) m_spreadModel.value(),
-				engine::mixer()->processingSampleRate() );
+						(uint8_t) m_spreadModel.value() );
 		}
 		else if( p == 9 )
 		{
-			_n->m_pluginData = new malletsSynth( freq,
+			voice->startTubeBell( freq,
 						vel,
-						p,
 						m_lfoDepthModel.value(),
 						m_modulatorModel.value(),
 						m_crossfadeModel.value(),
 						m_lfoSpeedModel.value(),
 						m_adsrModel.value(),
-						(uint8_t) m_spreadModel.value(),
-				engine::mixer()->processingSampleRate() );
+						(uint8_t) m_spreadModel.value() );
 		}
 		else
 		{
-			_n->m_pluginData = new malletsSynth( freq,
+			voice->startBandedWG( freq,
 						vel,
 						m_pressureModel.value(),
 						m_motionModel.value(),
@@ -258,10 +297,9 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 						p - 10,
 						m_strikeModel.value() * 128.0,
 						m_velocityModel.value(),
-						(uint8_t) m_spreadModel.value(),
-				engine::mixer()->processingSampleRate() );
+						(uint8_t) m_spreadModel.value() );
 		}
-		m.unlock();
+		_n->m_pluginData = voice;
 	}
 
 	const fpp_t frames = _n->framesLeftForCurrentPeriod();
@@ -290,7 +328,153 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 
 void malletsInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<malletsSynth *>( _n->m_pluginData );
+	releaseVoice( static_cast<malletsSynth *>( _n->m_pluginData ) );
+}
+
+
+
+
+void malletsInstrument::updateVoices()
+{
+	if( m_filesMissing )
+	{
+		return;
+	}
+
+	const malletsSynth::Models model =
+		malletsSynth::modelForPreset( m_presetsModel.value() );
+	if( m_voices[0] != NULL && m_voices[0]->model() == model &&
+			m_voices[0]->sampleRate() ==
+				engine::mixer()->processingSampleRate() )
+	{
+		return;
+	}
+
+	// create the new voices while the current ones keep playing
+	malletsSynth * voices[NumVoices];
+	s_stkMutex.lock();
+	initStk();
+	for( int i = 0; i < NumVoices; ++i )
+	{
+		voices[i] = new malletsSynth( model );
+		voices[i]->setPoolSlot( i );
+	}
+	s_stkMutex.unlock();
+
+	malletsSynth * oldVoices[NumVoices];
+	engine::mixer()->lock();
+	for( int i = 0; i < NumVoices; ++i )
+	{
+		oldVoices[i] = m_voices[i];
+		if( m_voiceUsed[i].fetchAndStoreOrdered( 0 ) && oldVoices[i] )
+		{
+			// still in use - gets deleted as soon as its note
+			// has finished
+			oldVoices[i]->setPoolSlot( -1 );
+			oldVoices[i] = NULL;
+		}
+		m_voices[i] = voices[i];
+	}
+	engine::mixer()->unlock();
+
+	s_stkMutex.lock();
+	for( int i = 0; i < NumVoices; ++i )
+	{
+		delete oldVoices[i];
+	}
+	s_stkMutex.unlock();
+}
+
+
+
+
+void malletsInstrument::updateSampleRate()
+{
+	updateVoices();
+}
+
+
+
+
+void malletsInstrument::initStk()
+{
+	static bool rawwavePathSet = false;
+	if( !rawwavePathSet )
+	{
+		Stk::setRawwavePath( configManager::inst()->stkDir()
+						.toAscii().constData() );
+		rawwavePathSet = true;
+	}
+
+	const sample_rate_t sampleRate =
+				engine::mixer()->processingSampleRate();
+	if( Stk::sampleRate() != sampleRate )
+	{
+		Stk::setSampleRate( sampleRate );
+	}
+}
+
+
+
+
+malletsSynth * malletsInstrument::acquireVoice( const int _preset )
+{
+	const malletsSynth::Models model =
+				malletsSynth::modelForPreset( _preset );
+	for( int i = 0; i < NumVoices; ++i )
+	{
+		if( m_voices[i] != NULL && m_voices[i]->model() == model &&
+				m_voiceUsed[i].fetchAndStoreOrdered( 1 ) == 0 )
+		{
+			return m_voices[i];
+		}
+	}
+
+	// all voices busy or preset just changed - fall back to creating a
+	// voice on the fly
+	s_stkMutex.lock();
+	initStk();
+	malletsSynth * voice = new malletsSynth( model );
+	s_stkMutex.unlock();
+
+	return voice;
+}
+
+
+
+
+void malletsInstrument::releaseVoice( malletsSynth * _voice )
+{
+	if( _voice == NULL )
+	{
+		return;
+	}
+
+	if( _voice->poolSlot() >= 0 )
+	{
+		_voice->stop();
+		m_voiceUsed[_voice->poolSlot()].fetchAndStoreOrdered( 0 );
+	}
+	else
+	{
+		s_stkMutex.lock();
+		delete _voice;
+		s_stkMutex.unlock();
+	}
+}
+
+
+
+
+void malletsInstrument::deleteVoices()
+{
+	s_stkMutex.lock();
+	for( int i = 0; i < NumVoices; ++i )
+	{
+		delete m_voices[i];
+		m_voices[i] = NULL;
+	}
+	s_stkMutex.unlock();
 }
 
 
@@ -517,100 +701,116 @@ void malletsInstrumentView::changePreset()
 
 
 
-// ModalBar
-malletsSynth::malletsSynth( const StkFloat _pitch,
-				const StkFloat _velocity,
-				const StkFloat _control1,
-				const StkFloat _control2,
-				const StkFloat _control4,
-				const StkFloat _control8,
-				const StkFloat _control11,
-				const int _control16,
-				const uint8_t _delay,
-				const sample_rate_t _sample_rate )
+malletsSynth::malletsSynth( const Models _model ) :
+	m_model( _model ),
+	m_poolSlot( -1 ),
+	m_sampleRate( (sample_rate_t) Stk::sampleRate() ),
+	m_voice( NULL )
 {
 	try
 	{
-		Stk::setSampleRate( _sample_rate );
-		Stk::setRawwavePath( configManager::inst()->stkDir()
-						.toAscii().constData() );
-	
-		m_voice = new ModalBar();
-	
-		m_voice->controlChange( 1, _control1 );
-		m_voice->controlChange( 2, _control2 );
-		m_voice->controlChange( 4, _control4 );
-		m_voice->controlChange( 8, _control8 );
-		m_voice->controlChange( 11, _control11 );
-		m_voice->controlChange( 16, _control16 );
-		m_voice->controlChange( 128, 128.0f );
-		
-		m_voice->noteOn( _pitch, _velocity );
+		switch( m_model )
+		{
+			case ModalBarModel:
+				m_voice = new ModalBar();
+				break;
+			case TubeBellModel:
+				m_voice = new malletsTubeBell();
+				break;
+			case BandedWGModel:
+				m_voice = new BandedWG();
+				break;
+		}
 	}
 	catch( ... )
 	{
 		m_voice = NULL;
 	}
-	
+
 	m_delay = new StkFloat[256];
-	m_delayRead = 0;
-	m_delayWrite = _delay;
-	for( int i = 0; i < 256; i++ )
+	resetDelay( 0 );
+}
+
+
+
+
+// ModalBar
+void malletsSynth::startModalBar( const StkFloat _pitch,
+				const StkFloat _velocity,
+				const StkFloat _control1,
+				const StkFloat _control2,
+				const StkFloat _control4,
+				const StkFloat _control8,
+				const StkFloat _control11,
+				const int _control16,
+				const uint8_t _delay )
+{
+	if( m_voice )
 	{
-		m_delay[i] = 0.0;
+		try
+		{
+			// forget about the note this voice played before
+			static_cast<ModalBar *>( m_voice )->clear();
+
+			m_voice->controlChange( 1, _control1 );
+			m_voice->controlChange( 2, _control2 );
+			m_voice->controlChange( 4, _control4 );
+			m_voice->controlChange( 8, _control8 );
+			m_voice->controlChange( 11, _control11 );
+			m_voice->controlChange( 16, _control16 );
+			m_voice->controlChange( 128, 128.0f );
+
+			m_voice->noteOn( _pitch, _velocity );
+		}
+		catch( ... )
+		{
+		}
 	}
+
+	resetDelay( _delay );
 }
 
 
 
 
 // TubeBell
-malletsSynth::malletsSynth( const StkFloat _pitch,
+void malletsSynth::startTubeBell( const StkFloat _pitch,
 				const StkFloat _velocity,
-				const int _preset,
 				const StkFloat _control1,
 				const StkFloat _control2,
 				const StkFloat _control4,
 				const StkFloat _control11,
 				const StkFloat _control128,
-				const uint8_t _delay,
-				const sample_rate_t _sample_rate )
+				const uint8_t _delay )
 {
-	try
+	if( m_voice )
 	{
-		Stk::setSampleRate( _sample_rate );
-		Stk::setRawwavePath( configManager::inst()->stkDir()
-						.toAscii().constData() );
-	
-		m_voice = new TubeBell();
-	
-		m_voice->controlChange( 1, _control1 );
-		m_voice->controlChange( 2, _control2 );
-		m_voice->controlChange( 4, _control4 );
-		m_voice->controlChange( 11, _control11 );
-		m_voice->controlChange( 128, _control128 );
-	
-		m_voice->noteOn( _pitch, _velocity );
-	}
-	catch( ... )
-	{
-		m_voice = NULL;
-	}
-	
-	m_delay = new StkFloat[256];
-	m_delayRead = 0;
-	m_delayWrite = _delay;
-	for( int i = 0; i < 256; i++ )
-	{
-		m_delay[i] = 0.0;
+		try
+		{
+			// forget about the note this voice played before
+			static_cast<malletsTubeBell *>( m_voice )->clear();
+
+			m_voice->controlChange( 1, _control1 );
+			m_voice->controlChange( 2, _control2 );
+			m_voice->controlChange( 4, _control4 );
+			m_voice->controlChange( 11, _control11 );
+			m_voice->controlChange( 128, _control128 );
+
+			m_voice->noteOn( _pitch, _velocity );
+		}
+		catch( ... )
+		{
+		}
 	}
+
+	resetDelay( _delay );
 }
 
 
 
 
 // BandedWG
-malletsSynth::malletsSynth( const StkFloat _pitch,
+void malletsSynth::startBandedWG( const StkFloat _pitch,
 				const StkFloat _velocity,
 				const StkFloat _control2,
 				const StkFloat _control4,
@@ -618,33 +818,38 @@ malletsSynth::malletsSynth( const StkFloat _pitch,
 				const int _control16,
 				const StkFloat _control64,
 				const StkFloat _control128,
-				const uint8_t _delay,
-				const sample_rate_t _sample_rate )
+				const uint8_t _delay )
 {
-	try
-	{
-		Stk::setSampleRate( _sample_rate );
-		Stk::setRawwavePath( configManager::inst()->stkDir()
-						.toAscii().constData() );
-
-		m_voice = new BandedWG();
-	
-		m_voice->controlChange( 1, 128.0 );
-		m_voice->controlChange( 2, _control2 );
-		m_voice->controlChange( 4, _control4 );
-		m_voice->controlChange( 11, _control11 );
-		m_voice->controlChange( 16, _control16 );
-		m_voice->controlChange( 64, _control64 );
-		m_voice->controlChange( 128, _control128 );
-	
-		m_voice->noteOn( _pitch, _velocity );
-	}
-	catch( ... )
+	if( m_voice )
 	{
-		m_voice = NULL;
+		try
+		{
+			// forget about the note this voice played before
+			static_cast<BandedWG *>( m_voice )->clear();
+
+			m_voice->controlChange( 1, 128.0 );
+			m_voice->controlChange( 2, _control2 );
+			m_voice->controlChange( 4, _control4 );
+			m_voice->controlChange( 11, _control11 );
+			m_voice->controlChange( 16, _control16 );
+			m_voice->controlChange( 64, _control64 );
+			m_voice->controlChange( 128, _control128 );
+
+			m_voice->noteOn( _pitch, _velocity );
+		}
+		catch( ... )
+		{
+		}
 	}
-	
-	m_delay = new StkFloat[256];
+
+	resetDelay( _delay );
+}
+
+
+
+
+void malletsSynth::resetDelay( const uint8_t _delay )
+{
 	m_delayRead = 0;
 	m_delayWrite = _delay;
 	for( int i = 0; i < 256; i++ )
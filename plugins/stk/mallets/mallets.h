@@ -27,6 +27,8 @@
 #ifndef _MALLET_H
 #define _MALLET_H
 
+#include <QtCore/QMutex>
+
 #include "Instrmnt.h"
 
 #include "combobox.h"
@@ -35,6 +37,7 @@
 #include "knob.h"
 #include "NotePlayHandle.h"
 #include "led_checkbox.h"
+#include "atomic_int.h"
 
 // As of Stk 4.4 all classes and types have been moved to the namespace "stk".
 // However in older versions this namespace does not exist, therefore declare it
@@ -46,49 +49,96 @@ using namespace stk;
 class malletsSynth
 {
 public:
-	// ModalBar
-	malletsSynth( const StkFloat _pitch,
-			const StkFloat _velocity,
-			const StkFloat _control1,
-			const StkFloat _control2,
-			const StkFloat _control4,
-			const StkFloat _control8,
-			const StkFloat _control11,
-			const int _control16,
-			const uint8_t _delay,
-			const sample_rate_t _sample_rate );
-
-	// TubeBell
-	malletsSynth( const StkFloat _pitch,
-			const StkFloat _velocity,
-			const int _preset,
-			const StkFloat _control1,
-			const StkFloat _control2,
-			const StkFloat _control4,
-			const StkFloat _control11,
-			const StkFloat _control128,
-			const uint8_t _delay,
-			const sample_rate_t _sample_rate );
+	enum Models
+	{
+		ModalBarModel,
+		TubeBellModel,
+		BandedWGModel
+	} ;
 
-	// BandedWG
-	malletsSynth( const StkFloat _pitch,
-			const StkFloat _velocity,
-			const StkFloat _control2,
-			const StkFloat _control4,
-			const StkFloat _control11,
-			const int _control16,
-			const StkFloat _control64,
-			const StkFloat _control128,
-			const uint8_t _delay,
-			const sample_rate_t _sample_rate );
+	// creates the STK voice for given model - STK's global state has
+	// to be set up before (see malletsInstrument::initStk())
+	malletsSynth( const Models _model );
 
 	inline ~malletsSynth()
 	{
-		m_voice->noteOff( 0.0 );
+		if( m_voice )
+		{
+			m_voice->noteOff( 0.0 );
+		}
 		delete[] m_delay;
 		delete m_voice;
 	}
 
+	static inline Models modelForPreset( const int _preset )
+	{
+		return _preset < 9 ? ModalBarModel :
+			( _preset == 9 ? TubeBellModel : BandedWGModel );
+	}
+
+	inline Models model() const
+	{
+		return m_model;
+	}
+
+	// slot of this voice in the instrument's voice pool or -1 if the
+	// voice has to be deleted after use
+	inline int poolSlot() const
+	{
+		return m_poolSlot;
+	}
+
+	inline void setPoolSlot( const int _slot )
+	{
+		m_poolSlot = _slot;
+	}
+
+	// STK's sample rate at the time this voice was created
+	inline sample_rate_t sampleRate() const
+	{
+		return m_sampleRate;
+	}
+
+	// ModalBar
+	void startModalBar( const StkFloat _pitch,
+				const StkFloat _velocity,
+				const StkFloat _control1,
+				const StkFloat _control2,
+				const StkFloat _control4,
+				const StkFloat _control8,
+				const StkFloat _control11,
+				const int _control16,
+				const uint8_t _delay );
+
+	// TubeBell
+	void startTubeBell( const StkFloat _pitch,
+				const StkFloat _velocity,
+				const StkFloat _control1,
+				const StkFloat _control2,
+				const StkFloat _control4,
+				const StkFloat _control11,
+				const StkFloat _control128,
+				const uint8_t _delay );
+
+	// BandedWG
+	void startBandedWG( const StkFloat _pitch,
+				const StkFloat _velocity,
+				const StkFloat _control2,
+				const StkFloat _control4,
+				const StkFloat _control11,
+				const int _control16,
+				const StkFloat _control64,
+				const StkFloat _control128,
+				const uint8_t _delay );
+
+	inline void stop()
+	{
+		if( m_voice )
+		{
+			m_voice->noteOff( 0.0 );
+		}
+	}
+
 	inline sample_t nextSampleLeft()
 	{
 		if( m_voice == NULL )
@@ -121,6 +171,12 @@ public:
 
 
 protected:
+	void resetDelay( const uint8_t _delay );
+
+	Models m_model;
+	int m_poolSlot;
+	sample_rate_t m_sampleRate;
+
 	Instrmnt * m_voice;
 
 	StkFloat * m_delay;
@@ -133,6 +189,7 @@ protected:
 
 class malletsInstrument : public Instrument
 {
+	Q_OBJECT
 public:
 	malletsInstrument( InstrumentTrack * _instrument_track );
 	virtual ~malletsInstrument();
@@ -150,7 +207,33 @@ public:
 	virtual PluginView * instantiateView( QWidget * _parent );
 
 
+private slots:
+	// (re)creates the preallocated voices for the current preset
+	void updateVoices();
+	void updateSampleRate();
+
+
 private:
+	// sets up STK's global state - STK is not thread-safe, so this and
+	// all creations of STK objects have to happen with s_stkMutex locked
+	static void initStk();
+
+	malletsSynth * acquireVoice( const int _preset );
+	void releaseVoice( malletsSynth * _voice );
+	void deleteVoices();
+
+	static QMutex s_stkMutex;
+
+	enum
+	{
+		NumVoices = 16
+	} ;
+
+	// preallocated voices so starting a note neither has to lock STK
+	// nor to load its rawwave files
+	malletsSynth * m_voices[NumVoices];
+	AtomicInt m_voiceUsed[NumVoices];
+
 	FloatModel m_hardnessModel;
 	FloatModel m_positionModel;
 	FloatModel m_vibratoGainModel;
@@ -81,6 +81,11 @@ vestigeInstrument::vestigeInstrument( InstrumentTrack * _instrument_track ) :
 	knobFModel( NULL ),
 	p_subWindow( NULL )
 {
+	for( int i = 0; i < 128; ++i )
+	{
+		m_notesRunning[i] = 0;
+	}
+
 	// now we need a play-handle which cares for calling play()
 	InstrumentPlayHandle * iph = new InstrumentPlayHandle( this );
 	engine::mixer()->addPlayHandle( iph );
@@ -317,6 +322,21 @@ bool vestigeInstrument::handleMidiEvent( const MidiEvent& event, const MidiTime&
 	{
 		m_plugin->processMidiEvent( event, time );
 	}
+
+	const int key = event.key();
+	if( key >= 0 && key < 128 )
+	{
+		if( event.type() == MidiNoteOn && event.velocity() > 0 )
+		{
+			++m_notesRunning[key];
+		}
+		else if( ( event.type() == MidiNoteOff ||
+					event.type() == MidiNoteOn ) &&
+						m_notesRunning[key] > 0 )
+		{
+			--m_notesRunning[key];
+		}
+	}
 	m_pluginMutex.unlock();
 
 	return true;
@@ -324,6 +344,23 @@ bool vestigeInstrument::handleMidiEvent( const MidiEvent& event, const MidiTime&
 
 
 
+bool vestigeInstrument::isIdle()
+{
+	// plugins producing sound on their own keep running as InstrumentTrack
+	// only lets instruments with silent output sleep
+	QMutexLocker m( &m_pluginMutex );
+	for( int i = 0; i < 128; ++i )
+	{
+		if( m_notesRunning[i] > 0 )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
 
 void vestigeInstrument::closePlugin( void )
 {
@@ -379,6 +416,11 @@ void vestigeInstrument::closePlugin( void )
 	}
 	delete m_plugin;
 	m_plugin = NULL;
+
+	for( int i = 0; i < 128; ++i )
+	{
+		m_notesRunning[i] = 0;
+	}
 	m_pluginMutex.unlock();
 }
 
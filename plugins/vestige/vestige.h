@@ -70,6 +70,8 @@ public:
 
 	virtual bool handleMidiEvent( const MidiEvent& event, const MidiTime& time );
 
+	virtual bool isIdle();
+
 	virtual PluginView * instantiateView( QWidget * _parent );
 
 protected slots:
@@ -90,6 +92,9 @@ private:
 	QObject * p_subWindow;
 	int paramCount;
 
+	// number of note-ons without note-off per key
+	int m_notesRunning[128];
+
 
 	friend class VestigeInstrumentView;
 	friend class manageVestigeInstrumentView;
@@ -81,19 +81,29 @@ bool waveShaperEffect::processAudioBuffer( sampleFrame * _buf,
 	float frac;
 	float posneg;
 
-	double out_sum = 0.0;
 	const float d = dryLevel();
 	const float w = wetLevel();
-	for( fpp_t f = 0; f < _frames; ++f )
+	const float input = m_wsControls.m_inputModel.value();
+	const float output = m_wsControls.m_outputModel.value();
+	const bool clip = m_wsControls.m_clipModel.value();
+	const float * samples = m_wsControls.m_wavegraphModel.samples();
+
+	// shaping creates harmonics which would alias back otherwise, so do
+	// everything (including wet/dry mix to keep both signals aligned) at
+	// oversampled rate
+	sampleFrame * buf = upsample( _buf, _frames );
+	const f_cnt_t frames = _frames * oversamplingFactor();
+
+	for( f_cnt_t f = 0; f < frames; ++f )
 	{
-		sample_t s[2] = { _buf[f][0], _buf[f][1] };
+		sample_t s[2] = { buf[f][0], buf[f][1] };
 
 // apply input gain
-		s[0] *= m_wsControls.m_inputModel.value();
-		s[1] *= m_wsControls.m_inputModel.value();
+		s[0] *= input;
+		s[1] *= input;
 
 // clip if clip enabled
-		if( m_wsControls.m_clipModel.value() )
+		if( clip )
 		{
 			s[0] = qBound( -1.0f, s[0], 1.0f );
 			s[1] = qBound( -1.0f, s[1], 1.0f );
@@ -109,35 +119,35 @@ bool waveShaperEffect::processAudioBuffer( sampleFrame * _buf,
 			if ( lookup < 1 )
 			{
 				frac = lookup - truncf(lookup);
-				s[i] = frac * m_wsControls.m_wavegraphModel.samples()[0] * posneg;
+				s[i] = frac * samples[0] * posneg;
 			}
 			else
 			if ( lookup < 200 )
 			{
 				frac = lookup - truncf(lookup);
 				s[i] =
-						(( (1.0f-frac) * m_wsControls.m_wavegraphModel.samples()[ (int)truncf(lookup) - 1 ] ) +
-						( frac * m_wsControls.m_wavegraphModel.samples()[ (int)truncf(lookup) ] ))
+						(( (1.0f-frac) * samples[ (int)truncf(lookup) - 1 ] ) +
+						( frac * samples[ (int)truncf(lookup) ] ))
 						* posneg;
 			}
 			else
 			{
-				s[i] *= m_wsControls.m_wavegraphModel.samples()[199];
+				s[i] *= samples[199];
 			}
 		}
 
 // apply output gain
-		s[0] *= m_wsControls.m_outputModel.value();
-		s[1] *= m_wsControls.m_outputModel.value();
+		s[0] *= output;
+		s[1] *= output;
 
 // mix wet/dry signals
-		_buf[f][0] = d * _buf[f][0] + w * s[0];
-		_buf[f][1] = d * _buf[f][1] + w * s[1];
-
-		out_sum += _buf[f][0]*_buf[f][0] + _buf[f][1]*_buf[f][1];
+		buf[f][0] = d * buf[f][0] + w * s[0];
+		buf[f][1] = d * buf[f][1] + w * s[1];
 	}
 
-	checkGate( out_sum / _frames );
+	downsample( buf, _buf, _frames );
+
+	checkGate( _buf, _frames );
 
 	return( isRunning() );
 }
@@ -31,12 +31,21 @@
 #include "src/Input/NULLMidiIn.h"
 #include "src/Misc/Master.h"
 #include "src/Misc/Dump.h"
+#include "src/Params/PADnoteParameters.h"
 
 
 int LocalZynAddSubFx::s_instanceCount = 0;
 
 
-LocalZynAddSubFx::LocalZynAddSubFx()
+struct PartJob
+{
+	Master * master;
+	const int * parts;
+} ;
+
+
+LocalZynAddSubFx::LocalZynAddSubFx() :
+	m_parallelRunner( NULL )
 {
 	for( int i = 0; i < NumKeys; ++i )
 	{
@@ -190,6 +199,22 @@ void LocalZynAddSubFx::setLmmsWorkingDir( const std::string & _dir )
 
 
 
+
+void LocalZynAddSubFx::setPADsynthCacheDir( const std::string & _dir )
+{
+	PADnoteParameters::setcachedir( _dir );
+}
+
+
+
+
+void LocalZynAddSubFx::waitForPADsynth()
+{
+	m_master->waitforgenerators();
+}
+
+
+
 void LocalZynAddSubFx::setPitchWheelBendRange( int semitones )
 {
 	for( int i = 0; i < NUM_MIDI_PARTS; ++i )
@@ -246,6 +271,36 @@ void LocalZynAddSubFx::processMidiEvent( const MidiEvent& event )
 
 
 
+void LocalZynAddSubFx::setParallelRunner( ParallelRunner _runner )
+{
+	m_parallelRunner = _runner;
+	m_master->partexecutor = _runner ? computeParts : NULL;
+	m_master->partexecutorarg = this;
+}
+
+
+
+
+void LocalZynAddSubFx::computeParts( void * _arg, Master * _master,
+					const int * _parts, int _count )
+{
+	PartJob job = { _master, _parts };
+	static_cast<LocalZynAddSubFx *>( _arg )->
+				m_parallelRunner( computePart, &job, _count );
+}
+
+
+
+
+void LocalZynAddSubFx::computePart( void * _arg, int _index )
+{
+	PartJob * job = static_cast<PartJob *>( _arg );
+	job->master->ComputePartOut( job->parts[_index] );
+}
+
+
+
+
 void LocalZynAddSubFx::processAudio( sampleFrame * _out )
 {
 	REALTYPE outputl[SOUND_BUFFER_SIZE];
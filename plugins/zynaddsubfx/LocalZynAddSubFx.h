@@ -48,6 +48,11 @@ public:
 
 	void setPresetDir( const std::string & _dir );
 	void setLmmsWorkingDir( const std::string & _dir );
+	void setPADsynthCacheDir( const std::string & _dir );
+
+	// PADsynth samples are computed in background after loading - blocks
+	// until they're ready, so rendering offline doesn't miss them
+	void waitForPADsynth();
 
 	void setPitchWheelBendRange( int semitones );
 
@@ -55,6 +60,15 @@ public:
 
 	void processAudio( sampleFrame * _out );
 
+	// runs _count calls of _func( _arg, i ), possibly in parallel, and
+	// returns when all of them have finished
+	typedef void (* ParallelRunner)( void (* _func)( void *, int ),
+						void * _arg, int _count );
+
+	// lets parts of a multi-timbral instance be rendered in parallel,
+	// pass NULL to render them serially again
+	void setParallelRunner( ParallelRunner _runner );
+
 	inline Master * master()
 	{
 		return m_master;
@@ -64,6 +78,12 @@ public:
 protected:
 	static int s_instanceCount;
 
+	static void computeParts( void * _arg, Master * _master,
+					const int * _parts, int _count );
+	static void computePart( void * _arg, int _index );
+
+	ParallelRunner m_parallelRunner;
+
 	std::string m_presetsDir;
 
 	int m_runningNotes[NumKeys];
@@ -123,6 +123,14 @@ public:
 				LocalZynAddSubFx::setPitchWheelBendRange( _m.getInt() );
 				break;
 
+			case IdZasfPADsynthCacheDirectory:
+				LocalZynAddSubFx::setPADsynthCacheDir( _m.getString() );
+				break;
+
+			case IdZasfWaitForPADsynth:
+				LocalZynAddSubFx::waitForPADsynth();
+				break;
+
 			default:
 				return RemotePluginClient::processMessage( _m );
 		}
@@ -31,7 +31,9 @@ enum ZasfRemoteMessageIDs
 {
 	IdZasfPresetDirectory = IdUserBase,
 	IdZasfLmmsWorkingDirectory,
-	IdZasfSetPitchWheelBendRange
+	IdZasfSetPitchWheelBendRange,
+	IdZasfPADsynthCacheDirectory,
+	IdZasfWaitForPADsynth
 } ;
 
 #endif
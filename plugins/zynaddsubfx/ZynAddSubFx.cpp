@@ -37,6 +37,7 @@
 #include "DataFile.h"
 #include "InstrumentPlayHandle.h"
 #include "InstrumentTrack.h"
+#include "song.h"
 #include "gui_templates.h"
 #include "string_pair_drag.h"
 #include "RemoteZynAddSubFx.h"
@@ -106,6 +107,7 @@ ZynAddSubFxInstrument::ZynAddSubFxInstrument(
 									InstrumentTrack * _instrumentTrack ) :
 	Instrument( _instrumentTrack, &zynaddsubfx_plugin_descriptor ),
 	m_hasGUI( false ),
+	m_exporting( false ),
 	m_plugin( NULL ),
 	m_remotePlugin( NULL ),
 	m_portamentoModel( 0, 0, 127, 1, this, tr( "Portamento" ) ),
@@ -150,6 +152,7 @@ ZynAddSubFxInstrument::~ZynAddSubFxInstrument()
 	delete m_remotePlugin;
 	m_plugin = NULL;
 	m_remotePlugin = NULL;
+	m_exporting = false;
 	m_pluginMutex.unlock();
 }
 
@@ -323,6 +326,26 @@ QString ZynAddSubFxInstrument::nodeName() const
 void ZynAddSubFxInstrument::play( sampleFrame * _buf )
 {
 	m_pluginMutex.lock();
+	// PADsynth samples are computed in background (e.g. after loading a
+	// project) - rather than rendering silence for them when exporting,
+	// wait until they're ready
+	const bool exporting = engine::getSong()->isExporting();
+	if( exporting && !m_exporting )
+	{
+		if( m_remotePlugin )
+		{
+			m_remotePlugin->lock();
+			m_remotePlugin->sendMessage(
+				RemotePlugin::message( IdZasfWaitForPADsynth ) );
+			m_remotePlugin->unlock();
+		}
+		else
+		{
+			m_plugin->waitForPADsynth();
+		}
+	}
+	m_exporting = exporting;
+
 	if( m_remotePlugin )
 	{
 		m_remotePlugin->process( NULL, _buf );
@@ -358,6 +381,21 @@ bool ZynAddSubFxInstrument::handleMidiEvent( const MidiEvent& event, const MidiT
 	{
 		m_plugin->processMidiEvent( event );
 	}
+
+	const int key = event.key();
+	if( key >= 0 && key < 128 )
+	{
+		if( event.type() == MidiNoteOn && event.velocity() > 0 )
+		{
+			++m_notesRunning[key];
+		}
+		else if( ( event.type() == MidiNoteOff ||
+					event.type() == MidiNoteOn ) &&
+						m_notesRunning[key] > 0 )
+		{
+			--m_notesRunning[key];
+		}
+	}
 	m_pluginMutex.unlock();
 
 	return true;
@@ -365,6 +403,23 @@ bool ZynAddSubFxInstrument::handleMidiEvent( const MidiEvent& event, const MidiT
 
 
 
+bool ZynAddSubFxInstrument::isIdle()
+{
+	// notes in release phase and effect tails are covered by
+	// InstrumentTrack checking for silent output
+	QMutexLocker m( &m_pluginMutex );
+	for( int i = 0; i < 128; ++i )
+	{
+		if( m_notesRunning[i] > 0 )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
 
 void ZynAddSubFxInstrument::reloadPlugin()
 {
@@ -416,6 +471,27 @@ GEN_CC_SLOT(updateResBandwidth,C_resonance_bandwidth,m_resBandwidthModel);
 
 
 
+// computed PADsynth samples are stored here so they don't have to be
+// regenerated each time a project is loaded
+static QString padSynthCacheDir()
+{
+	const QString dir = configManager::inst()->cacheDir() + "zynaddsubfx/";
+	QDir().mkpath( dir );
+	return dir;
+}
+
+
+
+
+static void runOnMixerWorkers( void (* _func)( void *, int ), void * _arg,
+								int _count )
+{
+	engine::mixer()->runParallel( _func, _arg, _count );
+}
+
+
+
+
 void ZynAddSubFxInstrument::initPlugin()
 {
 	m_pluginMutex.lock();
@@ -424,6 +500,11 @@ void ZynAddSubFxInstrument::initPlugin()
 	m_plugin = NULL;
 	m_remotePlugin = NULL;
 
+	for( int i = 0; i < 128; ++i )
+	{
+		m_notesRunning[i] = 0;
+	}
+
 	if( m_hasGUI )
 	{
 		m_remotePlugin = new ZynAddSubFxRemotePlugin();
@@ -441,6 +522,9 @@ void ZynAddSubFxInstrument::initPlugin()
 					QSTR_TO_STDSTR(
 						QString( configManager::inst()->factoryPresetsDir() +
 								QDir::separator() + "ZynAddSubFX" ) ) ) );
+		m_remotePlugin->sendMessage(
+			RemotePlugin::message( IdZasfPADsynthCacheDirectory ).
+				addString( QSTR_TO_STDSTR( padSynthCacheDir() ) ) );
 
 		m_remotePlugin->updateSampleRate( engine::mixer()->processingSampleRate() );
 
@@ -456,6 +540,8 @@ void ZynAddSubFxInstrument::initPlugin()
 		m_plugin = new LocalZynAddSubFx;
 		m_plugin->setSampleRate( engine::mixer()->processingSampleRate() );
 		m_plugin->setBufferSize( engine::mixer()->framesPerPeriod() );
+		m_plugin->setParallelRunner( runOnMixerWorkers );
+		m_plugin->setPADsynthCacheDir( QSTR_TO_STDSTR( padSynthCacheDir() ) );
 	}
 
 	m_pluginMutex.unlock();
@@ -85,6 +85,8 @@ public:
 		return IsSingleStreamed | IsMidiBased;
 	}
 
+	virtual bool isIdle();
+
 	virtual PluginView * instantiateView( QWidget * _parent );
 
 
@@ -107,6 +109,8 @@ private:
 	void sendControlChange( MidiControllers midiCtl, float value );
 
 	bool m_hasGUI;
+	// whether we already waited for PADsynth samples in current export
+	bool m_exporting;
 	QMutex m_pluginMutex;
 	LocalZynAddSubFx * m_plugin;
 	ZynAddSubFxRemotePlugin * m_remotePlugin;
@@ -122,6 +126,10 @@ private:
 
 	QMap<int, bool> m_modifiedControllers;
 
+	// number of note-ons without note-off per key - ZynAddSubFX keeps
+	// running in a separate process, so we track them on our own
+	int m_notesRunning[128];
+
 	friend class ZynAddSubFxView;
 
 
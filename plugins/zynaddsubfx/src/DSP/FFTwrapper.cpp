@@ -21,10 +21,16 @@
 */
 
 #include <math.h>
+#include <pthread.h>
 #include "FFTwrapper.h"
 
+//the FFTW planner isn't thread safe and FFTwrappers are created by
+//background threads as well (see PADnoteParameters)
+static pthread_mutex_t planmutex = PTHREAD_MUTEX_INITIALIZER;
+
 FFTwrapper::FFTwrapper(int fftsize_)
 {
+    pthread_mutex_lock(&planmutex);
     fftsize      = fftsize_;
     tmpfftdata1  = new fftw_real[fftsize];
     tmpfftdata2  = new fftw_real[fftsize];
@@ -47,10 +53,12 @@ FFTwrapper::FFTwrapper(int fftsize_)
                                     FFTW_HC2R,
                                     FFTW_ESTIMATE);
 #endif
+    pthread_mutex_unlock(&planmutex);
 }
 
 FFTwrapper::~FFTwrapper()
 {
+    pthread_mutex_lock(&planmutex);
 #ifdef FFTW_VERSION_2
     rfftw_destroy_plan(planfftw);
     rfftw_destroy_plan(planfftw_inv);
@@ -58,6 +66,7 @@ FFTwrapper::~FFTwrapper()
     fftwf_destroy_plan(planfftw);
     fftwf_destroy_plan(planfftw_inv);
 #endif
+    pthread_mutex_unlock(&planmutex);
 
     delete [] tmpfftdata1;
     delete [] tmpfftdata2;
@@ -33,7 +33,8 @@
 #include "XMLwrapper.h"
 
 Config::Config() :
-	workingDir( NULL )
+	workingDir( NULL ),
+	PADsynthCacheDir( NULL )
 {}
 void Config::init()
 {
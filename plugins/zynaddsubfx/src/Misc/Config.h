@@ -53,6 +53,7 @@ class Config
         int maxstringsize;
 
 		char * workingDir;
+		char * PADsynthCacheDir; //where computed PADsynth samples are stored
 
         struct winmidionedevice {
             char *name;
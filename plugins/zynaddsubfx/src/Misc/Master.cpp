@@ -32,9 +32,10 @@
 Master::Master()
 {
     swaplr = 0;
+    partexecutor    = NULL;
+    partexecutorarg = NULL;
 
     pthread_mutex_init(&mutex, NULL);
-    fft = new FFTwrapper(OSCIL_SIZE);
 
     tmpmixl   = new REALTYPE[SOUND_BUFFER_SIZE];
     tmpmixr   = new REALTYPE[SOUND_BUFFER_SIZE];
@@ -56,8 +57,11 @@ Master::Master()
         audiooutr[i] = 0.0;
     }
 
-    for(int npart = 0; npart < NUM_MIDI_PARTS; npart++)
-        part[npart] = new Part(&microtonal, fft, &mutex);
+    for(int npart = 0; npart < NUM_MIDI_PARTS; npart++) {
+        fft[npart]  = new FFTwrapper(OSCIL_SIZE);
+        part[npart] = new Part(&microtonal, fft[npart], &mutex);
+        part[npart]->prngstate = npart + 1;
+    }
 
 
 
@@ -244,6 +248,61 @@ void Master::partonoff(int npart, int what)
 /*
  * Master audio out (the final sound)
  */
+void Master::ComputePartOut(int npart)
+{
+    int i;
+
+    //use the random sequence of the part, whatever thread renders it
+    const unsigned int threadprngstate = prng_state;
+    prng_state = part[npart]->prngstate;
+
+    part[npart]->ComputePartSmps();
+
+    //Insertion effects (in order of the effects, as they may be chained)
+    for(int nefx = 0; nefx < NUM_INS_EFX; nefx++)
+        if(Pinsparts[nefx] == npart)
+            insefx[nefx]->out(part[npart]->partoutl,
+                              part[npart]->partoutr);
+
+    //Apply the part volume and panning (after insertion effects)
+    REALTYPE newvol_l = part[npart]->volume;
+    REALTYPE newvol_r = part[npart]->volume;
+    REALTYPE oldvol_l = part[npart]->oldvolumel;
+    REALTYPE oldvol_r = part[npart]->oldvolumer;
+    REALTYPE pan      = part[npart]->panning;
+    if(pan < 0.5)
+        newvol_l *= pan * 2.0;
+    else
+        newvol_r *= (1.0 - pan) * 2.0;
+
+    if(ABOVE_AMPLITUDE_THRESHOLD(oldvol_l, newvol_l)
+       || ABOVE_AMPLITUDE_THRESHOLD(oldvol_r, newvol_r)) { //the volume or the panning has changed and needs interpolation
+        for(i = 0; i < SOUND_BUFFER_SIZE; i++) {
+            REALTYPE vol_l = INTERPOLATE_AMPLITUDE(oldvol_l,
+                                                   newvol_l,
+                                                   i,
+                                                   SOUND_BUFFER_SIZE);
+            REALTYPE vol_r = INTERPOLATE_AMPLITUDE(oldvol_r,
+                                                   newvol_r,
+                                                   i,
+                                                   SOUND_BUFFER_SIZE);
+            part[npart]->partoutl[i] *= vol_l;
+            part[npart]->partoutr[i] *= vol_r;
+        }
+        part[npart]->oldvolumel = newvol_l;
+        part[npart]->oldvolumer = newvol_r;
+    }
+    else {
+        for(i = 0; i < SOUND_BUFFER_SIZE; i++) { //the volume did not changed
+            part[npart]->partoutl[i] *= newvol_l;
+            part[npart]->partoutr[i] *= newvol_r;
+        }
+    }
+
+    part[npart]->prngstate = prng_state;
+    prng_state = threadprngstate;
+}
+
 void Master::AudioOut(REALTYPE *outl, REALTYPE *outr)
 {
     int i, npart, nefx;
@@ -283,61 +342,19 @@ void Master::AudioOut(REALTYPE *outl, REALTYPE *outr)
         outr[i] = 0.0;
     }
 
-    //Compute part samples and store them part[npart]->partoutl,partoutr
+    //Compute part samples and store them part[npart]->partoutl,partoutr,
+    //apply insertion effects and part volumes and pannings
+    int enabledparts[NUM_MIDI_PARTS];
+    int nenabled = 0;
     for(npart = 0; npart < NUM_MIDI_PARTS; npart++)
         if(part[npart]->Penabled != 0)
-            part[npart]->ComputePartSmps();
-
-    //Insertion effects
-    for(nefx = 0; nefx < NUM_INS_EFX; nefx++) {
-        if(Pinsparts[nefx] >= 0) {
-            int efxpart = Pinsparts[nefx];
-            if(part[efxpart]->Penabled != 0)
-                insefx[nefx]->out(part[efxpart]->partoutl,
-                                  part[efxpart]->partoutr);
-        }
-    }
-
-
-    //Apply the part volumes and pannings (after insertion effects)
-    for(npart = 0; npart < NUM_MIDI_PARTS; npart++) {
-        if(part[npart]->Penabled == 0)
-            continue;
+            enabledparts[nenabled++] = npart;
 
-        REALTYPE newvol_l = part[npart]->volume;
-        REALTYPE newvol_r = part[npart]->volume;
-        REALTYPE oldvol_l = part[npart]->oldvolumel;
-        REALTYPE oldvol_r = part[npart]->oldvolumer;
-        REALTYPE pan      = part[npart]->panning;
-        if(pan < 0.5)
-            newvol_l *= pan * 2.0;
-        else
-            newvol_r *= (1.0 - pan) * 2.0;
-
-        if(ABOVE_AMPLITUDE_THRESHOLD(oldvol_l, newvol_l)
-           || ABOVE_AMPLITUDE_THRESHOLD(oldvol_r, newvol_r)) { //the volume or the panning has changed and needs interpolation
-            for(i = 0; i < SOUND_BUFFER_SIZE; i++) {
-                REALTYPE vol_l = INTERPOLATE_AMPLITUDE(oldvol_l,
-                                                       newvol_l,
-                                                       i,
-                                                       SOUND_BUFFER_SIZE);
-                REALTYPE vol_r = INTERPOLATE_AMPLITUDE(oldvol_r,
-                                                       newvol_r,
-                                                       i,
-                                                       SOUND_BUFFER_SIZE);
-                part[npart]->partoutl[i] *= vol_l;
-                part[npart]->partoutr[i] *= vol_r;
-            }
-            part[npart]->oldvolumel = newvol_l;
-            part[npart]->oldvolumer = newvol_r;
-        }
-        else {
-            for(i = 0; i < SOUND_BUFFER_SIZE; i++) { //the volume did not changed
-                part[npart]->partoutl[i] *= newvol_l;
-                part[npart]->partoutr[i] *= newvol_r;
-            }
-        }
-    }
+    if((partexecutor != NULL) && (nenabled > 1))
+        partexecutor(partexecutorarg, this, enabledparts, nenabled);
+    else
+        for(int n = 0; n < nenabled; n++)
+            ComputePartOut(enabledparts[n]);
 
 
     //System effects
@@ -557,7 +574,8 @@ Master::~Master()
     delete [] audiooutr;
     delete [] tmpmixl;
     delete [] tmpmixr;
-    delete (fft);
+    for(int npart = 0; npart < NUM_MIDI_PARTS; npart++)
+        delete fft[npart];
 
     pthread_mutex_destroy(&mutex);
 }
@@ -631,6 +649,12 @@ void Master::applyparameters()
     ;
 }
 
+void Master::waitforgenerators()
+{
+    for(int npart = 0; npart < NUM_MIDI_PARTS; npart++)
+        part[npart]->waitforgenerators();
+}
+
 void Master::add2XML(XMLwrapper *xml)
 {
     xml->addpar("volume", Pvolume);
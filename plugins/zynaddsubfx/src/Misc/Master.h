@@ -60,6 +60,8 @@ class Master
          * @return 0 for ok or -1 if there is an error*/
         int loadXML(const char *filename);
         void applyparameters();
+        /**waits until PADsynth samples computed in background are ready*/
+        void waitforgenerators();
 
         void getfromXML(XMLwrapper *xml);
 
@@ -85,6 +87,21 @@ class Master
 
         /**Audio Output*/
         void AudioOut(REALTYPE *outl, REALTYPE *outr);
+
+        /**Computes the samples of an enabled part and applies its
+         * insertion effects and volume/panning. Every part has its own
+         * FFTwrapper and random generator state, so it may run for
+         * different parts in parallel. Anything else the parts share
+         * (microtonal, controllers, parameters) is only read here.*/
+        void ComputePartOut(int npart);
+
+        /**Host hook for rendering parts in parallel. If set, AudioOut()
+         * calls it with the list of enabled parts instead of computing
+         * them one after another. It has to call ComputePartOut() for
+         * each of them and may only return when all are finished.*/
+        void (*partexecutor)(void *arg, Master *master,
+                             const int *parts, int nparts);
+        void *partexecutorarg;
         /**Audio Output (for callback mode). This allows the program to be controled by an external program*/
         void GetAudioOutSamples(int nsamples,
                                 int samplerate,
@@ -140,7 +157,7 @@ class Master
         Microtonal microtonal;
         Bank bank;
 
-        FFTwrapper     *fft;
+        FFTwrapper     *fft[NUM_MIDI_PARTS]; //one per part, the FFTwrapper has scratch buffers
         pthread_mutex_t mutex;
 
     private:
@@ -81,6 +81,7 @@ Part::Part(Microtonal *microtonal_, FFTwrapper *fft_, pthread_mutex_t *mutex_)
 
     oldvolumel = oldvolumer = 0.5;
     lastnote   = -1;
+    prngstate  = 1;
     lastpos    = 0; // lastpos will store previously used NoteOn(...)'s pos.
     lastlegatomodevalid = false; // To store previous legatomodevalid value.
 
@@ -1246,10 +1247,17 @@ void Part::applyparameters()
 {
     for(int n = 0; n < NUM_KIT_ITEMS; n++)
         if((kit[n].padpars != NULL) && (kit[n].Ppadenabled != 0))
-            kit[n].padpars->applyparameters(true);
+            kit[n].padpars->applyparametersinbackground();
     ;
 }
 
+void Part::waitforgenerators()
+{
+    for(int n = 0; n < NUM_KIT_ITEMS; n++)
+        if(kit[n].padpars != NULL)
+            kit[n].padpars->waitforgenerator();
+}
+
 void Part::getfromXMLinstrument(XMLwrapper *xml)
 {
     if(xml->enterbranch("INFO")) {
@@ -80,6 +80,7 @@ class Part
         void defaultsinstrument();
 
         void applyparameters();
+        void waitforgenerators();
 
         void getfromXML(XMLwrapper *xml);
         void getfromXMLinstrument(XMLwrapper *xml);
@@ -156,6 +157,10 @@ class Part
 
         int lastnote;
 
+        /**state of the random generator while the part is computed,
+         * it is set up by Master*/
+        unsigned int prngstate;
+
     private:
         void KillNotePos(int pos);
         void RelaseNotePos(int pos);
@@ -37,6 +37,7 @@ int OSCIL_SIZE  = 1024;
 
 Config    config;
 REALTYPE *denormalkillbuf;
+__thread unsigned int prng_state = 1;
 
 
 /*
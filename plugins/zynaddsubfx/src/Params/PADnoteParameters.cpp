@@ -20,10 +20,24 @@
 
 */
 #include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <vector>
 #include "PADnoteParameters.h"
 #include "../Output/WAVaudiooutput.h"
 using namespace std;
 
+//the last samples contains the first samples (used for linear/cubic interpolation)
+static const int extra_samples = 5;
+
 PADnoteParameters::PADnoteParameters(FFTwrapper *fft_,
                                      pthread_mutex_t *mutex_):Presets()
 {
@@ -52,12 +66,30 @@ PADnoteParameters::PADnoteParameters(FFTwrapper *fft_,
     for(int i = 0; i < PAD_MAX_SAMPLES; i++)
         sample[i].smp = NULL;
     newsample.smp = NULL;
+    deletesamples();
+
+    pthread_mutex_init(&generatormutex, NULL);
+    generatorrunning  = false;
+    generatorjoinable = false;
+    generatorabort    = false;
+    generatorwaited   = false;
 
     defaults();
 }
 
 PADnoteParameters::~PADnoteParameters()
 {
+    //stop the background generation, if any
+    pthread_mutex_lock(&generatormutex);
+    generatorabort = true;
+    pendingsamplepars.clear();
+    const bool joinable = generatorjoinable;
+    generatorjoinable = false;
+    pthread_mutex_unlock(&generatormutex);
+    if(joinable)
+        pthread_join(generator, NULL);
+    pthread_mutex_destroy(&generatormutex);
+
     deletesamples();
     delete (oscilgen);
     delete (resonance);
@@ -131,7 +163,8 @@ void PADnoteParameters::defaults()
     FilterEnvelope->defaults();
     FilterLfo->defaults();
 
-    deletesamples();
+    //the current samples are kept, so notes can continue to play them
+    //until applyparameters() replaces them by the new ones
 }
 
 void PADnoteParameters::deletesample(int n)
@@ -549,9 +582,10 @@ void PADnoteParameters::generatespectrum_otherModes(REALTYPE *spectrum,
 }
 
 /*
- * Applies the parameters (i.e. computes all the samples, based on parameters);
+ * Computes all the samples, based on parameters
  */
-void PADnoteParameters::applyparameters(bool lockmutex)
+int PADnoteParameters::generatesamples(Sample *smps,
+                                       const volatile bool *abortflag)
 {
     const int samplesize   = (((int) 1) << (Pquality.samplesize + 14));
     int      spectrumsize = samplesize / 2;
@@ -587,7 +621,11 @@ void PADnoteParameters::applyparameters(bool lockmutex)
     REALTYPE adj[samplemax]; //this is used to compute frequency relation to the base frequency
     for(int nsample = 0; nsample < samplemax; nsample++)
         adj[nsample] = (Pquality.oct + 1.0) * (REALTYPE)nsample / samplemax;
-    for(int nsample = 0; nsample < samplemax; nsample++) {
+    int nsample;
+    for(nsample = 0; nsample < samplemax; nsample++) {
+        if((abortflag != NULL) && *abortflag)
+            break;
+
         REALTYPE tmp = adj[nsample] - adj[samplemax - 1] * 0.5;
         REALTYPE basefreqadjust = pow(2.0, tmp);
 
@@ -606,64 +644,390 @@ void PADnoteParameters::applyparameters(bool lockmutex)
                                         profilesize,
                                         bwadjust);
 
-        const int extra_samples = 5; //the last samples contains the first samples (used for linear/cubic interpolation)
-        newsample.smp    = new REALTYPE[samplesize + extra_samples];
+        REALTYPE *smp = new REALTYPE[samplesize + extra_samples];
 
-        newsample.smp[0] = 0.0;
+        smp[0] = 0.0;
         for(int i = 1; i < spectrumsize; i++) { //randomize the phases
             REALTYPE phase = RND * 6.29;
             fftfreqs.c[i] = spectrum[i] * cos(phase);
             fftfreqs.s[i] = spectrum[i] * sin(phase);
         }
-        fft->freqs2smps(fftfreqs, newsample.smp); //that's all; here is the only ifft for the whole sample; no windows are used ;-)
+        fft->freqs2smps(fftfreqs, smp); //that's all; here is the only ifft for the whole sample; no windows are used ;-)
 
 
         //normalize(rms)
         REALTYPE rms = 0.0;
         for(int i = 0; i < samplesize; i++)
-            rms += newsample.smp[i] * newsample.smp[i];
+            rms += smp[i] * smp[i];
         rms  = sqrt(rms);
         if(rms < 0.000001)
             rms = 1.0;
         rms *= sqrt(262144.0 / samplesize);
         for(int i = 0; i < samplesize; i++)
-            newsample.smp[i] *= 1.0 / rms * 50.0;
+            smp[i] *= 1.0 / rms * 50.0;
 
         //prepare extra samples used by the linear or cubic interpolation
         for(int i = 0; i < extra_samples; i++)
-            newsample.smp[i + samplesize] = newsample.smp[i];
-
-        //replace the current sample with the new computed sample
-        if(lockmutex) {
-            pthread_mutex_lock(mutex);
-            deletesample(nsample);
-            sample[nsample].smp      = newsample.smp;
-            sample[nsample].size     = samplesize;
-            sample[nsample].basefreq = basefreq * basefreqadjust;
-            pthread_mutex_unlock(mutex);
-        }
-        else {
-            deletesample(nsample);
-            sample[nsample].smp      = newsample.smp;
-            sample[nsample].size     = samplesize;
-            sample[nsample].basefreq = basefreq * basefreqadjust;
-        }
-        newsample.smp = NULL;
+            smp[i + samplesize] = smp[i];
+
+        smps[nsample].smp      = smp;
+        smps[nsample].size     = samplesize;
+        smps[nsample].basefreq = basefreq * basefreqadjust;
     }
     delete (fft);
     deleteFFTFREQS(&fftfreqs);
 
-    //delete the additional samples that might exists and are not useful
-    if(lockmutex) {
+    if(nsample < samplemax) { //aborted
+        for(int i = 0; i < nsample; i++)
+            delete[] smps[i].smp;
+        return 0;
+    }
+
+    return samplemax;
+}
+
+/*
+ * Replaces the current samples with the new computed samples
+ */
+void PADnoteParameters::replacesamples(Sample *smps, int nsamples,
+                                       bool lockmutex)
+{
+    REALTYPE *oldsmps[PAD_MAX_SAMPLES];
+
+    if(lockmutex)
         pthread_mutex_lock(mutex);
-        for(int i = samplemax; i < PAD_MAX_SAMPLES; i++)
-            deletesample(i);
+    for(int i = 0; i < PAD_MAX_SAMPLES; i++) {
+        oldsmps[i] = sample[i].smp;
+        if(i < nsamples)
+            sample[i] = smps[i];
+        else { //delete the additional samples that might exists and are not useful
+            sample[i].smp      = NULL;
+            sample[i].size     = 0;
+            sample[i].basefreq = 440.0;
+        }
+    }
+    if(lockmutex)
         pthread_mutex_unlock(mutex);
+
+    //free the old samples after the notes can't access them anymore
+    for(int i = 0; i < PAD_MAX_SAMPLES; i++)
+        delete[] oldsmps[i];
+}
+
+bool PADnoteParameters::replacesamplesfromgenerator(Sample *smps, int nsamples)
+{
+    //the mutex might be held by someone waiting for this thread to finish
+    while(pthread_mutex_trylock(mutex) != 0) {
+        if(generatorabort)
+            return false;
+        if(generatorwaited) {
+            //the waiting thread doesn't access the samples meanwhile
+            replacesamples(smps, nsamples, false);
+            return true;
+        }
+        usleep(1000);
+    }
+    replacesamples(smps, nsamples, false);
+    pthread_mutex_unlock(mutex);
+    return true;
+}
+
+/*
+ * Applies the parameters (i.e. computes all the samples, based on parameters);
+ */
+void PADnoteParameters::applyparameters(bool lockmutex)
+{
+    const string samplepars = getsamplepars();
+    Sample smps[PAD_MAX_SAMPLES];
+
+    int nsamples = loadcachedsamples(samplepars, smps);
+    if(nsamples == 0) {
+        nsamples = generatesamples(smps, NULL);
+        savecachedsamples(samplepars, smps, nsamples);
+    }
+
+    replacesamples(smps, nsamples, lockmutex);
+}
+
+void PADnoteParameters::applyparametersinbackground()
+{
+    const string samplepars = getsamplepars();
+
+    //samples which are in the disk cache are available right away
+    Sample smps[PAD_MAX_SAMPLES];
+    int nsamples = loadcachedsamples(samplepars, smps);
+    if(nsamples > 0) {
+        pthread_mutex_lock(&generatormutex);
+        //a generation which is still running is outdated now
+        pendingsamplepars.clear();
+        pthread_mutex_unlock(&generatormutex);
+        replacesamples(smps, nsamples, true);
+        return;
+    }
+
+    pthread_mutex_lock(&generatormutex);
+    pendingsamplepars = samplepars;
+    bool started = generatorrunning;
+    if(!started) {
+        if(generatorjoinable) //the previous thread has finished already
+            pthread_join(generator, NULL);
+        generatorjoinable = started =
+            (pthread_create(&generator, NULL, generatorthread, this) == 0);
+        generatorrunning  = started;
+    }
+    if(!started)
+        pendingsamplepars.clear();
+    pthread_mutex_unlock(&generatormutex);
+
+    if(!started)
+        applyparameters(true);
+}
+
+void PADnoteParameters::waitforgenerator()
+{
+    pthread_mutex_lock(&generatormutex);
+    if(!generatorjoinable) {
+        pthread_mutex_unlock(&generatormutex);
+        return;
+    }
+    const pthread_t thread = generator;
+    generatorjoinable = false;
+    generatorwaited   = true;
+    pthread_mutex_unlock(&generatormutex);
+
+    pthread_join(thread, NULL);
+
+    pthread_mutex_lock(&generatormutex);
+    generatorwaited = false;
+    pthread_mutex_unlock(&generatormutex);
+}
+
+void *PADnoteParameters::generatorthread(void *arg)
+{
+    PADnoteParameters *pars = (PADnoteParameters *)arg;
+
+    pthread_mutex_lock(&pars->generatormutex);
+    while(!pars->pendingsamplepars.empty() && !pars->generatorabort) {
+        const string samplepars = pars->pendingsamplepars;
+        pars->pendingsamplepars.clear();
+        pthread_mutex_unlock(&pars->generatormutex);
+
+        //work on a private copy of the parameters, so they can be changed
+        //(or loaded) meanwhile without disturbing the generation
+        FFTwrapper oscilfft(OSCIL_SIZE);
+        PADnoteParameters *generatorpars =
+            new PADnoteParameters(&oscilfft, NULL);
+        XMLwrapper *xml = new XMLwrapper();
+        if(xml->putXMLdata(samplepars.c_str()))
+            generatorpars->getfromXML(xml);
+        delete (xml);
+
+        Sample smps[PAD_MAX_SAMPLES];
+        int nsamples = generatorpars->generatesamples(smps,
+                                                      &pars->generatorabort);
+        delete (generatorpars);
+
+        if(nsamples > 0) {
+            savecachedsamples(samplepars, smps, nsamples);
+            if(!pars->replacesamplesfromgenerator(smps, nsamples))
+                for(int i = 0; i < nsamples; i++)
+                    delete[] smps[i].smp;
+        }
+
+        pthread_mutex_lock(&pars->generatormutex);
+    }
+    pars->generatorrunning = false;
+    pthread_mutex_unlock(&pars->generatormutex);
+
+    return NULL;
+}
+
+/*
+ * The disk cache of computed samples
+ */
+pthread_mutex_t PADnoteParameters::cachedirmutex = PTHREAD_MUTEX_INITIALIZER;
+
+void PADnoteParameters::setcachedir(const string &dir)
+{
+    pthread_mutex_lock(&cachedirmutex);
+    if((config.PADsynthCacheDir == NULL) || (dir != config.PADsynthCacheDir)) {
+        free(config.PADsynthCacheDir);
+        config.PADsynthCacheDir = strdup(dir.c_str());
+    }
+    pthread_mutex_unlock(&cachedirmutex);
+}
+
+string PADnoteParameters::cachedir()
+{
+    pthread_mutex_lock(&cachedirmutex);
+    const string dir = (config.PADsynthCacheDir != NULL) ?
+                       config.PADsynthCacheDir : "";
+    pthread_mutex_unlock(&cachedirmutex);
+    return dir;
+}
+
+string PADnoteParameters::cachefilename(const string &samplepars)
+{
+    const string dir = cachedir();
+    if(dir.empty())
+        return string();
+
+    //FNV-1a hash of everything the samples depend on
+    uint64_t hash = 14695981039346656037ULL;
+    char     tmpstr[64];
+    snprintf(tmpstr, 64, "%d %d %d ", SAMPLE_RATE, OSCIL_SIZE,
+             (int) sizeof(REALTYPE));
+    const string key = tmpstr + samplepars;
+    for(unsigned int i = 0; i < key.size(); i++) {
+        hash ^= (unsigned char) key[i];
+        hash *= 1099511628211ULL;
+    }
+
+    snprintf(tmpstr, 64, "padsynth-%016llx.smp", (unsigned long long) hash);
+    return dir + tmpstr;
+}
+
+static const char PAD_CACHE_MAGIC[8] = {'Z', 'P', 'A', 'D', 'S', 'M', 'P', '1'};
+
+//maximum size of the disk cache in bytes
+static const long long PAD_CACHE_MAX_SIZE = 512LL * 1024 * 1024;
+
+int PADnoteParameters::loadcachedsamples(const string &samplepars,
+                                         Sample *smps)
+{
+    const string filename = cachefilename(samplepars);
+    if(filename.empty())
+        return 0;
+
+    FILE *file = fopen(filename.c_str(), "rb");
+    if(file == NULL)
+        return 0;
+
+    //mark the file as recently used, see prunecache()
+    utime(filename.c_str(), NULL);
+
+    char magic[8];
+    int  nsamples = 0;
+    if((fread(magic, sizeof(magic), 1, file) != 1)
+       || (memcmp(magic, PAD_CACHE_MAGIC, sizeof(magic)) != 0)
+       || (fread(&nsamples, sizeof(nsamples), 1, file) != 1)
+       || (nsamples <= 0) || (nsamples > PAD_MAX_SAMPLES))
+        nsamples = 0;
+
+    int n;
+    for(n = 0; n < nsamples; n++) {
+        int size;
+        if((fread(&size, sizeof(size), 1, file) != 1)
+           || (size < (1 << 14)) || (size > (1 << 24))
+           || (fread(&smps[n].basefreq, sizeof(REALTYPE), 1, file) != 1))
+            break;
+        smps[n].size = size;
+        smps[n].smp  = new REALTYPE[size + extra_samples];
+        if(fread(smps[n].smp, sizeof(REALTYPE), size + extra_samples, file)
+           != (size_t) (size + extra_samples)) {
+            delete[] smps[n].smp;
+            break;
+        }
+    }
+    fclose(file);
+
+    if(n < nsamples) { //truncated or broken file
+        for(int i = 0; i < n; i++)
+            delete[] smps[i].smp;
+        return 0;
+    }
+
+    return nsamples;
+}
+
+void PADnoteParameters::savecachedsamples(const string &samplepars,
+                                          const Sample *smps,
+                                          int nsamples)
+{
+    const string filename = cachefilename(samplepars);
+    if(filename.empty() || (nsamples <= 0))
+        return;
+
+    //write to a temporary file first, so no other instance can read a
+    //partially written file
+    const string tmpfilename = filename + ".tmp";
+    FILE *file = fopen(tmpfilename.c_str(), "wb");
+    if(file == NULL)
+        return;
+
+    bool ok = (fwrite(PAD_CACHE_MAGIC, sizeof(PAD_CACHE_MAGIC), 1, file) == 1)
+              && (fwrite(&nsamples, sizeof(nsamples), 1, file) == 1);
+    for(int n = 0; ok && (n < nsamples); n++)
+        ok = (fwrite(&smps[n].size, sizeof(smps[n].size), 1, file) == 1)
+             && (fwrite(&smps[n].basefreq, sizeof(REALTYPE), 1, file) == 1)
+             && (fwrite(smps[n].smp, sizeof(REALTYPE),
+                        smps[n].size + extra_samples, file)
+                 == (size_t) (smps[n].size + extra_samples));
+    ok = (fclose(file) == 0) && ok;
+
+    if(!ok || (rename(tmpfilename.c_str(), filename.c_str()) != 0)) {
+        remove(tmpfilename.c_str());
+        return;
+    }
+
+    prunecache(filename);
+}
+
+namespace {
+struct CacheFile {
+    string    filename;
+    time_t    lastused;
+    long long size;
+
+    bool operator<(const CacheFile &other) const
+    {
+        return lastused < other.lastused;
+    }
+};
+}
+
+/*
+ * Removes the least recently used files from the disk cache as long as it
+ * is bigger than PAD_CACHE_MAX_SIZE (the modification time of a file is
+ * updated whenever it's loaded)
+ */
+void PADnoteParameters::prunecache(const string &keepfilename)
+{
+    const string dirname = cachedir();
+    DIR *dir = opendir(dirname.c_str());
+    if(dir == NULL)
+        return;
+
+    vector<CacheFile> files;
+    long long totalsize = 0;
+    struct dirent *entry;
+    while((entry = readdir(dir)) != NULL) {
+        const string name = entry->d_name;
+        if((name.size() < 13) || (name.compare(0, 9, "padsynth-") != 0)
+           || (name.compare(name.size() - 4, 4, ".smp") != 0))
+            continue;
+
+        CacheFile file;
+        file.filename = dirname + name;
+        struct stat st;
+        if(stat(file.filename.c_str(), &st) != 0)
+            continue;
+        file.lastused = st.st_mtime;
+        file.size     = st.st_size;
+        totalsize    += file.size;
+        files.push_back(file);
+    }
+    closedir(dir);
+
+    sort(files.begin(), files.end());
+    for(unsigned int i = 0;
+        (i < files.size()) && (totalsize > PAD_CACHE_MAX_SIZE); i++) {
+        if(files[i].filename == keepfilename)
+            continue;
+        //another instance might have removed it already
+        if((remove(files[i].filename.c_str()) == 0) || (errno == ENOENT))
+            totalsize -= files[i].size;
     }
-    else
-        for(int i = samplemax; i < PAD_MAX_SAMPLES; i++)
-            deletesample(i);
-    ;
 }
 
 void PADnoteParameters::export2wav(string basefilename)
@@ -690,11 +1054,8 @@ void PADnoteParameters::export2wav(string basefilename)
 
 
 
-void PADnoteParameters::add2XML(XMLwrapper *xml)
+void PADnoteParameters::addsamplepars2XML(XMLwrapper *xml)
 {
-    xml->setPadSynth(true);
-
-    xml->addparbool("stereo", PStereo);
     xml->addpar("mode", Pmode);
     xml->addpar("bandwidth", Pbandwidth);
     xml->addpar("bandwidth_scale", Pbwscale);
@@ -735,6 +1096,29 @@ void PADnoteParameters::add2XML(XMLwrapper *xml)
     xml->addpar("octaves", Pquality.oct);
     xml->addpar("samples_per_octave", Pquality.smpoct);
     xml->endbranch();
+}
+
+string PADnoteParameters::getsamplepars()
+{
+    XMLwrapper *xml = new XMLwrapper();
+    addsamplepars2XML(xml);
+    char *xmldata = xml->getXMLdata();
+    delete (xml);
+
+    string samplepars;
+    if(xmldata != NULL) {
+        samplepars = xmldata;
+        free(xmldata);
+    }
+    return samplepars;
+}
+
+void PADnoteParameters::add2XML(XMLwrapper *xml)
+{
+    xml->setPadSynth(true);
+
+    xml->addparbool("stereo", PStereo);
+    addsamplepars2XML(xml);
 
     xml->beginbranch("AMPLITUDE_PARAMETERS");
     xml->addpar("volume", PVolume);
@@ -146,16 +146,29 @@ class PADnoteParameters:public Presets
         REALTYPE getNhr(int n); //gets the n-th overtone position relatively to N harmonic
 
         void applyparameters(bool lockmutex);
+        /**Like applyparameters(true), but the samples are computed in a
+         * background thread, while the current samples keep being played
+         * until the new ones are ready*/
+        void applyparametersinbackground();
+        /**Blocks until samples which are being computed in background are
+         * available, e.g. before rendering offline*/
+        void waitforgenerator();
         void export2wav(std::string basefilename);
 
+        /**Sets the directory of the disk cache (which is shared by all
+         * instances and also used by the background threads)*/
+        static void setcachedir(const std::string &dir);
+        static std::string cachedir();
+
         OscilGen  *oscilgen;
         Resonance *resonance;
 
-        struct {
+        struct Sample {
             int size;
             REALTYPE  basefreq;
             REALTYPE *smp;
-        } sample[PAD_MAX_SAMPLES], newsample;
+        };
+        Sample sample[PAD_MAX_SAMPLES], newsample;
 
     private:
         void generatespectrum_bandwidthMode(REALTYPE *spectrum,
@@ -173,8 +186,44 @@ class PADnoteParameters:public Presets
         void deletesamples();
         void deletesample(int n);
 
+        /**Stores the parameters the samples are computed from*/
+        void addsamplepars2XML(XMLwrapper *xml);
+        /**Returns the serialized parameters the samples are computed from*/
+        std::string getsamplepars();
+
+        /**Computes the samples into smps and returns their number;
+         * returns 0 if *abortflag got set meanwhile*/
+        int generatesamples(Sample *smps, const volatile bool *abortflag);
+        /**Replaces the current samples by smps (which is taken over)*/
+        void replacesamples(Sample *smps, int nsamples, bool lockmutex);
+        /**Like replacesamples(true), but gives up if the generator is
+         * aborted while waiting for the mutex*/
+        bool replacesamplesfromgenerator(Sample *smps, int nsamples);
+
+        //Disk cache of computed samples, keyed on a hash of getsamplepars()
+        static std::string cachefilename(const std::string &samplepars);
+        static int loadcachedsamples(const std::string &samplepars,
+                                     Sample *smps);
+        static void savecachedsamples(const std::string &samplepars,
+                                      const Sample *smps,
+                                      int nsamples);
+        static void prunecache(const std::string &keepfilename);
+
+        static void *generatorthread(void *arg);
+
         FFTwrapper      *fft;
         pthread_mutex_t *mutex;
+
+        //Background sample generation
+        pthread_t       generator;
+        pthread_mutex_t generatormutex; //protects the members below
+        bool            generatorrunning, generatorjoinable;
+        volatile bool   generatorabort;
+        //set while someone holding the mutex waits for the generator
+        volatile bool   generatorwaited;
+        std::string     pendingsamplepars; //empty if nothing is pending
+
+        static pthread_mutex_t cachedirmutex; //protects config.PADsynthCacheDir
 };
 
 
@@ -104,7 +104,7 @@ ADnote::ADnote(ADnoteParameters *pars,
         NoteGlobalPar.Punch.Enabled = 0;
 
     for(int nvoice = 0; nvoice < NUM_VOICES; nvoice++) {
-        pars->VoicePar[nvoice].OscilSmp->newrandseed(rand());
+        pars->VoicePar[nvoice].OscilSmp->newrandseed(prng());
         NoteVoicePar[nvoice].OscilSmp = NULL;
         NoteVoicePar[nvoice].FMSmp    = NULL;
         NoteVoicePar[nvoice].VoiceOut = NULL;
@@ -293,7 +293,7 @@ ADnote::ADnote(ADnoteParameters *pars,
         if(pars->VoicePar[nvoice].Pextoscil != -1)
             vc = pars->VoicePar[nvoice].Pextoscil;
         if(!pars->GlobalPar.Hrandgrouping)
-            pars->VoicePar[vc].OscilSmp->newrandseed(rand());
+            pars->VoicePar[vc].OscilSmp->newrandseed(prng());
         int oscposhi_start =
             pars->VoicePar[vc].OscilSmp->get(NoteVoicePar[nvoice].OscilSmp,
                                              getvoicebasefreq(nvoice),
@@ -528,7 +528,7 @@ void ADnote::ADlegatonote(REALTYPE freq,
         if(pars->VoicePar[nvoice].Pextoscil != -1)
             vc = pars->VoicePar[nvoice].Pextoscil;
         if(!pars->GlobalPar.Hrandgrouping)
-            pars->VoicePar[vc].OscilSmp->newrandseed(rand());
+            pars->VoicePar[vc].OscilSmp->newrandseed(prng());
 
         pars->VoicePar[vc].OscilSmp->get(NoteVoicePar[nvoice].OscilSmp,
                                          getvoicebasefreq(nvoice),
@@ -656,7 +656,7 @@ void ADnote::ADlegatonote(REALTYPE freq,
         /* Voice Modulation Parameters Init */
         if((NoteVoicePar[nvoice].FMEnabled != NONE)
            && (NoteVoicePar[nvoice].FMVoice < 0)) {
-            partparams->VoicePar[nvoice].FMSmp->newrandseed(rand());
+            partparams->VoicePar[nvoice].FMSmp->newrandseed(prng());
 
             //Perform Anti-aliasing only on MORPH or RING MODULATION
 
@@ -665,7 +665,7 @@ void ADnote::ADlegatonote(REALTYPE freq,
                 vc = partparams->VoicePar[nvoice].PextFMoscil;
 
             if(!partparams->GlobalPar.Hrandgrouping)
-                partparams->VoicePar[vc].FMSmp->newrandseed(rand());
+                partparams->VoicePar[vc].FMSmp->newrandseed(prng());
 
             ///oscposhiFM[nvoice]=(oscposhi[nvoice]+partparams->VoicePar[vc].FMSmp->get(NoteVoicePar[nvoice].FMSmp,tmp)) % OSCIL_SIZE;
             // /	oscposhi[nvoice]+partparams->VoicePar[vc].FMSmp->get(NoteVoicePar[nvoice].FMSmp,tmp); //(gf) Modif of the above line.
@@ -937,7 +937,7 @@ void ADnote::initparameters()
         /* Voice Modulation Parameters Init */
         if((NoteVoicePar[nvoice].FMEnabled != NONE)
            && (NoteVoicePar[nvoice].FMVoice < 0)) {
-            partparams->VoicePar[nvoice].FMSmp->newrandseed(rand());
+            partparams->VoicePar[nvoice].FMSmp->newrandseed(prng());
             NoteVoicePar[nvoice].FMSmp =
                 new REALTYPE[OSCIL_SIZE + OSCIL_SMP_EXTRA_SAMPLES];
 
@@ -954,7 +954,7 @@ void ADnote::initparameters()
                 tmp = getFMvoicebasefreq(nvoice);
             ;
             if(!partparams->GlobalPar.Hrandgrouping)
-                partparams->VoicePar[vc].FMSmp->newrandseed(rand());
+                partparams->VoicePar[vc].FMSmp->newrandseed(prng());
 
             for(int k = 0; k < unison_size[nvoice]; k++)
                 oscposhiFM[nvoice][k] =
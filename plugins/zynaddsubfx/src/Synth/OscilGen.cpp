@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "OscilGen.h"
 #include "../Effects/Distorsion.h"
@@ -41,6 +42,14 @@ OscilGen::OscilGen(FFTwrapper *fft_, Resonance *res_):Presets()
     randseed = 1;
     ADvsPAD  = false;
 
+    revision      = 0;
+    wavecachenext = 0;
+    for(int i = 0; i < OSCIL_WAVE_CACHE_SIZE; i++) {
+        wavecache[i].smps     = NULL;
+        wavecache[i].nyquist  = 0;
+        wavecache[i].revision = 0;
+    }
+
     defaults();
 }
 
@@ -50,6 +59,8 @@ OscilGen::~OscilGen()
     deleteFFTFREQS(&outoscilFFTfreqs);
     deleteFFTFREQS(&basefuncFFTfreqs);
     deleteFFTFREQS(&oscilFFTfreqs);
+    for(int i = 0; i < OSCIL_WAVE_CACHE_SIZE; i++)
+        delete[] wavecache[i].smps;
 }
 
 
@@ -136,9 +147,7 @@ void OscilGen::convert2sine(int magtype)
     newFFTFREQS(&freqs, OSCIL_SIZE / 2);
 
     get(oscil, -1.0);
-    FFTwrapper *fft = new FFTwrapper(OSCIL_SIZE);
     fft->smps2freqs(oscil, freqs);
-    delete (fft);
 
     REALTYPE max = 0.0;
 
@@ -929,6 +938,7 @@ void OscilGen::prepare()
     oldharmonicshift = Pharmonicshift + Pharmonicshiftfirst * 256;
 
     oscilprepared    = 1;
+    revision++; //invalidates all cached waveforms
 }
 
 void OscilGen::adaptiveharmonic(FFTFREQS f, REALTYPE freq)
@@ -1104,18 +1114,34 @@ short int OscilGen::get(REALTYPE *smps, REALTYPE freqHz, int resonance)
         (int)((RND * 2.0 - 1.0) * (REALTYPE) OSCIL_SIZE * (Prand - 64.0) / 64.0);
     outpos = (outpos + 2 * OSCIL_SIZE) % OSCIL_SIZE;
 
-
-    for(i = 0; i < OSCIL_SIZE / 2; i++) {
-        outoscilFFTfreqs.c[i] = 0.0;
-        outoscilFFTfreqs.s[i] = 0.0;
-    }
-
     nyquist = (int)(0.5 * SAMPLE_RATE / fabs(freqHz)) + 2;
     if(ADvsPAD)
         nyquist = (int)(OSCIL_SIZE / 2);
     if(nyquist > OSCIL_SIZE / 2)
         nyquist = OSCIL_SIZE / 2;
 
+    //the result depends only on oscilFFTfreqs and the nyquist unless
+    //randomness, adaptive harmonics or the resonance are involved
+    const bool cacheable = (!ADvsPAD) && (freqHz > 0.1) && (Prand <= 64)
+                           && (Pamprandtype == 0) && (Padaptiveharmonics == 0)
+                           && ((resonance == 0) || (res->Penabled == 0));
+    if(cacheable)
+        for(i = 0; i < OSCIL_WAVE_CACHE_SIZE; i++)
+            if((wavecache[i].smps != NULL)
+               && (wavecache[i].revision == revision)
+               && (wavecache[i].nyquist == nyquist)) {
+                memcpy(smps, wavecache[i].smps, OSCIL_SIZE * sizeof(REALTYPE));
+                if(Prand < 64)
+                    return outpos;
+                else
+                    return 0;
+            }
+
+    for(i = 0; i < OSCIL_SIZE / 2; i++) {
+        outoscilFFTfreqs.c[i] = 0.0;
+        outoscilFFTfreqs.s[i] = 0.0;
+    }
+
 
     int realnyquist = nyquist;
 
@@ -1156,8 +1182,8 @@ short int OscilGen::get(REALTYPE *smps, REALTYPE freqHz, int resonance)
 
     //Harmonic Amplitude Randomness
     if((freqHz > 0.1) && (!ADvsPAD)) {
-        unsigned int realrnd = rand();
-        srand(randseed);
+        unsigned int prevstate = prng_state;
+        sprng(randseed);
         REALTYPE power     = Pamprandpower / 127.0;
         REALTYPE normalize = 1.0 / (1.2 - power);
         switch(Pamprandtype) {
@@ -1181,7 +1207,7 @@ short int OscilGen::get(REALTYPE *smps, REALTYPE freqHz, int resonance)
             }
             break;
         }
-        srand(realrnd + 1);
+        sprng(prevstate);
     }
 
     if((freqHz > 0.1) && (resonance != 0))
@@ -1211,6 +1237,16 @@ short int OscilGen::get(REALTYPE *smps, REALTYPE freqHz, int resonance)
         fft->freqs2smps(outoscilFFTfreqs, smps);
         for(i = 0; i < OSCIL_SIZE; i++)
             smps[i] *= 0.25;                     //correct the amplitude
+
+        if(cacheable) {
+            CachedWave &wave = wavecache[wavecachenext];
+            wavecachenext = (wavecachenext + 1) % OSCIL_WAVE_CACHE_SIZE;
+            if(wave.smps == NULL)
+                wave.smps = new REALTYPE[OSCIL_SIZE];
+            memcpy(wave.smps, smps, OSCIL_SIZE * sizeof(REALTYPE));
+            wave.nyquist  = nyquist;
+            wave.revision = revision;
+        }
     }
 
     if(Prand < 64)
@@ -29,6 +29,9 @@
 #include "../DSP/FFTwrapper.h"
 #include "../Params/Presets.h"
 
+/**Number of rendered waveforms (one per band-limit) kept by each OscilGen*/
+#define OSCIL_WAVE_CACHE_SIZE 4
+
 class OscilGen:public Presets
 {
     public:
@@ -176,6 +179,21 @@ class OscilGen:public Presets
         Resonance *res;
 
         unsigned int randseed;
+
+        /**
+         * Waveforms rendered by get() which don't depend on randomness or
+         * on the exact frequency, keyed on the band-limit (nyquist) and on
+         * the revision of oscilFFTfreqs they were made from. This way voices
+         * which start with the same parameters don't need an IFFT each.
+         */
+        struct CachedWave {
+            REALTYPE *smps; //allocated on first use
+            int       nyquist;
+            unsigned int revision;
+        };
+        CachedWave   wavecache[OSCIL_WAVE_CACHE_SIZE];
+        int          wavecachenext; //the entry to be replaced next
+        unsigned int revision; //incremented each time oscilFFTfreqs is changed
 };
 
 
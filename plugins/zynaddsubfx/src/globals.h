@@ -181,10 +181,30 @@ extern int OSCIL_SIZE;
 #define dB2rap(dB) ((exp((dB) * LOG_10 / 20.0)))
 #define rap2dB(rap) ((20 * log(rap) / LOG_10))
 
+/*
+ * The random generator
+ * Every thread has its own state, so parts rendered in parallel don't
+ * interfere; Master::ComputePartOut() swaps in the state of each part
+ */
+#define PRNG_MAX 0x7fff
+
+extern __thread unsigned int prng_state;
+
+inline unsigned int prng()
+{
+    prng_state = prng_state * 1103515245 + 12345;
+    return (prng_state >> 16) & PRNG_MAX;
+}
+
+inline void sprng(unsigned int seed)
+{
+    prng_state = seed;
+}
+
 /*
  * The random generator (0.0..1.0)
  */
-#define RND (rand() / (RAND_MAX + 1.0))
+#define RND (prng() / (PRNG_MAX + 1.0))
 
 #define ZERO(data, size) {char *data_ = (char *) data; for(int i = 0; \
                                                            i < size; \
@@ -0,0 +1,75 @@
+/*
+ * AutoSaveThread.cpp - writes recovery files in background
+ *
+ * Copyright (c) 2014 Tobias Doerffel <tobydox/at/users.sourceforge.net>
+ *
+ * This file is part of Linux MultiMedia Studio - http://lmms.sourceforge.net
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "AutoSaveThread.h"
+#include "DataFile.h"
+
+
+AutoSaveThread::AutoSaveThread() :
+	QThread(),
+	m_dataFile( NULL ),
+	m_fileName()
+{
+}
+
+
+
+
+AutoSaveThread::~AutoSaveThread()
+{
+	wait();
+	delete m_dataFile;
+}
+
+
+
+
+bool AutoSaveThread::save( DataFile * dataFile, const QString & fileName )
+{
+	if( isRunning() )
+	{
+		delete dataFile;
+		return false;
+	}
+
+	delete m_dataFile;
+	m_dataFile = dataFile;
+	m_fileName = fileName;
+
+	start( QThread::LowPriority );
+
+	return true;
+}
+
+
+
+
+void AutoSaveThread::run()
+{
+	m_dataFile->writeFile( m_fileName, false );
+
+	delete m_dataFile;
+	m_dataFile = NULL;
+}
+
@@ -27,6 +27,8 @@
 #include "AutomatableModel.h"
 #include "AutomationPattern.h"
 #include "ControllerConnection.h"
+#include "engine.h"
+#include "ProjectJournal.h"
 
 
 float AutomatableModel::s_copiedValue = 0;
@@ -182,8 +184,18 @@ void AutomatableModel::setValue( const float value )
 	m_value = fittedValue( value );
 	if( old_val != m_value )
 	{
-		// add changes to history so user can undo it
-		addJournalCheckPoint();
+		// add changes to history so user can undo it - changes of
+		// linked models are undone along with this one
+		const bool addToJournal = isJournalling();
+		if( addToJournal )
+		{
+			engine::projectJournal()->beginInteraction( true );
+			engine::projectJournal()->addValueCheckPoint( this, old_val );
+		}
+		else
+		{
+			engine::projectJournal()->markModified();
+		}
 
 		// notify linked models
 		for( AutoModelVector::Iterator it = m_linkedModels.begin(); it != m_linkedModels.end(); ++it )
@@ -195,6 +207,10 @@ void AutomatableModel::setValue( const float value )
 				(*it)->setJournalling( journalling );
 			}
 		}
+		if( addToJournal )
+		{
+			engine::projectJournal()->endInteraction();
+		}
 		emit dataChanged();
 	}
 	else
@@ -207,6 +223,17 @@ void AutomatableModel::setValue( const float value )
 
 
 
+void AutomatableModel::addJournalCheckPoint()
+{
+	if( isJournalling() )
+	{
+		engine::projectJournal()->addValueCheckPoint( this, m_value );
+	}
+}
+
+
+
+
 void AutomatableModel::setAutomatedValue( const float value )
 {
 	++m_setValueDepth;
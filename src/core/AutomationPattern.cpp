@@ -34,6 +34,7 @@
 #include "AutomationTrack.h"
 #include "ProjectJournal.h"
 #include "bb_track_container.h"
+#include "Mixer.h"
 #include "song.h"
 
 
@@ -47,7 +48,8 @@ AutomationPattern::AutomationPattern( AutomationTrack * _auto_track ) :
 	m_objects(),
 	m_tension( 1.0 ),
 	m_progressionType( DiscreteProgression ),
-	m_dragging( false )
+	m_dragging( false ),
+	m_batchEditDepth( 0 )
 {
 	changeLength( MidiTime( 1, 0 ) );
 }
@@ -60,7 +62,8 @@ AutomationPattern::AutomationPattern( const AutomationPattern & _pat_to_copy ) :
 	m_autoTrack( _pat_to_copy.m_autoTrack ),
 	m_objects( _pat_to_copy.m_objects ),
 	m_tension( _pat_to_copy.m_tension ),
-	m_progressionType( _pat_to_copy.m_progressionType )
+	m_progressionType( _pat_to_copy.m_progressionType ),
+	m_batchEditDepth( 0 )
 {
 	for( timeMap::const_iterator it = _pat_to_copy.m_timeMap.begin();
 				it != _pat_to_copy.m_timeMap.end(); ++it )
@@ -180,13 +183,20 @@ MidiTime AutomationPattern::putValue( const MidiTime & _time,
 							const float _value,
 							const bool _quant_pos )
 {
-	cleanObjects();
-
 	MidiTime newTime = _quant_pos && engine::automationEditor() ?
 		note::quantized( _time,
 			engine::automationEditor()->quantization() ) :
 		_time;
 
+	if( m_batchEditDepth > 0 )
+	{
+		// mixer is locked already, commitBatchEdit() does the rest
+		m_timeMap[newTime] = _value;
+		return newTime;
+	}
+
+	cleanObjects();
+
 	m_timeMap[newTime] = _value;
 	timeMap::const_iterator it = m_timeMap.find( newTime );
 	if( it != m_timeMap.begin() )
@@ -210,6 +220,44 @@ MidiTime AutomationPattern::putValue( const MidiTime & _time,
 
 
 
+void AutomationPattern::beginBatchEdit()
+{
+	if( m_batchEditDepth++ == 0 )
+	{
+		engine::mixer()->lock();
+		cleanObjects();
+	}
+}
+
+
+
+
+void AutomationPattern::commitBatchEdit()
+{
+	if( m_batchEditDepth == 0 || --m_batchEditDepth > 0 )
+	{
+		return;
+	}
+
+	if( !m_timeMap.isEmpty() )
+	{
+		generateTangents();
+	}
+	engine::mixer()->unlock();
+
+	// we need to maximize our length in case we're part of a hidden
+	// automation track as the user can't resize this pattern
+	if( getTrack() && getTrack()->type() == track::HiddenAutomationTrack )
+	{
+		changeLength( length() );
+	}
+
+	emit dataChanged();
+}
+
+
+
+
 void AutomationPattern::removeValue( const MidiTime & _time,
 									 const bool _quant_pos )
 {
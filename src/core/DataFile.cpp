@@ -28,9 +28,12 @@
 
 #include <math.h>
 
+#include <QtCore/QDataStream>
 #include <QtCore/QDebug>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QPair>
+#include <QtCore/QStringList>
 #include <QtCore/QTextStream>
 #include <QtGui/QMessageBox>
 
@@ -41,10 +44,36 @@
 #include "Effect.h"
 #include "lmmsversion.h"
 
+#ifdef LMMS_HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 // bbTCO::defaultColor()
 #include "bb_track.h"
 
 
+static const char BinaryProjectMagic[] = "LMMSPRJB";
+static const int BinaryProjectMagicLength = 8;
+static const quint32 BinaryProjectVersion = 1;
+
+// attributes holding base64 encoded data which is stored as separate chunk
+// in binary projects
+static const struct
+{
+	const char * element;
+	const char * attribute;
+} embeddedDataAttributes[] =
+{
+	{ "sampletco", "data" },
+	{ "audiofileprocessor", "sampledata" },
+	{ NULL, NULL }
+} ;
+
+
+QList<DataFile *> DataFile::s_binaryFiles;
+QMutex DataFile::s_binaryFilesMutex;
+
+
 
 DataFile::typeDescStruct
 		DataFile::s_types[DataFile::TypeCount] =
@@ -65,7 +94,9 @@ DataFile::DataFile( Type type ) :
 	QDomDocument( "lmms-project" ),
 	m_content(),
 	m_head(),
-	m_type( type )
+	m_type( type ),
+	m_binaryFile( NULL ),
+	m_keepEmbeddedDataRaw( false )
 {
 	appendChild( createProcessingInstruction("xml", "version=\"1.0\""));
 	QDomElement root = createElement( "lmms-project" );
@@ -89,7 +120,9 @@ DataFile::DataFile( Type type ) :
 DataFile::DataFile( const QString & _fileName ) :
 	QDomDocument(),
 	m_content(),
-	m_head()
+	m_head(),
+	m_binaryFile( NULL ),
+	m_keepEmbeddedDataRaw( false )
 {
 	QFile inFile( _fileName );
 	if( !inFile.open( QIODevice::ReadOnly ) )
@@ -104,6 +137,14 @@ DataFile::DataFile( const QString & _fileName ) :
 			return;
 	}
 
+	if( inFile.peek( BinaryProjectMagicLength ) ==
+			QByteArray( BinaryProjectMagic, BinaryProjectMagicLength ) )
+	{
+		inFile.close();
+		loadBinary( _fileName );
+		return;
+	}
+
 	loadData( inFile.readAll(), _fileName );
 }
 
@@ -113,7 +154,9 @@ DataFile::DataFile( const QString & _fileName ) :
 DataFile::DataFile( const QByteArray & _data ) :
 	QDomDocument(),
 	m_content(),
-	m_head()
+	m_head(),
+	m_binaryFile( NULL ),
+	m_keepEmbeddedDataRaw( false )
 {
 	loadData( _data, "<internal data>" );
 }
@@ -123,6 +166,15 @@ DataFile::DataFile( const QByteArray & _data ) :
 
 DataFile::~DataFile()
 {
+	if( m_binaryFile || m_keepEmbeddedDataRaw )
+	{
+		s_binaryFilesMutex.lock();
+		s_binaryFiles.removeAll( this );
+		s_binaryFilesMutex.unlock();
+		m_embeddedData.clear();
+		// also unmaps all embedded data
+		delete m_binaryFile;
+	}
 }
 
 
@@ -135,7 +187,8 @@ QString DataFile::nameWithExtension( const QString & _fn ) const
 		case SongProject:
 			if( _fn.section( '.', -1 ) != "mmp" &&
 					_fn.section( '.', -1 ) != "mpt" &&
-					_fn.section( '.', -1 ) != "mmpz" )
+					_fn.section( '.', -1 ) != "mmpz" &&
+					_fn.section( '.', -1 ) != "mmpb" )
 			{
 				if( configManager::inst()->value( "app",
 						"nommpz" ).toInt() == 0 )
@@ -179,7 +232,7 @@ void DataFile::write( QTextStream & _strm )
 
 
 
-bool DataFile::writeFile( const QString& filename )
+bool DataFile::writeFile( const QString& filename, bool showErrors )
 {
 	const QString fullName = nameWithExtension( filename );
 	const QString fullNameTemp = fullName + ".new";
@@ -189,6 +242,11 @@ bool DataFile::writeFile( const QString& filename )
 
 	if( !outfile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
 	{
+		if( !showErrors )
+		{
+			qWarning() << "Could not open" << fullName << "for writing";
+			return false;
+		}
 		QMessageBox::critical( NULL,
 			SongEditor::tr( "Could not write file" ),
 			SongEditor::tr( "Could not open %1 for writing. You probably are not permitted to "
@@ -197,6 +255,11 @@ bool DataFile::writeFile( const QString& filename )
 		return false;
 	}
 
+	if( m_keepEmbeddedDataRaw && fullName.section( '.', -1 ) != "mmpb" )
+	{
+		inlineEmbeddedData();
+	}
+
 	if( fullName.section( '.', -1 ) == "mmpz" )
 	{
 		QString xml;
@@ -204,12 +267,37 @@ bool DataFile::writeFile( const QString& filename )
 		write( ts );
 		outfile.write( qCompress( xml.toUtf8() ) );
 	}
+	else if( fullName.section( '.', -1 ) == "mmpb" )
+	{
+		if( !writeBinary( outfile ) || outfile.error() != QFile::NoError )
+		{
+			outfile.close();
+			outfile.remove();
+			if( !showErrors )
+			{
+				qWarning() << "Could not write" << fullName;
+				return false;
+			}
+			QMessageBox::critical( NULL,
+				SongEditor::tr( "Could not write file" ),
+				SongEditor::tr( "An error occured while writing %1. "
+								"Please make sure there is enough free "
+								"disk space and try again." ).arg( fullName ) );
+			return false;
+		}
+	}
 	else
 	{
 		QTextStream ts( &outfile );
 		write( ts );
 	}
 
+	// make sure data actually is on disk before replacing old file with it
+	outfile.flush();
+#ifdef LMMS_HAVE_UNISTD_H
+	fsync( outfile.handle() );
+#endif
+
 	outfile.close();
 
 	// make sure the file has been written correctly
@@ -231,6 +319,297 @@ bool DataFile::writeFile( const QString& filename )
 
 
 
+bool DataFile::hasEmbeddedData( const QDomElement & element,
+												const QString & attribute )
+{
+	return !element.attribute( attribute ).isEmpty() ||
+				element.hasAttribute( attribute + "ref" );
+}
+
+
+
+
+QByteArray DataFile::embeddedData( const QDomElement & element,
+												const QString & attribute )
+{
+	if( element.hasAttribute( attribute ) )
+	{
+		return QByteArray::fromBase64( element.attribute( attribute ).toUtf8() );
+	}
+
+	const QString ref = attribute + "ref";
+	if( element.hasAttribute( ref ) )
+	{
+		const int id = element.attribute( ref ).toInt();
+		const QDomDocument doc = element.ownerDocument();
+		QMutexLocker ml( &s_binaryFilesMutex );
+		foreach( DataFile * dataFile, s_binaryFiles )
+		{
+			if( doc == *dataFile )
+			{
+				return dataFile->embeddedDataChunk( id );
+			}
+		}
+		qWarning() << "DataFile::embeddedData(): no data for" << ref << id;
+	}
+
+	return QByteArray();
+}
+
+
+
+
+void DataFile::setEmbeddedData( QDomElement & element,
+						const QString & attribute, const QByteArray & data )
+{
+	const QDomDocument doc = element.ownerDocument();
+	s_binaryFilesMutex.lock();
+	foreach( DataFile * dataFile, s_binaryFiles )
+	{
+		if( doc == *dataFile && dataFile->m_keepEmbeddedDataRaw )
+		{
+			const int id = dataFile->m_embeddedData.size();
+			dataFile->m_embeddedData[id] = data;
+			element.removeAttribute( attribute );
+			element.setAttribute( attribute + "ref", id );
+			s_binaryFilesMutex.unlock();
+			return;
+		}
+	}
+	s_binaryFilesMutex.unlock();
+
+	element.removeAttribute( attribute + "ref" );
+	element.setAttribute( attribute, QString( data.toBase64() ) );
+}
+
+
+
+
+void DataFile::setKeepEmbeddedDataRaw()
+{
+	if( !m_keepEmbeddedDataRaw && m_binaryFile == NULL )
+	{
+		m_keepEmbeddedDataRaw = true;
+		QMutexLocker ml( &s_binaryFilesMutex );
+		s_binaryFiles << this;
+	}
+}
+
+
+
+
+void DataFile::inlineEmbeddedData()
+{
+	// may run in auto-save thread, so only touch our own data here
+	m_keepEmbeddedDataRaw = false;
+
+	for( int i = 0; embeddedDataAttributes[i].element != NULL; ++i )
+	{
+		const QString attribute = embeddedDataAttributes[i].attribute;
+		const QString ref = attribute + "ref";
+		QDomNodeList nodes = elementsByTagName(
+									embeddedDataAttributes[i].element );
+		for( int n = 0; n < nodes.count(); ++n )
+		{
+			QDomElement e = nodes.item( n ).toElement();
+			if( e.hasAttribute( ref ) )
+			{
+				const int id = e.attribute( ref ).toInt();
+				e.removeAttribute( ref );
+				e.setAttribute( attribute,
+					QString( embeddedDataChunk( id ).toBase64() ) );
+			}
+		}
+	}
+
+	m_embeddedData.clear();
+	m_embeddedDataSections.clear();
+
+	QMutexLocker ml( &s_binaryFilesMutex );
+	s_binaryFiles.removeAll( this );
+}
+
+
+
+
+bool DataFile::writeBinary( QIODevice & outDevice )
+{
+	// move embedded data out of document so it can be stored without
+	// base64 encoding - document gets restored afterwards; data kept raw
+	// by setEmbeddedData() only needs to be renumbered
+	QList<QByteArray> chunks;
+	QList<QPair<QDomElement, QString> > movedAttributes;
+	QStringList movedData;
+	QList<QPair<QDomElement, QString> > renumberedRefs;
+	QStringList renumberedIds;
+	for( int i = 0; embeddedDataAttributes[i].element != NULL; ++i )
+	{
+		const QString attribute = embeddedDataAttributes[i].attribute;
+		QDomNodeList nodes = elementsByTagName(
+									embeddedDataAttributes[i].element );
+		for( int n = 0; n < nodes.count(); ++n )
+		{
+			QDomElement e = nodes.item( n ).toElement();
+			if( e.attribute( attribute ).isEmpty() )
+			{
+				if( e.hasAttribute( attribute + "ref" ) )
+				{
+					renumberedRefs << qMakePair( e, attribute + "ref" );
+					renumberedIds << e.attribute( attribute + "ref" );
+					chunks << embeddedDataChunk(
+										renumberedIds.last().toInt() );
+					e.setAttribute( attribute + "ref", chunks.size() - 1 );
+				}
+				continue;
+			}
+			movedAttributes << qMakePair( e, attribute );
+			movedData << e.attribute( attribute );
+			chunks << QByteArray::fromBase64( movedData.last().toUtf8() );
+			e.removeAttribute( attribute );
+			e.setAttribute( attribute + "ref", chunks.size() - 1 );
+		}
+	}
+
+	QString xml;
+	QTextStream ts( &xml );
+	write( ts );
+	ts.flush();
+
+	for( int i = 0; i < movedAttributes.size(); ++i )
+	{
+		QDomElement e = movedAttributes[i].first;
+		e.removeAttribute( movedAttributes[i].second + "ref" );
+		e.setAttribute( movedAttributes[i].second, movedData[i] );
+	}
+	for( int i = 0; i < renumberedRefs.size(); ++i )
+	{
+		renumberedRefs[i].first.setAttribute( renumberedRefs[i].second,
+														renumberedIds[i] );
+	}
+
+	// layout: magic, version and a list of sections, each consisting of
+	// type, id, size and payload - unknown sections are skipped on load
+	QDataStream out( &outDevice );
+	out.setVersion( QDataStream::Qt_4_0 );
+	out.writeRawData( BinaryProjectMagic, BinaryProjectMagicLength );
+	out << BinaryProjectVersion;
+
+	const QByteArray document = qCompress( xml.toUtf8() );
+	out << (quint32) Section_Document << (quint32) 0
+						<< (quint64) document.size();
+	out.writeRawData( document.constData(), document.size() );
+
+	for( int i = 0; i < chunks.size(); ++i )
+	{
+		out << (quint32) Section_EmbeddedData << (quint32) i
+						<< (quint64) chunks[i].size();
+		out.writeRawData( chunks[i].constData(), chunks[i].size() );
+	}
+
+	out << (quint32) Section_End << (quint32) 0 << (quint64) 0;
+
+	return out.status() == QDataStream::Ok;
+}
+
+
+
+
+void DataFile::loadBinary( const QString & sourceFile )
+{
+	m_binaryFile = new QFile( sourceFile );
+	if( !m_binaryFile->open( QIODevice::ReadOnly ) )
+	{
+		return;
+	}
+
+	QDataStream in( m_binaryFile );
+	in.setVersion( QDataStream::Qt_4_0 );
+	in.skipRawData( BinaryProjectMagicLength );
+
+	quint32 version;
+	in >> version;
+	if( version > BinaryProjectVersion )
+	{
+		qWarning() << sourceFile << "has been written by a newer version"
+										" of LMMS - trying to load anyway";
+	}
+
+	// read section headers one after another - document gets decompressed,
+	// embedded data is only mapped into memory when being accessed and
+	// decoded on demand by its users
+	const qint64 fileSize = m_binaryFile->size();
+	QByteArray document;
+	while( !in.atEnd() && in.status() == QDataStream::Ok )
+	{
+		quint32 type, id;
+		quint64 size;
+		in >> type >> id >> size;
+		if( in.status() != QDataStream::Ok || type == Section_End )
+		{
+			break;
+		}
+
+		const qint64 pos = m_binaryFile->pos();
+		if( size > (quint64)( fileSize - pos ) )
+		{
+			// following sections can't be located anymore either
+			qWarning() << sourceFile << "is truncated or corrupted - section"
+						<< type << id << "exceeds end of file";
+			break;
+		}
+
+		switch( type )
+		{
+			case Section_Document:
+				document = qUncompress( m_binaryFile->read( size ) );
+				break;
+			case Section_EmbeddedData:
+				m_embeddedDataSections[id] = qMakePair( pos, (qint64) size );
+				break;
+			default:
+				break;
+		}
+		m_binaryFile->seek( pos + size );
+	}
+
+	s_binaryFilesMutex.lock();
+	s_binaryFiles << this;
+	s_binaryFilesMutex.unlock();
+
+	loadData( document, sourceFile );
+}
+
+
+
+
+QByteArray DataFile::embeddedDataChunk( int id )
+{
+	if( m_embeddedData.contains( id ) || m_binaryFile == NULL ||
+				!m_embeddedDataSections.contains( id ) )
+	{
+		return m_embeddedData.value( id );
+	}
+
+	const QPair<qint64, qint64> section = m_embeddedDataSections.take( id );
+#if QT_VERSION >= 0x040400
+	const uchar * mem = m_binaryFile->map( section.first, section.second );
+	if( mem != NULL )
+	{
+		m_embeddedData[id] = QByteArray::fromRawData( (const char *) mem,
+															section.second );
+		return m_embeddedData[id];
+	}
+#endif
+	if( m_binaryFile->seek( section.first ) )
+	{
+		m_embeddedData[id] = m_binaryFile->read( section.second );
+	}
+	return m_embeddedData.value( id );
+}
+
+
+
+
 DataFile::Type DataFile::type( const QString& typeName )
 {
 	for( int i = 0; i < TypeCount; ++i )
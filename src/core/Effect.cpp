@@ -33,6 +33,7 @@
 #include "DummyEffect.h"
 #include "EffectChain.h"
 #include "EffectView.h"
+#include "MixHelpers.h"
 
 
 Effect::Effect( const Plugin::Descriptor * _desc,
@@ -40,6 +41,7 @@ Effect::Effect( const Plugin::Descriptor * _desc,
 			const Descriptor::SubPluginFeatures::Key * _key ) :
 	Plugin( _desc, _parent ),
 	m_parent( NULL ),
+	m_oversampler( engine::mixer()->framesPerPeriod() ),
 	m_key( _key ? *_key : Descriptor::SubPluginFeatures::Key()  ),
 	m_processors( 1 ),
 	m_okay( true ),
@@ -109,6 +111,16 @@ void Effect::loadSettings( const QDomElement & _this )
 
 
 
+sampleFrame * Effect::upsample( const sampleFrame * _buf, const fpp_t _frames )
+{
+	m_oversampler.setFactor( engine::mixer()->
+			currentQualitySettings().sampleRateMultiplier() );
+	return m_oversampler.upsample( _buf, _frames );
+}
+
+
+
+
 Effect * Effect::instantiate( const QString & _plugin_name,
 				Model * _parent,
 				Descriptor::SubPluginFeatures::Key * _key )
@@ -153,6 +165,24 @@ void Effect::checkGate( double _out_sum )
 
 
 
+void Effect::checkGate( const sampleFrame * _buf, const fpp_t _frames )
+{
+	checkGate( MixHelpers::energy( _buf, _frames ) / _frames );
+}
+
+
+
+
+void Effect::mixDryWet( sampleFrame * _buf, const sampleFrame * _wet,
+							const fpp_t _frames )
+{
+	MixHelpers::multiplyAndAddMultiplied( _buf, _wet, dryLevel(),
+							wetLevel(), _frames );
+}
+
+
+
+
 PluginView * Effect::instantiateView( QWidget * _parent )
 {
 	return new EffectView( this, _parent );
@@ -48,7 +48,6 @@ void EnvelopeAndLfoParameters::LfoInstances::trigger()
 	{
 		( *it )->m_lfoFrame +=
 				engine::mixer()->framesPerPeriod();
-		( *it )->m_bad_lfoShapeData = true;
 	}
 }
 
@@ -62,7 +61,6 @@ void EnvelopeAndLfoParameters::LfoInstances::reset()
 							it != m_lfos.end(); ++it )
 	{
 		( *it )->m_lfoFrame = 0;
-		( *it )->m_bad_lfoShapeData = true;
 	}
 }
 
@@ -86,6 +84,25 @@ void EnvelopeAndLfoParameters::LfoInstances::remove( EnvelopeAndLfoParameters *
 
 
 
+EnvelopeAndLfoParameters::LfoInstances::LfoList
+			EnvelopeAndLfoParameters::LfoInstances::activeLfos()
+{
+	QMutexLocker m( &m_lfoListMutex );
+	LfoList active;
+	for( LfoList::ConstIterator it = m_lfos.begin();
+							it != m_lfos.end(); ++it )
+	{
+		if( ( *it )->isLfoActive() )
+		{
+			active.push_back( *it );
+		}
+	}
+	return active;
+}
+
+
+
+
 
 EnvelopeAndLfoParameters::EnvelopeAndLfoParameters(
 					float _value_for_zero_amount,
@@ -100,8 +117,8 @@ EnvelopeAndLfoParameters::EnvelopeAndLfoParameters(
 	m_releaseModel( 0.1, 0.0, 2.0, 0.001, this, tr( "Release" ) ),
 	m_amountModel( 0.0, -1.0, 1.0, 0.005, this, tr( "Modulation" ) ),
 	m_valueForZeroAmount( _value_for_zero_amount ),
-	m_pahdEnv( NULL ),
-	m_rEnv( NULL ),
+	m_pahdFrames( 0 ),
+	m_rFrames( 0 ),
 	m_lfoPredelayModel( 0.0, 0.0, 1.0, 0.001, this, tr( "LFO Predelay" ) ),
 	m_lfoAttackModel( 0.0, 0.0, 1.0, 0.001, this, tr( "LFO Attack" ) ),
 	m_lfoSpeedModel( 0.1, 0.001, 1.0, 0.0001,
@@ -158,7 +175,7 @@ EnvelopeAndLfoParameters::EnvelopeAndLfoParameters(
 
 
 	m_lfoShapeData =
-		new sample_t[engine::mixer()->framesPerPeriod()];
+		new sample_t[engine::mixer()->framesPerPeriod()]();
 
 	updateSampleVars();
 }
@@ -182,8 +199,6 @@ EnvelopeAndLfoParameters::~EnvelopeAndLfoParameters()
 	m_lfoWaveModel.disconnect( this );
 	m_x100Model.disconnect( this );
 
-	delete[] m_pahdEnv;
-	delete[] m_rEnv;
 	delete[] m_lfoShapeData;
 
 	instances()->remove( this );
@@ -198,45 +213,64 @@ EnvelopeAndLfoParameters::~EnvelopeAndLfoParameters()
 
 
 
-inline sample_t EnvelopeAndLfoParameters::lfoShapeSample( fpp_t _frame_offset )
+void EnvelopeAndLfoParameters::updateLfoShapeData()
 {
-	f_cnt_t frame = ( m_lfoFrame + _frame_offset ) % m_lfoOscillationFrames;
-	const float phase = frame / static_cast<float>(
-						m_lfoOscillationFrames );
-	sample_t shape_sample;
-	switch( m_lfoWaveModel.value()  )
+	const fpp_t frames = engine::mixer()->framesPerPeriod();
+
+	// first calculate phases so the loops below don't have to care
+	// about wrapping around and contain nothing but the shape function
+	f_cnt_t frame = m_lfoFrame % m_lfoOscillationFrames;
+	const float oscFrames = static_cast<float>( m_lfoOscillationFrames );
+	for( fpp_t offset = 0; offset < frames; ++offset )
+	{
+		m_lfoShapeData[offset] = frame / oscFrames;
+		if( ++frame >= m_lfoOscillationFrames )
+		{
+			frame = 0;
+		}
+	}
+
+	sample_t * buf = m_lfoShapeData;
+	const float amount = m_lfoAmount;
+	switch( m_lfoWaveModel.value() )
 	{
 		case TriangleWave:
-			shape_sample = Oscillator::triangleSample( phase );
+			for( fpp_t offset = 0; offset < frames; ++offset )
+			{
+				buf[offset] = Oscillator::triangleSample(
+							buf[offset] ) * amount;
+			}
 			break;
 		case SquareWave:
-			shape_sample = Oscillator::squareSample( phase );
+			for( fpp_t offset = 0; offset < frames; ++offset )
+			{
+				buf[offset] = Oscillator::squareSample(
+							buf[offset] ) * amount;
+			}
 			break;
 		case SawWave:
-			shape_sample = Oscillator::sawSample( phase );
+			for( fpp_t offset = 0; offset < frames; ++offset )
+			{
+				buf[offset] = Oscillator::sawSample(
+							buf[offset] ) * amount;
+			}
 			break;
 		case UserDefinedWave:
-			shape_sample = m_userWave.userWaveSample( phase );
+			for( fpp_t offset = 0; offset < frames; ++offset )
+			{
+				buf[offset] = m_userWave.userWaveSample(
+							buf[offset] ) * amount;
+			}
 			break;
 		case SineWave:
 		default:
-			shape_sample = Oscillator::sinSample( phase );
+			for( fpp_t offset = 0; offset < frames; ++offset )
+			{
+				buf[offset] = Oscillator::sinSample(
+							buf[offset] ) * amount;
+			}
 			break;
 	}
-	return shape_sample * m_lfoAmount;
-}
-
-
-
-
-void EnvelopeAndLfoParameters::updateLfoShapeData()
-{
-	const fpp_t frames = engine::mixer()->framesPerPeriod();
-	for( fpp_t offset = 0; offset < frames; ++offset )
-	{
-		m_lfoShapeData[offset] = lfoShapeSample( offset );
-	}
-	m_bad_lfoShapeData = false;
 }
 
 
@@ -256,11 +290,6 @@ inline void EnvelopeAndLfoParameters::fillLfoLevel( float * _buf,
 	}
 	_frame -= m_lfoPredelayFrames;
 
-	if( m_bad_lfoShapeData )
-	{
-		updateLfoShapeData();
-	}
-
 	fpp_t offset = 0;
 	const float lafI = 1.0f / m_lfoAttackFrames;
 	for( ; offset < _frames && _frame < m_lfoAttackFrames; ++offset,
@@ -277,6 +306,33 @@ inline void EnvelopeAndLfoParameters::fillLfoLevel( float * _buf,
 
 
 
+inline float EnvelopeAndLfoParameters::pahdLevel( f_cnt_t _frame ) const
+{
+	if( _frame < m_predelayFrames )
+	{
+		return m_amountAdd;
+	}
+	_frame -= m_predelayFrames;
+	if( _frame < m_attackFrames )
+	{
+		return _frame * m_attackStep + m_amountAdd;
+	}
+	_frame -= m_attackFrames;
+	if( _frame < m_holdFrames )
+	{
+		return m_peakLevel;
+	}
+	_frame -= m_holdFrames;
+	if( _frame < m_decayFrames )
+	{
+		return m_peakLevel + _frame * m_decayStep;
+	}
+	return m_sustainLevel;
+}
+
+
+
+
 void EnvelopeAndLfoParameters::fillLevel( float * _buf, f_cnt_t _frame,
 						const f_cnt_t _release_begin,
 						const fpp_t _frames )
@@ -288,35 +344,82 @@ void EnvelopeAndLfoParameters::fillLevel( float * _buf, f_cnt_t _frame,
 
 	fillLfoLevel( _buf, _frame, _frames );
 
-	for( fpp_t offset = 0; offset < _frames; ++offset, ++_buf, ++_frame )
+	const bool controlEnvAmount = m_controlEnvAmountModel.value();
+
+	fpp_t offset = 0;
+	while( offset < _frames )
 	{
-		float env_level;
+		// find out which segment we're in, the level at its current
+		// position and how many frames of it are left in this period
+		f_cnt_t todo = _frames - offset;
+		float level;
+		float step = 0.0f;
 		if( _frame < _release_begin )
 		{
-			if( _frame < m_pahdFrames )
+			todo = qMin( todo, _release_begin - _frame );
+			const f_cnt_t attackEnd = m_predelayFrames +
+								m_attackFrames;
+			const f_cnt_t holdEnd = attackEnd + m_holdFrames;
+			if( _frame < m_predelayFrames )
+			{
+				todo = qMin( todo, m_predelayFrames - _frame );
+				level = m_amountAdd;
+			}
+			else if( _frame < attackEnd )
+			{
+				todo = qMin( todo, attackEnd - _frame );
+				level = pahdLevel( _frame );
+				step = m_attackStep;
+			}
+			else if( _frame < holdEnd )
+			{
+				todo = qMin( todo, holdEnd - _frame );
+				level = m_peakLevel;
+			}
+			else if( _frame < m_pahdFrames )
 			{
-				env_level = m_pahdEnv[_frame];
+				todo = qMin( todo, m_pahdFrames - _frame );
+				level = pahdLevel( _frame );
+				step = m_decayStep;
 			}
 			else
 			{
-				env_level = m_sustainLevel;
+				level = m_sustainLevel;
 			}
 		}
 		else if( ( _frame - _release_begin ) < m_rFrames )
 		{
-			env_level = m_rEnv[_frame - _release_begin] *
-				( ( _release_begin < m_pahdFrames ) ?
-				m_pahdEnv[_release_begin] : m_sustainLevel );
+			const f_cnt_t r = _frame - _release_begin;
+			todo = qMin( todo, m_rFrames - r );
+			const float releaseFrom = pahdLevel( _release_begin );
+			level = ( m_rFrames - r ) * m_releaseStep * releaseFrom;
+			step = -m_releaseStep * releaseFrom;
 		}
 		else
 		{
-			env_level = 0.0f;
+			level = 0.0f;
 		}
 
 		// at this point, *_buf is LFO level
-		*_buf = m_controlEnvAmountModel.value() ?
-			env_level * ( 0.5f + *_buf ) :
-			env_level + *_buf;
+		if( controlEnvAmount )
+		{
+			for( f_cnt_t i = 0; i < todo; ++i )
+			{
+				_buf[i] = ( level + i * step ) *
+							( 0.5f + _buf[i] );
+			}
+		}
+		else
+		{
+			for( f_cnt_t i = 0; i < todo; ++i )
+			{
+				_buf[i] = level + i * step + _buf[i];
+			}
+		}
+
+		_buf += todo;
+		_frame += todo;
+		offset += todo;
 	}
 }
 
@@ -433,51 +536,18 @@ void EnvelopeAndLfoParameters::updateSampleVars()
 		m_rFrames = 0;
 	}
 
-	delete[] m_pahdEnv;
-	delete[] m_rEnv;
-
-	m_pahdEnv = new sample_t[m_pahdFrames];
-	m_rEnv = new sample_t[m_rFrames];
-
-	const float aa = m_amountAdd;
-	for( f_cnt_t i = 0; i < predelay_frames; ++i )
-	{
-		m_pahdEnv[i] = aa;
-	}
-
-	f_cnt_t add = predelay_frames;
+	m_predelayFrames = predelay_frames;
+	m_attackFrames = attack_frames;
+	m_holdFrames = hold_frames;
+	m_decayFrames = decay_frames;
 
-	const float afI = ( 1.0f / attack_frames ) * m_amount;
-	for( f_cnt_t i = 0; i < attack_frames; ++i )
-	{
-		m_pahdEnv[add+i] = i * afI + aa;
-	}
-
-	add += attack_frames;
-	const float amsum = m_amount + m_amountAdd;
-	for( f_cnt_t i = 0; i < hold_frames; ++i )
-	{
-		m_pahdEnv[add + i] = amsum;
-	}
-
-	add += hold_frames;
-	const float dfI = ( 1.0 / decay_frames ) * ( m_sustainLevel -1 ) * m_amount;
-	for( f_cnt_t i = 0; i < decay_frames; ++i )
-	{
-/*
-		m_pahdEnv[add + i] = ( m_sustainLevel + ( 1.0f -
-						(float)i / decay_frames ) *
-						( 1.0f - m_sustainLevel ) ) *
-							m_amount + m_amountAdd;
-*/
-		m_pahdEnv[add + i] = amsum + i*dfI;
-	}
-
-	const float rfI = ( 1.0f / m_rFrames ) * m_amount;
-	for( f_cnt_t i = 0; i < m_rFrames; ++i )
-	{
-		m_rEnv[i] = (float)( m_rFrames - i ) * rfI;
-	}
+	m_peakLevel = m_amount + m_amountAdd;
+	m_attackStep = attack_frames > 0 ?
+				( 1.0f / attack_frames ) * m_amount : 0.0f;
+	m_decayStep = decay_frames > 0 ? ( 1.0f / decay_frames ) *
+				( m_sustainLevel - 1 ) * m_amount : 0.0f;
+	m_releaseStep = m_rFrames > 0 ?
+				( 1.0f / m_rFrames ) * m_amount : 0.0f;
 
 	// save this calculation in real-time-part
 	m_sustainLevel = m_sustainLevel * m_amount + m_amountAdd;
@@ -512,8 +582,6 @@ void EnvelopeAndLfoParameters::updateSampleVars()
 		m_lfoAmountIsZero = false;
 	}
 
-	m_bad_lfoShapeData = true;
-
 	emit dataChanged();
 
 	engine::mixer()->unlock();
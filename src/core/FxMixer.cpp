@@ -30,20 +30,27 @@
 #include "song.h"
 
 
+FxSend::FxSend( fx_ch_t _target, float _amount, Model * _parent ) :
+	m_target( _target ),
+	m_amountModel( _amount, 0.0, 2.0, 0.01, _parent )
+{
+}
+
+
+
+
 FxChannel::FxChannel( Model * _parent ) :
 	m_fxChain( NULL ),
 	m_used( false ),
 	m_stillRunning( false ),
 	m_peakLeft( 0.0f ),
 	m_peakRight( 0.0f ),
-	m_buffer( new sampleFrame[engine::mixer()->framesPerPeriod()] ),
+	m_buffer( NULL ),
 	m_muteModel( false, _parent ),
 	m_volumeModel( 1.0, 0.0, 2.0, 0.01, _parent ),
 	m_name(),
 	m_lock()
 {
-	engine::mixer()->clearAudioBuffer( m_buffer,
-					engine::mixer()->framesPerPeriod() );
 }
 
 
@@ -51,6 +58,10 @@ FxChannel::FxChannel( Model * _parent ) :
 
 FxChannel::~FxChannel()
 {
+	for( FxSendVector::Iterator it = m_sends.begin(); it != m_sends.end(); ++it )
+	{
+		delete *it;
+	}
 	delete[] m_buffer;
 }
 
@@ -61,12 +72,16 @@ FxChannel::~FxChannel()
 
 FxMixer::FxMixer() :
 	JournallingObject(),
-	Model( NULL )
+	Model( NULL ),
+	m_numLevels( 0 )
 {
-	for( int i = 0; i < NumFxChannels+1; ++i )
-	{
-		m_fxChannels[i] = new FxChannel( this );
-	}
+	// master channel always exists and always has a buffer
+	m_fxChannels.push_back( new FxChannel( this ) );
+	m_fxChannels[0]->m_buffer =
+			new sampleFrame[engine::mixer()->framesPerPeriod()];
+	engine::mixer()->clearAudioBuffer( m_fxChannels[0]->m_buffer,
+					engine::mixer()->framesPerPeriod() );
+
 	// reset name etc.
 	clear();
 }
@@ -76,25 +91,106 @@ FxMixer::FxMixer() :
 
 FxMixer::~FxMixer()
 {
-	for( int i = 0; i < NumFxChannels+1; ++i )
+	for( int i = 0; i < m_fxChannels.size(); ++i )
 	{
 		delete m_fxChannels[i];
 	}
+	for( int i = 0; i < m_bufferPool.size(); ++i )
+	{
+		delete[] m_bufferPool[i];
+	}
+}
+
+
+
+
+fx_ch_t FxMixer::createChannel()
+{
+	FxChannel * ch = new FxChannel( this );
+
+	engine::mixer()->lock();
+	m_fxChannels.push_back( ch );
+	const fx_ch_t index = m_fxChannels.size() - 1;
+	resetChannel( index );
+	engine::mixer()->unlock();
+
+	emit dataChanged();
+
+	return index;
+}
+
+
+
+
+bool FxMixer::ensureChannelExists( int _ch )
+{
+	if( _ch < 0 )
+	{
+		return false;
+	}
+	while( _ch >= m_fxChannels.size() )
+	{
+		createChannel();
+	}
+	return true;
+}
+
+
+
+
+void FxMixer::activateChannel( fx_ch_t _ch )
+{
+	m_activeChannelsLock.lock();
+	if( m_bufferPool.isEmpty() )
+	{
+		sampleFrame * buf =
+			new sampleFrame[engine::mixer()->framesPerPeriod()];
+		engine::mixer()->clearAudioBuffer( buf,
+					engine::mixer()->framesPerPeriod() );
+		m_fxChannels[_ch]->m_buffer = buf;
+	}
+	else
+	{
+		// buffers in pool have been cleared when being released
+		m_fxChannels[_ch]->m_buffer = m_bufferPool.last();
+		m_bufferPool.pop_back();
+	}
+	// capacity has been reserved in updateLevels()
+	m_activeChannels[m_levels[_ch]].push_back( _ch );
+	m_activeChannelsLock.unlock();
 }
 
 
 
 
 void FxMixer::mixToChannel( const sampleFrame * _buf, fx_ch_t _ch )
+{
+	// route to master if channel doesn't exist (anymore)
+	if( _ch >= m_fxChannels.size() )
+	{
+		_ch = 0;
+	}
+
+	addToChannel( _buf, _ch, 1.0f );
+}
+
+
+
+
+void FxMixer::addToChannel( const sampleFrame * _buf, fx_ch_t _ch, float _gain )
 {
 	if( m_fxChannels[_ch]->m_muteModel.value() == false )
 	{
 		m_fxChannels[_ch]->m_lock.lock();
+		if( m_fxChannels[_ch]->m_buffer == NULL )
+		{
+			activateChannel( _ch );
+		}
 		sampleFrame * buf = m_fxChannels[_ch]->m_buffer;
 		for( f_cnt_t f = 0; f < engine::mixer()->framesPerPeriod(); ++f )
 		{
-			buf[f][0] += _buf[f][0];
-			buf[f][1] += _buf[f][1];
+			buf[f][0] += _buf[f][0] * _gain;
+			buf[f][1] += _buf[f][1] * _gain;
 		}
 		m_fxChannels[_ch]->m_used = true;
 		m_fxChannels[_ch]->m_lock.unlock();
@@ -137,10 +233,32 @@ void FxMixer::processChannel( fx_ch_t _ch, sampleFrame * _buf )
 		}
 
 		m_fxChannels[_ch]->m_used = true;
+
+		// pass output on to all channels we're sending to - master
+		// is processed separately in masterMix()
+		if( _ch != 0 )
+		{
+			const float v = m_fxChannels[_ch]->m_volumeModel.value();
+			const FxSendVector & sends = m_fxChannels[_ch]->m_sends;
+			for( FxSendVector::ConstIterator it = sends.begin(); it != sends.end(); ++it )
+			{
+				addToChannel( _buf, ( *it )->m_target, v * ( *it )->m_amountModel.value() );
+			}
+			engine::mixer()->clearAudioBuffer( _buf, f );
+		}
 	}
 	else
 	{
 		m_fxChannels[_ch]->m_peakLeft = m_fxChannels[_ch]->m_peakRight = 0.0f; 
+		// effects of muted channels are not processed so there's no
+		// tail we would have to wait for
+		m_fxChannels[_ch]->m_stillRunning = false;
+		// discard what has been mixed in before channel was muted
+		if( _ch != 0 && m_fxChannels[_ch]->m_used )
+		{
+			engine::mixer()->clearAudioBuffer( m_fxChannels[_ch]->m_buffer,
+						engine::mixer()->framesPerPeriod() );
+		}
 	}
 }
 
@@ -158,23 +276,35 @@ void FxMixer::prepareMasterMix()
 
 void FxMixer::masterMix( sampleFrame * _buf )
 {
-	const int fpp = engine::mixer()->framesPerPeriod();
-	memcpy( _buf, m_fxChannels[0]->m_buffer, sizeof( sampleFrame ) * fpp );
+	memcpy( _buf, m_fxChannels[0]->m_buffer,
+			sizeof( sampleFrame ) * engine::mixer()->framesPerPeriod() );
 
-	for( int i = 1; i < NumFxChannels+1; ++i )
+	// all channels have been processed and sent their output to other
+	// channels (and finally master) already
+	for( int level = 0; level < m_activeChannels.size(); ++level )
 	{
-		if( m_fxChannels[i]->m_used )
+		QVector<fx_ch_t> & channels = m_activeChannels[level];
+		for( int i = 0; i < channels.size(); )
 		{
-			sampleFrame * ch_buf = m_fxChannels[i]->m_buffer;
-			const float v = m_fxChannels[i]->m_volumeModel.value();
-			for( f_cnt_t f = 0; f < fpp; ++f )
+			FxChannel * ch = m_fxChannels[channels[i]];
+			const bool used = ch->m_used;
+			ch->m_used = false;
+
+			// channel neither received audio nor has effects which
+			// are still running? then give its (cleared) buffer back
+			// to pool
+			if( !used && !ch->m_stillRunning )
 			{
-				_buf[f][0] += ch_buf[f][0] * v;
-				_buf[f][1] += ch_buf[f][1] * v;
+				ch->m_lock.lock();
+				m_bufferPool.push_back( ch->m_buffer );
+				ch->m_buffer = NULL;
+				ch->m_lock.unlock();
+				channels.remove( i );
+			}
+			else
+			{
+				++i;
 			}
-			engine::mixer()->clearAudioBuffer( ch_buf,
-					engine::mixer()->framesPerPeriod() );
-			m_fxChannels[i]->m_used = false;
 		}
 	}
 
@@ -203,17 +333,206 @@ void FxMixer::masterMix( sampleFrame * _buf )
 
 void FxMixer::clear()
 {
-	for( int i = 0; i <= NumFxChannels; ++i )
+	engine::mixer()->lock();
+	while( m_fxChannels.size() > 1 )
+	{
+		delete m_fxChannels.last();
+		m_fxChannels.pop_back();
+	}
+	for( int level = 0; level < m_activeChannels.size(); ++level )
+	{
+		m_activeChannels[level].clear();
+	}
+	engine::mixer()->unlock();
+
+	resetChannel( 0 );
+
+	emit dataChanged();
+}
+
+
+
+
+void FxMixer::resetChannel( int _ch )
+{
+	// by default every channel is sent to master
+	engine::mixer()->lock();
+	clearSends( _ch );
+	if( _ch != 0 )
 	{
-		m_fxChannels[i]->m_fxChain.clear();
-		m_fxChannels[i]->m_volumeModel.setValue( 1.0f );
-		m_fxChannels[i]->m_muteModel.setValue( false );
-		m_fxChannels[i]->m_name = ( i == 0 ) ?
-				tr( "Master" ) : tr( "FX %1" ).arg( i );
-		m_fxChannels[i]->m_volumeModel.setDisplayName( 
-				m_fxChannels[i]->m_name );
+		m_fxChannels[_ch]->m_sends.push_back( new FxSend( 0, 1.0f, this ) );
+	}
+	updateLevels();
+	engine::mixer()->unlock();
+
+	m_fxChannels[_ch]->m_fxChain.clear();
+	m_fxChannels[_ch]->m_volumeModel.setValue( 1.0f );
+	m_fxChannels[_ch]->m_muteModel.setValue( false );
+	m_fxChannels[_ch]->m_name = ( _ch == 0 ) ?
+			tr( "Master" ) : tr( "FX %1" ).arg( _ch );
+	m_fxChannels[_ch]->m_volumeModel.setDisplayName(
+			m_fxChannels[_ch]->m_name );
+}
 
+
+
+
+void FxMixer::clearSends( int _ch )
+{
+	FxSendVector & sends = m_fxChannels[_ch]->m_sends;
+	for( FxSendVector::Iterator it = sends.begin(); it != sends.end(); ++it )
+	{
+		delete *it;
 	}
+	sends.clear();
+}
+
+
+
+
+bool FxMixer::isRoutedTo( fx_ch_t _from, fx_ch_t _to ) const
+{
+	if( _from == _to )
+	{
+		return true;
+	}
+
+	const FxSendVector & sends = m_fxChannels[_from]->m_sends;
+	for( FxSendVector::ConstIterator it = sends.begin(); it != sends.end(); ++it )
+	{
+		if( isRoutedTo( ( *it )->m_target, _to ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
+bool FxMixer::addSend( fx_ch_t _from, fx_ch_t _to, float _amount )
+{
+	// master can't be sent anywhere
+	if( _from == 0 || _from >= m_fxChannels.size() ||
+						_to >= m_fxChannels.size() )
+	{
+		return false;
+	}
+
+	FxSendVector & sends = m_fxChannels[_from]->m_sends;
+	for( FxSendVector::Iterator it = sends.begin(); it != sends.end(); ++it )
+	{
+		if( ( *it )->m_target == _to )
+		{
+			return true;
+		}
+	}
+
+	// would we create a feedback loop?
+	if( isRoutedTo( _to, _from ) )
+	{
+		return false;
+	}
+
+	engine::mixer()->lock();
+	sends.push_back( new FxSend( _to, _amount, this ) );
+	updateLevels();
+	engine::mixer()->unlock();
+
+	emit dataChanged();
+
+	return true;
+}
+
+
+
+
+void FxMixer::removeSend( fx_ch_t _from, fx_ch_t _to )
+{
+	if( _from >= m_fxChannels.size() )
+	{
+		return;
+	}
+
+	engine::mixer()->lock();
+	FxSendVector & sends = m_fxChannels[_from]->m_sends;
+	for( FxSendVector::Iterator it = sends.begin(); it != sends.end(); ++it )
+	{
+		if( ( *it )->m_target == _to )
+		{
+			delete *it;
+			sends.erase( it );
+			break;
+		}
+	}
+	updateLevels();
+	engine::mixer()->unlock();
+
+	emit dataChanged();
+}
+
+
+
+
+void FxMixer::updateLevels()
+{
+	QVector<int> levels( m_fxChannels.size(), -1 );
+	m_numLevels = 0;
+	for( int i = 1; i < m_fxChannels.size(); ++i )
+	{
+		m_numLevels = qMax( m_numLevels, calculateLevel( i, levels ) + 1 );
+	}
+	m_levels = levels;
+
+	// move active channels to their new levels - reserve space for all
+	// channels on each level so activating channels doesn't allocate
+	QVector<fx_ch_t> active;
+	for( int level = 0; level < m_activeChannels.size(); ++level )
+	{
+		active += m_activeChannels[level];
+	}
+	m_activeChannels.resize( m_numLevels );
+	for( int level = 0; level < m_numLevels; ++level )
+	{
+		m_activeChannels[level].clear();
+		m_activeChannels[level].reserve( m_fxChannels.size() );
+	}
+	for( int i = 0; i < active.size(); ++i )
+	{
+		if( active[i] < m_fxChannels.size() )
+		{
+			m_activeChannels[m_levels[active[i]]].push_back( active[i] );
+		}
+	}
+}
+
+
+
+
+int FxMixer::calculateLevel( fx_ch_t _ch, QVector<int> & _levels ) const
+{
+	if( _levels[_ch] >= 0 )
+	{
+		return _levels[_ch];
+	}
+
+	// a channel has to be processed after all channels sending to it
+	int level = 0;
+	for( int i = 1; i < m_fxChannels.size(); ++i )
+	{
+		const FxSendVector & sends = m_fxChannels[i]->m_sends;
+		for( FxSendVector::ConstIterator it = sends.begin(); it != sends.end(); ++it )
+		{
+			if( ( *it )->m_target == _ch )
+			{
+				level = qMax( level, calculateLevel( i, _levels ) + 1 );
+			}
+		}
+	}
+
+	_levels[_ch] = level;
+	return level;
 }
 
 
@@ -221,7 +540,7 @@ void FxMixer::clear()
 
 void FxMixer::saveSettings( QDomDocument & _doc, QDomElement & _this )
 {
-	for( int i = 0; i <= NumFxChannels; ++i )
+	for( int i = 0; i < m_fxChannels.size(); ++i )
 	{
 		QDomElement fxch = _doc.createElement( QString( "fxchannel" ) );
 		_this.appendChild( fxch );
@@ -232,6 +551,15 @@ void FxMixer::saveSettings( QDomDocument & _doc, QDomElement & _this )
 								"muted" );
 		fxch.setAttribute( "num", i );
 		fxch.setAttribute( "name", m_fxChannels[i]->m_name );
+
+		const FxSendVector & sends = m_fxChannels[i]->m_sends;
+		for( FxSendVector::ConstIterator it = sends.begin(); it != sends.end(); ++it )
+		{
+			QDomElement send = _doc.createElement( "send" );
+			fxch.appendChild( send );
+			send.setAttribute( "channel", ( *it )->m_target );
+			( *it )->m_amountModel.saveSettings( _doc, send, "amount" );
+		}
 	}
 }
 
@@ -240,21 +568,64 @@ void FxMixer::saveSettings( QDomDocument & _doc, QDomElement & _this )
 
 void FxMixer::loadSettings( const QDomElement & _this )
 {
-	clear();
+	// channels might have been created already by tracks referring to
+	// them, so just reset them instead of calling clear()
+	for( int i = 0; i < m_fxChannels.size(); ++i )
+	{
+		resetChannel( i );
+	}
+
 	QDomNode node = _this.firstChild();
-	for( int i = 0; i <= NumFxChannels; ++i )
+	while( !node.isNull() )
 	{
 		QDomElement fxch = node.toElement();
+		if( fxch.isNull() || fxch.tagName() != "fxchannel" )
+		{
+			node = node.nextSibling();
+			continue;
+		}
 		int num = fxch.attribute( "num" ).toInt();
+		if( !ensureChannelExists( num ) )
+		{
+			node = node.nextSibling();
+			continue;
+		}
 		m_fxChannels[num]->m_fxChain.restoreState(
 			fxch.firstChildElement(
 				m_fxChannels[num]->m_fxChain.nodeName() ) );
 		m_fxChannels[num]->m_volumeModel.loadSettings( fxch, "volume" );
 		m_fxChannels[num]->m_muteModel.loadSettings( fxch, "muted" );
 		m_fxChannels[num]->m_name = fxch.attribute( "name" );
+
+		// projects created before sends were introduced don't have
+		// any, so keep default routing to master for them
+		QDomElement send = fxch.firstChildElement( "send" );
+		if( !send.isNull() )
+		{
+			engine::mixer()->lock();
+			clearSends( num );
+			updateLevels();
+			engine::mixer()->unlock();
+		}
+		for( ; !send.isNull(); send = send.nextSiblingElement( "send" ) )
+		{
+			const int target = send.attribute( "channel" ).toInt();
+			if( ensureChannelExists( target ) &&
+						addSend( num, target ) )
+			{
+				FxSendVector & sends = m_fxChannels[num]->m_sends;
+				for( FxSendVector::Iterator it = sends.begin(); it != sends.end(); ++it )
+				{
+					if( ( *it )->m_target == target )
+					{
+						( *it )->m_amountModel.loadSettings( send, "amount" );
+					}
+				}
+			}
+		}
+
 		node = node.nextSibling();
 	}
 
 	emit dataChanged();
 }
-
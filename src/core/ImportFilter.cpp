@@ -28,6 +28,7 @@
 #include "ImportFilter.h"
 #include "engine.h"
 #include "TrackContainer.h"
+#include "PluginManifest.h"
 #include "ProjectJournal.h"
 
 
@@ -52,8 +53,7 @@ ImportFilter::~ImportFilter()
 void ImportFilter::import( const QString & _file_to_import,
 							TrackContainer* tc )
 {
-	DescriptorList d;
-	Plugin::getDescriptorsOfAvailPlugins( d );
+	const PluginManifest::EntryList & d = PluginManifest::entries();
 
 	bool successful = false;
 
@@ -63,7 +63,7 @@ void ImportFilter::import( const QString & _file_to_import,
 	const bool j = engine::projectJournal()->isJournalling();
 	engine::projectJournal()->setJournalling( false );
 
-	for( Plugin::DescriptorList::ConstIterator it = d.begin();
+	for( PluginManifest::EntryList::ConstIterator it = d.begin();
 												it != d.end(); ++it )
 	{
 		if( it->type == Plugin::ImportFilter )
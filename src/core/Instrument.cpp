@@ -33,7 +33,9 @@
 Instrument::Instrument( InstrumentTrack * _instrument_track,
 					const Descriptor * _descriptor ) :
 	Plugin( _descriptor, NULL/* _instrument_track*/ ),
-	m_instrumentTrack( _instrument_track )
+	m_instrumentTrack( _instrument_track ),
+	m_sleeping( false ),
+	m_idlePeriods( 0 )
 {
 }
 
@@ -69,6 +71,35 @@ f_cnt_t Instrument::beatLen( NotePlayHandle * ) const
 
 
 
+void Instrument::updateSleepState( bool _silent )
+{
+	// number of silent periods without active voices after which we stop
+	// calling play() - we need at least two as a note-on may be processed
+	// in parallel to the period in which we're checking
+	const int IdlePeriodsBeforeSleep = 2;
+
+	if( _silent == false )
+	{
+		m_idlePeriods = 0;
+		return;
+	}
+
+	// only ask instrument for active voices while its output is silent
+	if( isIdle() == false )
+	{
+		m_idlePeriods = 0;
+		return;
+	}
+
+	if( ++m_idlePeriods >= IdlePeriodsBeforeSleep )
+	{
+		m_sleeping = true;
+	}
+}
+
+
+
+
 Instrument * Instrument::instantiate( const QString & _plugin_name,
 					InstrumentTrack * _instrument_track )
 {
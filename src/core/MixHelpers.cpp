@@ -69,6 +69,30 @@ bool isSilent( const sampleFrame* src, int frames )
 }
 
 
+
+double energy( const sampleFrame* src, int frames )
+{
+	// accumulate in blocks of floats so the inner loop can be vectorized,
+	// but keep the total in double precision
+	const int BlockSize = 64;
+
+	double sum = 0.0;
+	for( int offset = 0; offset < frames; offset += BlockSize )
+	{
+		const int end = offset + BlockSize < frames ? offset + BlockSize : frames;
+		float blockSum = 0.0f;
+		for( int i = offset; i < end; ++i )
+		{
+			blockSum += src[i][0]*src[i][0] + src[i][1]*src[i][1];
+		}
+		sum += blockSum;
+	}
+
+	return sum;
+}
+
+
+
 struct AddOp
 {
 	void operator()( sampleFrame& dst, const sampleFrame& src ) const
@@ -25,6 +25,7 @@
 #include <math.h>
 
 #include "Mixer.h"
+#include "AudioPort.h"
 #include "FxMixer.h"
 #include "MixHelpers.h"
 #include "song.h"
@@ -40,6 +41,10 @@
 #include "MicroTimer.h"
 #include "atomic_int.h"
 
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QThreadStorage>
+#include <QtCore/QVarLengthArray>
+
 // platform-specific audio-interface-classes
 #include "AudioAlsa.h"
 #include "AudioJack.h"
@@ -57,7 +62,10 @@
 #include "MidiDummy.h"
 
 
-static QVector<fx_ch_t> __fx_channel_jobs( NumFxChannels );
+// number of finished play-handles which can wait for deletion - if more
+// play-handles finish before the reclaimer gets to them, they're deleted
+// right away
+static const int PlayHandlesToDeleteRingSize = 4096;
 
 
 
@@ -99,9 +107,29 @@ public:
 		PlayHandle,
 		AudioPortEffects,
 		EffectChannel,
+		LfoShape,
+		ParallelTask,
 		NumJobTypes
 	} ;
 
+	// set of tasks submitted by Mixer::runParallel() - lives on the stack
+	// of the submitting thread until all tasks are done, which sleeps on
+	// s_parallelJobDone meanwhile
+	struct ParallelJob
+	{
+		ParallelJob( Mixer::ParallelJobFunc _func, void * _context,
+								int _count ) :
+			func( _func ),
+			context( _context ),
+			remaining( _count )
+		{
+		}
+
+		Mixer::ParallelJobFunc func;
+		void * context;
+		AtomicInt remaining;
+	} ;
+
 	struct JobQueueItem
 	{
 		JobQueueItem() :
@@ -136,11 +164,45 @@ public:
 		}
 
 		JobQueueItem items[JOB_QUEUE_SIZE];
-		int queueSize;
+		// can grow while jobs are running (see Mixer::runParallel())
+		volatile int queueSize;
 		AtomicInt itemsDone;
 	} ;
 
+	// output of a single play handle job - every job mixes into its own
+	// slot so the slots can be summed up in job order afterwards, no
+	// matter which worker rendered which note
+	struct OutputSlot
+	{
+		OutputSlot() :
+			port( NULL ),
+			first( NULL ),
+			second( NULL ),
+			usage( AudioPort::NoUsage ),
+			prevSlot( -1 )
+		{
+		}
+
+		AudioPort * port;
+		sampleFrame * first;
+		sampleFrame * second;
+		AudioPort::bufferUsages usage;
+		// slot claimed for the same port before this one (-1 = none) so
+		// merging a port only has to visit the slots it actually used
+		int prevSlot;
+	} ;
+
 	static JobQueue s_jobQueue;
+	static QMutex s_jobQueueAppendMutex;
+	static QMutex s_parallelJobMutex;
+	static QWaitCondition s_parallelJobDone;
+	static QThreadStorage<int *> s_currentWorkerNum;
+
+	static QVector<OutputSlot> s_outputSlots;
+	// slot of first job in queue and number of slots used in this period
+	static int s_outputSlotBase;
+	static int s_numOutputSlots;
+	static QThreadStorage<int *> s_currentOutputSlot;
 
 	MixerWorkerThread( int _worker_num, Mixer* mixer ) :
 		QThread( mixer ),
@@ -169,6 +231,46 @@ public:
 		return m_workerNum;
 	}
 
+	// returns number of worker whose job queue is processed by calling
+	// thread or -1 if not called from within processJobQueue()
+	static int currentWorkerNum()
+	{
+		return s_currentWorkerNum.hasLocalData() ?
+					*s_currentWorkerNum.localData() : -1;
+	}
+
+	// returns slot of play handle job currently rendered by calling thread
+	// or -1 if not called from within a play handle job
+	static int currentOutputSlot()
+	{
+		return s_currentOutputSlot.hasLocalData() ?
+					*s_currentOutputSlot.localData() : -1;
+	}
+
+	// called by mixer thread before filling job queue with play handles
+	static void resetOutputSlots();
+	static void prepareOutputSlots( int _frames );
+
+	// adds output of all play handle jobs for given port to its buffers
+	// in job order
+	static void mergeOutputSlots( AudioPort * _port, int _frames );
+
+	// runs a claimed task of Mixer::runParallel() and wakes up the
+	// submitting thread if it was the last one of its job
+	static void runParallelTask( JobQueueItem * _item )
+	{
+		ParallelJob * job = (ParallelJob *) _item->job;
+		job->func( job->context, _item->param );
+		// job may be gone as soon as this reaches zero and the mutex
+		// is released so don't touch it afterwards
+		s_parallelJobMutex.lock();
+		if( job->remaining.fetchAndAddOrdered( -1 ) == 1 )
+		{
+			s_parallelJobDone.wakeAll();
+		}
+		s_parallelJobMutex.unlock();
+	}
+
 
 private:
 	virtual void run()
@@ -203,11 +305,34 @@ private:
 
 
 MixerWorkerThread::JobQueue MixerWorkerThread::s_jobQueue;
+QMutex MixerWorkerThread::s_jobQueueAppendMutex;
+QMutex MixerWorkerThread::s_parallelJobMutex;
+QWaitCondition MixerWorkerThread::s_parallelJobDone;
+QThreadStorage<int *> MixerWorkerThread::s_currentWorkerNum;
+QVector<MixerWorkerThread::OutputSlot> MixerWorkerThread::s_outputSlots;
+int MixerWorkerThread::s_outputSlotBase = 0;
+int MixerWorkerThread::s_numOutputSlots = 0;
+QThreadStorage<int *> MixerWorkerThread::s_currentOutputSlot;
 
 
 
 void MixerWorkerThread::processJobQueue()
 {
+	// the last worker is processed by the mixer thread which is not
+	// necessarily the same thread all the time (e.g. when exporting) so
+	// always (re)assign the worker number
+	if( !s_currentWorkerNum.hasLocalData() )
+	{
+		s_currentWorkerNum.setLocalData( new int );
+	}
+	*s_currentWorkerNum.localData() = m_workerNum;
+
+	if( !s_currentOutputSlot.hasLocalData() )
+	{
+		s_currentOutputSlot.setLocalData( new int( -1 ) );
+	}
+	int * outputSlot = s_currentOutputSlot.localData();
+
 	for( int i = 0; i < s_jobQueue.queueSize; ++i )
 	{
 		JobQueueItem * it = &s_jobQueue.items[i];
@@ -216,11 +341,17 @@ void MixerWorkerThread::processJobQueue()
 			switch( it->type )
 			{
 				case PlayHandle:
-					( (::PlayHandle *) it->job )->play( m_workingBuf );
+					{
+	const int prevOutputSlot = *outputSlot;
+	*outputSlot = s_outputSlotBase + i;
+	( (::PlayHandle *) it->job )->play( m_workingBuf );
+	*outputSlot = prevOutputSlot;
+					}
 					break;
 				case AudioPortEffects:
 					{
 	AudioPort * a = (AudioPort *) it->job;
+	mergeOutputSlots( a, m_mixer->framesPerPeriod() );
 	const bool me = a->processEffects();
 	if( me || a->m_bufferUsage != AudioPort::NoUsage )
 	{
@@ -232,19 +363,103 @@ void MixerWorkerThread::processJobQueue()
 				case EffectChannel:
 	engine::fxMixer()->processChannel( (fx_ch_t) it->param );
 					break;
+				case LfoShape:
+	( (EnvelopeAndLfoParameters *) it->job )->updateLfoShapeData();
+					break;
+				case ParallelTask:
+	runParallelTask( it );
+					break;
 				default:
 					break;
 			}
 			s_jobQueue.itemsDone.fetchAndAddOrdered( 1 );
 		}
 	}
+
+	*s_currentWorkerNum.localData() = -1;
+}
+
+void MixerWorkerThread::resetOutputSlots()
+{
+	// drop output of ports which have been removed in the meantime
+	for( int i = 0; i < s_numOutputSlots; ++i )
+	{
+		s_outputSlots[i].port = NULL;
+		s_outputSlots[i].usage = AudioPort::NoUsage;
+		s_outputSlots[i].prevSlot = -1;
+	}
+	s_outputSlotBase = 0;
+	s_numOutputSlots = 0;
 }
 
+
+
+
+void MixerWorkerThread::prepareOutputSlots( int _frames )
+{
+	s_outputSlotBase = s_numOutputSlots;
+	s_numOutputSlots += s_jobQueue.queueSize;
+
+	// slots are kept across periods so this only allocates while the
+	// number of simultaneously playing notes grows
+	const int oldSize = s_outputSlots.size();
+	if( oldSize < s_numOutputSlots )
+	{
+		s_outputSlots.resize( s_numOutputSlots );
+		for( int i = oldSize; i < s_numOutputSlots; ++i )
+		{
+			s_outputSlots[i].first = new sampleFrame[_frames];
+			s_outputSlots[i].second = new sampleFrame[_frames];
+		}
+	}
+}
+
+
+
+
+void MixerWorkerThread::mergeOutputSlots( AudioPort * _port, int _frames )
+{
+	// collect the slots which have been used for this port - they were
+	// claimed by concurrently running jobs, so restore job order first
+	QVarLengthArray<int, 64> usedSlots;
+	for( int i = _port->m_lastOutputSlot.fetchAndStoreOrdered( -1 );
+				i >= 0 && i < s_numOutputSlots &&
+					s_outputSlots[i].port == _port;
+					i = s_outputSlots[i].prevSlot )
+	{
+		usedSlots.append( i );
+	}
+	qSort( usedSlots.begin(), usedSlots.end() );
+
+	for( int i = 0; i < usedSlots.size(); ++i )
+	{
+		OutputSlot & s = s_outputSlots[usedSlots[i]];
+
+		MixHelpers::add( _port->m_firstBuffer, s.first, _frames );
+		if( s.usage == AudioPort::BothBuffers )
+		{
+			MixHelpers::add( _port->m_secondBuffer, s.second, _frames );
+			_port->m_bufferUsage = AudioPort::BothBuffers;
+		}
+		else if( _port->m_bufferUsage == AudioPort::NoUsage )
+		{
+			_port->m_bufferUsage = AudioPort::FirstBuffer;
+		}
+
+		s.port = NULL;
+		s.usage = AudioPort::NoUsage;
+		s.prevSlot = -1;
+	}
+}
+
+
+
+
 #define FILL_JOB_QUEUE_BEGIN(_vec_type,_vec,_condition)			\
 	MixerWorkerThread::s_jobQueue.queueSize = 0;			\
 	MixerWorkerThread::s_jobQueue.itemsDone = 0;			\
-	for( _vec_type::Iterator it = _vec.begin();			\
-					it != _vec.end(); ++it )	\
+	for( _vec_type::ConstIterator it = _vec.constBegin();		\
+					it != _vec.constEnd(); ++it )	\
 	{								\
 		if( _condition )					\
 		{
@@ -307,6 +522,10 @@ Mixer::Mixer() :
 	m_workers(),
 	m_numWorkers( QThread::idealThreadCount()-1 ),
 	m_queueReadyWaitCond(),
+	m_playHandlesToDelete( NULL ),
+	m_playHandlesToDeleteReadPos( 0 ),
+	m_playHandlesToDeleteWritePos( 0 ),
+	m_playHandleReclaimer( NULL ),
 	m_qualitySettings( qualitySettings::Mode_Draft ),
 	m_masterGain( 1.0f ),
 	m_audioDev( NULL ),
@@ -321,11 +540,6 @@ Mixer::Mixer() :
 		clearAudioBuffer( m_inputBuffer[i], m_inputBufferSize[i] );
 	}
 
-	for( int i = 1; i < NumFxChannels+1; ++i )
-	{
-		__fx_channel_jobs[i-1] = (fx_ch_t) i;
-	}
-
 	// just rendering?
 	if( !engine::hasGUI() )
 	{
@@ -383,6 +597,10 @@ Mixer::Mixer() :
 	m_poolDepth = 2;
 	m_readBuffer = 0;
 	m_writeBuffer = 1;
+
+	m_playHandlesToDelete = new PlayHandle *[PlayHandlesToDeleteRingSize];
+	m_playHandleReclaimer = new playHandleReclaimer( this );
+	m_playHandleReclaimer->start( QThread::LowPriority );
 }
 
 
@@ -403,12 +621,25 @@ Mixer::~Mixer()
 		m_workers[w]->wait( 500 );
 	}
 
+	m_playHandleReclaimer->finish();
+	m_playHandleReclaimer->wait();
+	delete m_playHandleReclaimer;
+	deleteUnlinkedPlayHandles();
+	delete[] m_playHandlesToDelete;
+
 	while( m_fifo->available() )
 	{
 		delete[] m_fifo->read();
 	}
 	delete m_fifo;
 
+	for( int i = 0; i < MixerWorkerThread::s_outputSlots.size(); ++i )
+	{
+		delete[] MixerWorkerThread::s_outputSlots[i].first;
+		delete[] MixerWorkerThread::s_outputSlots[i].second;
+	}
+	MixerWorkerThread::s_outputSlots.clear();
+
 	delete m_audioDev;
 	delete m_midiClient;
 
@@ -509,7 +740,9 @@ sample_rate_t Mixer::inputSampleRate() const
 
 sample_rate_t Mixer::processingSampleRate() const
 {
-	return outputSampleRate() * m_qualitySettings.sampleRateMultiplier();
+	// oversampling is only applied locally by effects and instruments
+	// which opt in (see Oversampler)
+	return outputSampleRate();
 }
 
 
@@ -582,8 +815,8 @@ const surroundSampleFrame * Mixer::renderNextBuffer()
 	// while we're acting...
 	lock();
 
-	// remove all play-handles that have to be deleted and delete
-	// them if they still exist...
+	// remove all play-handles that have to be deleted and schedule them
+	// for deletion if they still exist...
 	// maybe this algorithm could be optimized...
 	ConstPlayHandleList::Iterator it_rem = m_playHandlesToRemove.begin();
 	while( it_rem != m_playHandlesToRemove.end() )
@@ -592,7 +825,7 @@ const surroundSampleFrame * Mixer::renderNextBuffer()
 
 		if( it != m_playHandles.end() )
 		{
-			delete *it;
+			deletePlayHandle( *it );
 			m_playHandles.erase( it );
 		}
 
@@ -616,11 +849,61 @@ const surroundSampleFrame * Mixer::renderNextBuffer()
 	engine::getSong()->processNextBuffer();
 
 
+	// STAGE 0: compute shapes of all active LFOs for this period - notes
+	// only read them while rendering, so there's no need to recompute
+	// them per note and no race between worker threads
+	if( EnvelopeAndLfoParameters::instances() )
+	{
+		EnvelopeAndLfoParameters::LfoInstances::LfoList lfos =
+			EnvelopeAndLfoParameters::instances()->activeLfos();
+		if( !lfos.isEmpty() )
+		{
+			FILL_JOB_QUEUE(EnvelopeAndLfoParameters::LfoInstances::LfoList,lfos,
+						MixerWorkerThread::LfoShape,1);
+			START_JOBS();
+			WAIT_FOR_JOBS();
+		}
+	}
+
+
 	// STAGE 1: run and render all play handles
+	MixerWorkerThread::resetOutputSlots();
 	FILL_JOB_QUEUE(PlayHandleList,m_playHandles,MixerWorkerThread::PlayHandle, !( *it )->isFinished());
+	MixerWorkerThread::prepareOutputSlots( m_framesPerPeriod );
 	START_JOBS();
 	WAIT_FOR_JOBS();
 
+	// STAGE 1b: render sub-notes of chords and arpeggios as separate jobs so
+	// they're distributed over all worker threads - sub-notes can have
+	// sub-notes on their own, so continue until no more are left
+	PlayHandleList subPlayHandles;
+	for( PlayHandleList::Iterator it = m_playHandles.begin();
+						it != m_playHandles.end(); ++it )
+	{
+		( *it )->appendSubPlayHandles( subPlayHandles );
+	}
+	while( !subPlayHandles.isEmpty() )
+	{
+		FILL_JOB_QUEUE(PlayHandleList,subPlayHandles,MixerWorkerThread::PlayHandle,1);
+		MixerWorkerThread::prepareOutputSlots( m_framesPerPeriod );
+		START_JOBS();
+		WAIT_FOR_JOBS();
+
+		PlayHandleList nextSubPlayHandles;
+		for( PlayHandleList::Iterator it = subPlayHandles.begin();
+						it != subPlayHandles.end(); ++it )
+		{
+			( *it )->appendSubPlayHandles( nextSubPlayHandles );
+		}
+		subPlayHandles = nextSubPlayHandles;
+	}
+
+	for( PlayHandleList::Iterator it = m_playHandles.begin();
+						it != m_playHandles.end(); ++it )
+	{
+		( *it )->releaseFinishedSubPlayHandles();
+	}
+
 	// removed all play handles which are done
 	for( PlayHandleList::Iterator it = m_playHandles.begin();
 						it != m_playHandles.end(); )
@@ -633,7 +916,7 @@ const surroundSampleFrame * Mixer::renderNextBuffer()
 		}
 		if( ( *it )->isFinished() )
 		{
-			delete *it;
+			deletePlayHandle( *it );
 			it = m_playHandles.erase( it );
 		}
 		else
@@ -650,11 +933,23 @@ const surroundSampleFrame * Mixer::renderNextBuffer()
 	WAIT_FOR_JOBS();
 
 
-	// STAGE 3: process effects in FX mixer
-	FILL_JOB_QUEUE_PARAM(QVector<fx_ch_t>,__fx_channel_jobs,
+	// STAGE 3: process effects in FX mixer - only channels which received
+	// audio or have effects still running need to be processed; channels
+	// are processed level by level along the routing graph so every
+	// channel has received the output of all channels sending to it
+	for( int level = 0; level < engine::fxMixer()->numLevels(); ++level )
+	{
+		const QVector<fx_ch_t> & fxChannelJobs =
+				engine::fxMixer()->activeChannels( level );
+		if( fxChannelJobs.isEmpty() )
+		{
+			continue;
+		}
+		FILL_JOB_QUEUE_PARAM(QVector<fx_ch_t>,fxChannelJobs,
 					MixerWorkerThread::EffectChannel,1);
-	START_JOBS();
-	WAIT_FOR_JOBS();
+		START_JOBS();
+		WAIT_FOR_JOBS();
+	}
 
 
 	// STAGE 4: do master mix in FX mixer
@@ -666,7 +961,10 @@ const surroundSampleFrame * Mixer::renderNextBuffer()
 	emit nextAudioBuffer();
 
 	// and trigger LFOs
-	EnvelopeAndLfoParameters::instances()->trigger();
+	if( EnvelopeAndLfoParameters::instances() )
+	{
+		EnvelopeAndLfoParameters::instances()->trigger();
+	}
 	Controller::triggerFrameCounter();
 
 	const float new_cpu_load = timer.elapsed() / 10000.0f *
@@ -701,35 +999,90 @@ void Mixer::clear()
 
 
 
+// adds given buffer to the first buffer and the part exceeding current period
+// to the second buffer - returns whether the second buffer has been touched
+static bool addToPortBuffers( sampleFrame * _first, sampleFrame * _second,
+					const sampleFrame * _buf,
+					const fpp_t _frames,
+					const f_cnt_t _offset,
+					const stereoVolumeVector & _vv,
+					const fpp_t _fpp )
+{
+	const int start_frame = _offset % _fpp;
+	int end_frame = start_frame + _frames;
+	const int loop1_frame = qMin<int>( end_frame, _fpp );
+
+	MixHelpers::addMultipliedStereo( _first+start_frame,		// dst
+										_buf,						// src
+										_vv.vol[0], _vv.vol[1],		// coeff left/right
+										loop1_frame - start_frame );// frame count
+
+	if( end_frame > _fpp )
+	{
+		const int frames_done = _fpp - start_frame;
+		end_frame -= _fpp;
+		end_frame = qMin<int>( end_frame, _fpp );
+
+		MixHelpers::addMultipliedStereo( _second,					// dst
+											_buf+frames_done,		// src
+											_vv.vol[0], _vv.vol[1],	// coeff left/right
+											end_frame );			// frame count
+		return true;
+	}
+
+	return false;
+}
+
+
+
+
 void Mixer::bufferToPort( const sampleFrame * _buf,
 					const fpp_t _frames,
 					const f_cnt_t _offset,
 					stereoVolumeVector _vv,
 						AudioPort * _port )
 {
-	const int start_frame = _offset % m_framesPerPeriod;
-	int end_frame = start_frame + _frames;
-	const int loop1_frame = qMin<int>( end_frame, m_framesPerPeriod );
+	const int slot = MixerWorkerThread::currentOutputSlot();
 
-	_port->lockFirstBuffer();
-	MixHelpers::addMultipliedStereo( _port->firstBuffer()+start_frame,	// dst
-										_buf,							// src
-										_vv.vol[0], _vv.vol[1],			// coeff left/right
-										loop1_frame - start_frame );	// frame count
-	_port->unlockFirstBuffer();
+	// we're rendering a play handle job - mix into the job's own slot
+	// without any locking, slots are merged into the port's buffers in
+	// job order before its effects are processed
+	if( slot >= 0 )
+	{
+		MixerWorkerThread::OutputSlot & s =
+					MixerWorkerThread::s_outputSlots[slot];
+		if( s.port == NULL )
+		{
+			s.port = _port;
+			s.prevSlot = _port->m_lastOutputSlot.
+						fetchAndStoreOrdered( slot );
+			clearAudioBuffer( s.first, m_framesPerPeriod );
+			clearAudioBuffer( s.second, m_framesPerPeriod );
+		}
+		if( s.port == _port )
+		{
+			if( addToPortBuffers( s.first, s.second, _buf, _frames,
+						_offset, _vv, m_framesPerPeriod ) )
+			{
+				s.usage = AudioPort::BothBuffers;
+			}
+			else if( s.usage == AudioPort::NoUsage )
+			{
+				s.usage = AudioPort::FirstBuffer;
+			}
+			return;
+		}
+		// a job mixing into several ports is rare enough to just mix
+		// into the other ports directly
+	}
 
+	// called from outside of a play handle job, so mix directly into the
+	// port
+	_port->lockFirstBuffer();
 	_port->lockSecondBuffer();
-	if( end_frame > m_framesPerPeriod )
+	if( addToPortBuffers( _port->firstBuffer(), _port->secondBuffer(), _buf,
+					_frames, _offset, _vv, m_framesPerPeriod ) )
 	{
-		const int frames_done = m_framesPerPeriod - start_frame;
-		end_frame -= m_framesPerPeriod;
-		end_frame = qMin<int>( end_frame, m_framesPerPeriod );
-
-		MixHelpers::addMultipliedStereo( _port->secondBuffer(),			// dst
-											_buf+frames_done,			// src
-											_vv.vol[0], _vv.vol[1],		// coeff left/right
-											end_frame );				// frame count
-
 		// we used both buffers so set flags
 		_port->m_bufferUsage = AudioPort::BothBuffers;
 	}
@@ -739,6 +1092,7 @@ void Mixer::bufferToPort( const sampleFrame * _buf,
 		_port->m_bufferUsage = AudioPort::FirstBuffer;
 	}
 	_port->unlockSecondBuffer();
+	_port->unlockFirstBuffer();
 }
 
 
@@ -895,15 +1249,15 @@ void Mixer::restoreAudioDevice()
 
 void Mixer::removeAudioPort( AudioPort * _port )
 {
+	lock();
 	QVector<AudioPort *>::Iterator it = qFind( m_audioPorts.begin(),
 							m_audioPorts.end(),
 							_port );
 	if( it != m_audioPorts.end() )
 	{
-		lock();
 		m_audioPorts.erase( it );
-		unlock();
 	}
+	unlock();
 }
 
 
@@ -923,6 +1277,7 @@ void Mixer::removePlayHandle( PlayHandle * _ph )
 		if( it != m_playHandles.end() )
 		{
 			m_playHandles.erase( it );
+			_ph->unlink();
 			delete _ph;
 		}
 	}
@@ -944,7 +1299,9 @@ void Mixer::removePlayHandles( track * _track )
 	{
 		if( ( *it )->isFromTrack( _track ) )
 		{
-			delete *it;
+			// unlinked play-handles don't refer to the track anymore,
+			// so they can safely outlive it
+			deletePlayHandle( *it );
 			it = m_playHandles.erase( it );
 		}
 		else
@@ -958,6 +1315,43 @@ void Mixer::removePlayHandles( track * _track )
 
 
 
+void Mixer::deletePlayHandle( PlayHandle * _ph )
+{
+	_ph->unlink();
+
+	const int writePos = m_playHandlesToDeleteWritePos;
+	const int nextPos = ( writePos + 1 ) % PlayHandlesToDeleteRingSize;
+	if( nextPos == m_playHandlesToDeleteReadPos.fetchAndAddOrdered( 0 ) )
+	{
+		// ring is full - as handle is unlinked already, its destructor
+		// only frees memory
+		delete _ph;
+		return;
+	}
+
+	m_playHandlesToDelete[writePos] = _ph;
+	m_playHandlesToDeleteWritePos.fetchAndStoreOrdered( nextPos );
+}
+
+
+
+
+void Mixer::deleteUnlinkedPlayHandles()
+{
+	int readPos = m_playHandlesToDeleteReadPos;
+	const int writePos = m_playHandlesToDeleteWritePos.fetchAndAddOrdered( 0 );
+
+	while( readPos != writePos )
+	{
+		delete m_playHandlesToDelete[readPos];
+		readPos = ( readPos + 1 ) % PlayHandlesToDeleteRingSize;
+	}
+	m_playHandlesToDeleteReadPos.fetchAndStoreOrdered( readPos );
+}
+
+
+
+
 bool Mixer::hasNotePlayHandles()
 {
 	lock();
@@ -978,6 +1372,90 @@ bool Mixer::hasNotePlayHandles()
 
 
 
+void Mixer::runParallel( ParallelJobFunc _func, void * _context, int _count )
+{
+	MixerWorkerThread::JobQueue & queue = MixerWorkerThread::s_jobQueue;
+
+	if( _count > 1 && MixerWorkerThread::currentWorkerNum() >= 0 )
+	{
+		MixerWorkerThread::s_jobQueueAppendMutex.lock();
+		const int first = queue.queueSize;
+		if( first + _count <= JOB_QUEUE_SIZE )
+		{
+			MixerWorkerThread::ParallelJob job( _func, _context,
+								_count );
+			// append tasks in claimed state first so no worker can
+			// pick up a half-written item...
+			for( int i = 0; i < _count; ++i )
+			{
+				MixerWorkerThread::JobQueueItem & item =
+							queue.items[first + i];
+				item.type = MixerWorkerThread::ParallelTask;
+				item.job = &job;
+				item.param = i;
+				item.done.fetchAndStoreOrdered( 1 );
+			}
+			queue.queueSize = first + _count;
+			MixerWorkerThread::s_jobQueueAppendMutex.unlock();
+
+			// ...then release them and wake up idle workers
+			for( int i = 0; i < _count; ++i )
+			{
+				queue.items[first + i].done.fetchAndStoreOrdered( 0 );
+			}
+			m_queueReadyWaitCond.wakeAll();
+
+			// process whatever has not been picked up by other
+			// workers...
+			for( int i = 0; i < _count; ++i )
+			{
+				MixerWorkerThread::JobQueueItem & item =
+							queue.items[first + i];
+				if( item.done.fetchAndStoreOrdered( 1 ) == 0 )
+				{
+					MixerWorkerThread::runParallelTask( &item );
+					queue.itemsDone.fetchAndAddOrdered( 1 );
+				}
+			}
+
+			// ...help with tasks of other parallel jobs while ours
+			// are still running - play handle jobs are left alone as
+			// they would share our worker's buffer...
+			for( int i = 0; i < queue.queueSize &&
+						job.remaining > 0; ++i )
+			{
+				MixerWorkerThread::JobQueueItem & item =
+							queue.items[i];
+				if( item.type == MixerWorkerThread::ParallelTask &&
+					item.done.fetchAndStoreOrdered( 1 ) == 0 )
+				{
+					MixerWorkerThread::runParallelTask( &item );
+					queue.itemsDone.fetchAndAddOrdered( 1 );
+				}
+			}
+
+			// ...and sleep until the rest is done
+			MixerWorkerThread::s_parallelJobMutex.lock();
+			while( job.remaining > 0 )
+			{
+				MixerWorkerThread::s_parallelJobDone.wait(
+					&MixerWorkerThread::s_parallelJobMutex );
+			}
+			MixerWorkerThread::s_parallelJobMutex.unlock();
+			return;
+		}
+		MixerWorkerThread::s_jobQueueAppendMutex.unlock();
+	}
+
+	for( int i = 0; i < _count; ++i )
+	{
+		_func( _context, i );
+	}
+}
+
+
+
+
 AudioDevice * Mixer::tryAudioDevices()
 {
 	bool success_ful = false;
@@ -1210,5 +1688,34 @@ void Mixer::fifoWriter::run()
 
 
 
+Mixer::playHandleReclaimer::playHandleReclaimer( Mixer * _mixer ) :
+	m_mixer( _mixer ),
+	m_running( true )
+{
+}
+
+
+
+
+void Mixer::playHandleReclaimer::finish()
+{
+	m_running = false;
+}
+
+
+
+
+void Mixer::playHandleReclaimer::run()
+{
+	while( m_running )
+	{
+		m_mixer->deleteUnlinkedPlayHandles();
+		msleep( 50 );
+	}
+}
+
+
+
+
 #include "moc_Mixer.cxx"
 
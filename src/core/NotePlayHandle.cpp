@@ -63,6 +63,7 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 	m_releaseFramesToDo( 0 ),
 	m_releaseFramesDone( 0 ),
 	m_released( false ),
+	m_unlinked( false ),
 	m_topNote( parent == NULL  ),
 	m_partOfArpeggio( _part_of_arp ),
 	m_muted( false ),
@@ -120,23 +121,8 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 
 NotePlayHandle::~NotePlayHandle()
 {
-	noteOff( 0 );
-
-	if( isTopNote() )
-	{
-		delete m_baseDetuning;
-		m_instrumentTrack->m_processHandles.removeAll( this );
-	}
-
-	if( m_pluginData != NULL )
-	{
-		m_instrumentTrack->deleteNotePluginData( this );
-	}
-
-	if( m_instrumentTrack->m_notes[key()] == this )
-	{
-		m_instrumentTrack->m_notes[key()] = NULL;
-	}
+	// usually done by mixer already
+	unlink();
 
 	for( NotePlayHandleList::Iterator it = m_subNotes.begin(); it != m_subNotes.end(); ++it )
 	{
@@ -259,13 +245,47 @@ void NotePlayHandle::play( sampleFrame * _working_buffer )
 		}
 	}
 
-	// play sub-notes (e.g. chords)
+	// sub-notes (e.g. chords) are not played here but scheduled as jobs of
+	// their own by the mixer (see appendSubPlayHandles())
+
+	// update internal data
+	m_totalFramesPlayed += engine::mixer()->framesPerPeriod();
+}
+
+
+
+
+void NotePlayHandle::appendSubPlayHandles( PlayHandleList & _list )
+{
+	if( m_muted )
+	{
+		return;
+	}
+
+	for( NotePlayHandleList::Iterator it = m_subNotes.begin(); it != m_subNotes.end(); ++it )
+	{
+		_list.push_back( *it );
+	}
+}
+
+
+
+
+void NotePlayHandle::releaseFinishedSubPlayHandles()
+{
+	if( m_muted )
+	{
+		return;
+	}
+
 	for( NotePlayHandleList::Iterator it = m_subNotes.begin(); it != m_subNotes.end(); )
 	{
-		( *it )->play( _working_buffer );
+		// sub-notes may have sub-notes on their own (chords on arpeggio
+		// notes) so handle them first
+		( *it )->releaseFinishedSubPlayHandles();
 		if( ( *it )->isFinished() )
 		{
-			delete *it;
+			engine::mixer()->deletePlayHandle( *it );
 			it = m_subNotes.erase( it );
 		}
 		else
@@ -283,9 +303,51 @@ void NotePlayHandle::play( sampleFrame * _working_buffer )
 		m_releaseFramesDone = m_releaseFramesToDo;
 		m_frames = 0;
 	}
+}
 
-	// update internal data
-	m_totalFramesPlayed += engine::mixer()->framesPerPeriod();
+
+
+
+void NotePlayHandle::unlink()
+{
+	if( m_unlinked )
+	{
+		return;
+	}
+	m_unlinked = true;
+
+	noteOff( 0 );
+
+	if( m_pluginData != NULL )
+	{
+		m_instrumentTrack->deleteNotePluginData( this );
+		m_pluginData = NULL;
+	}
+
+	if( isTopNote() )
+	{
+		m_instrumentTrack->m_processHandles.removeAll( this );
+	}
+
+	if( m_instrumentTrack->m_notes[key()] == this )
+	{
+		m_instrumentTrack->m_notes[key()] = NULL;
+	}
+
+	for( NotePlayHandleList::Iterator it = m_subNotes.begin(); it != m_subNotes.end(); ++it )
+	{
+		( *it )->unlink();
+	}
+
+	// releasing detuning information may delete it (and free its
+	// journalling ID) which must not happen when we're finally deleted
+	// in another thread
+	if( isTopNote() )
+	{
+		delete m_baseDetuning;
+	}
+	m_baseDetuning = NULL;
+	releaseDetuning();
 }
 
 
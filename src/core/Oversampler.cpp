@@ -0,0 +1,258 @@
+/*
+ * Oversampler.cpp - polyphase up- and downsampling for nonlinear processing
+ *
+ * Copyright (c) 2014 Tobias Doerffel <tobydox/at/users.sourceforge.net>
+ *
+ * This file is part of Linux MultiMedia Studio - http://lmms.sourceforge.net
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <cstring>
+#include <math.h>
+
+#include "Oversampler.h"
+#include "lmms_constants.h"
+
+
+
+// 2x halfband lowpass of length 2*Center+1 - all odd taps except the center
+// one are zero, so only the even taps (Taps of them) need to be computed and
+// the odd branch of the polyphase filter is a pure delay
+class Oversampler::HalfbandStage
+{
+public:
+	enum
+	{
+		Taps = 12,
+		Center = Taps - 1,		// has to be odd
+		HistorySize = 32,		// power of 2 > 2*Center+1
+		HistoryMask = HistorySize - 1
+	} ;
+
+	HalfbandStage()
+	{
+		// windowed sinc, cutoff at half of Nyquist frequency
+		float sum = 0;
+		for( int j = 0; j < Taps; ++j )
+		{
+			const float x = ( 2 * j - Center ) * 0.5f;
+			const float w = 0.42f - 0.5f * cosf( F_2PI * 2 * j /
+								( 2 * Center ) ) +
+					0.08f * cosf( 2 * F_2PI * 2 * j /
+								( 2 * Center ) );
+			m_coeffs[j] = sinf( F_PI * x ) / ( F_PI * x ) * w;
+			sum += m_coeffs[j];
+		}
+		// even taps have to sum up to 0.5 for unity gain at DC
+		for( int j = 0; j < Taps; ++j )
+		{
+			m_coeffs[j] *= 0.5f / sum;
+		}
+		reset();
+	}
+
+	void reset()
+	{
+		memset( m_upHistory, 0, sizeof( m_upHistory ) );
+		memset( m_downHistory, 0, sizeof( m_downHistory ) );
+		m_upPos = 0;
+		m_downPos = 0;
+	}
+
+	// _out has to hold 2 * _frames frames
+	void upsample( const sampleFrame * _in, sampleFrame * _out,
+							const f_cnt_t _frames )
+	{
+		for( f_cnt_t f = 0; f < _frames; ++f )
+		{
+			m_upPos = ( m_upPos + 1 ) & HistoryMask;
+			for( int ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+			{
+				float * h = m_upHistory[ch];
+				h[m_upPos] = _in[f][ch];
+
+				float s = 0;
+				for( int j = 0; j < Taps; ++j )
+				{
+					s += m_coeffs[j] *
+						h[( m_upPos - j ) & HistoryMask];
+				}
+				// zero-stuffing halves the level, so both
+				// branches are scaled by 2
+				_out[f*2][ch] = 2 * s;
+				_out[f*2+1][ch] = h[( m_upPos - Center / 2 ) &
+								HistoryMask];
+			}
+		}
+	}
+
+	// _in has to hold 2 * _frames frames
+	void downsample( const sampleFrame * _in, sampleFrame * _out,
+							const f_cnt_t _frames )
+	{
+		for( f_cnt_t f = 0; f < _frames; ++f )
+		{
+			// decimate at even input frames
+			m_downPos = ( m_downPos + 1 ) & HistoryMask;
+			for( int ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+			{
+				float * h = m_downHistory[ch];
+				h[m_downPos] = _in[f*2][ch];
+
+				float s = 0.5f * h[( m_downPos - Center ) &
+								HistoryMask];
+				for( int j = 0; j < Taps; ++j )
+				{
+					s += m_coeffs[j] * h[( m_downPos -
+								2 * j ) & HistoryMask];
+				}
+
+				_out[f][ch] = s;
+
+				h[( m_downPos + 1 ) & HistoryMask] =
+								_in[f*2+1][ch];
+			}
+			m_downPos = ( m_downPos + 1 ) & HistoryMask;
+		}
+	}
+
+
+private:
+	float m_coeffs[Taps];
+	float m_upHistory[DEFAULT_CHANNELS][HistorySize];
+	float m_downHistory[DEFAULT_CHANNELS][HistorySize];
+	int m_upPos;
+	int m_downPos;
+
+} ;
+
+
+
+
+Oversampler::Oversampler( fpp_t _maxFrames, int _factor ) :
+	m_numStages( 0 )
+{
+	for( int i = 0; i < MaxStages; ++i )
+	{
+		m_stages[i] = new HalfbandStage;
+	}
+	for( int i = 0; i < 2; ++i )
+	{
+		m_buffers[i] = new sampleFrame[_maxFrames * MaxFactor];
+	}
+	setFactor( _factor );
+}
+
+
+
+
+Oversampler::~Oversampler()
+{
+	for( int i = 0; i < MaxStages; ++i )
+	{
+		delete m_stages[i];
+	}
+	for( int i = 0; i < 2; ++i )
+	{
+		delete[] m_buffers[i];
+	}
+}
+
+
+
+
+void Oversampler::setFactor( int _factor )
+{
+	int stages = 0;
+	while( ( 2 << stages ) <= _factor && stages < MaxStages )
+	{
+		++stages;
+	}
+
+	if( stages != m_numStages )
+	{
+		m_numStages = stages;
+		reset();
+	}
+}
+
+
+
+
+void Oversampler::reset()
+{
+	for( int i = 0; i < MaxStages; ++i )
+	{
+		m_stages[i]->reset();
+	}
+}
+
+
+
+
+sampleFrame * Oversampler::upsample( const sampleFrame * _in,
+							const fpp_t _frames )
+{
+	const sampleFrame * src = _in;
+	sampleFrame * dst = m_buffers[0];
+	if( m_numStages == 0 )
+	{
+		memcpy( dst, _in, _frames * sizeof( sampleFrame ) );
+		return dst;
+	}
+
+	f_cnt_t frames = _frames;
+	for( int i = 0; i < m_numStages; ++i )
+	{
+		// alternate between both buffers, last stage writes to first one
+		dst = m_buffers[( m_numStages - 1 - i ) % 2];
+		m_stages[i]->upsample( src, dst, frames );
+		src = dst;
+		frames *= 2;
+	}
+	return dst;
+}
+
+
+
+
+void Oversampler::downsample( const sampleFrame * _in, sampleFrame * _out,
+							const fpp_t _frames )
+{
+	if( m_numStages == 0 )
+	{
+		if( _in != _out )
+		{
+			memcpy( _out, _in, _frames * sizeof( sampleFrame ) );
+		}
+		return;
+	}
+
+	// first stage may read from buffer returned by upsample(), so write to
+	// the other one and alternate afterwards
+	const sampleFrame * src = _in;
+	f_cnt_t frames = _frames * factor();
+	for( int i = m_numStages - 1; i >= 0; --i )
+	{
+		frames /= 2;
+		sampleFrame * dst = ( i == 0 ) ? _out :
+					m_buffers[( m_numStages - i ) % 2];
+		m_stages[i]->downsample( src, dst, frames );
+		src = dst;
+	}
+}
@@ -29,6 +29,7 @@
 #include <QtGui/QMessageBox>
 
 #include "Plugin.h"
+#include "PluginManifest.h"
 #include "embed.h"
 #include "engine.h"
 #include "Mixer.h"
@@ -97,6 +98,13 @@ Plugin * Plugin::instantiate( const QString & _plugin_name, Model * _parent,
 	QLibrary plugin_lib( configManager::inst()->pluginDir() +
 								_plugin_name );
 	if( plugin_lib.load() == false )
+	{
+		// plugin might depend on a library plugin which has not been
+		// loaded yet as we do not load all plugins at startup anymore
+		PluginManifest::loadLibraryPlugins();
+		plugin_lib.load();
+	}
+	if( plugin_lib.isLoaded() == false )
 	{
 		if( engine::hasGUI() )
 		{
@@ -135,47 +143,28 @@ Plugin * Plugin::instantiate( const QString & _plugin_name, Model * _parent,
 
 void Plugin::getDescriptorsOfAvailPlugins( DescriptorList & _plugin_descs )
 {
-	QDir directory( configManager::inst()->pluginDir() );
-#ifdef LMMS_BUILD_WIN32
-	QFileInfoList list = directory.entryInfoList(
-						QStringList( "*.dll" ) );
-#else
-	QFileInfoList list = directory.entryInfoList(
-						QStringList( "lib*.so" ) );
-#endif
-	foreach( const QFileInfo & f, list )
-	{
-		QLibrary( f.absoluteFilePath() ).load();
-	}
+	// libraries stay loaded anyway so we only have to query them once
+	static DescriptorList descriptors;
+	static bool initialized = false;
 
-	foreach( const QFileInfo & f, list )
+	if( !initialized )
 	{
-		QLibrary plugin_lib( f.absoluteFilePath() );
-		if( plugin_lib.load() == false ||
-			plugin_lib.resolve( "lmms_plugin_main" ) == NULL )
-		{
-			continue;
-		}
-		QString desc_name = f.fileName().section( '.', 0, 0 ) +
-							"_plugin_descriptor";
-		if( desc_name.left( 3 ) == "lib" )
-		{
-			desc_name = desc_name.mid( 3 );
-		}
-		Descriptor * plugin_desc =
-			(Descriptor *) plugin_lib.resolve(
-					desc_name.toUtf8().constData() );
-		if( plugin_desc == NULL )
+		PluginManifest::loadLibraryPlugins();
+
+		const PluginManifest::EntryList & entries = PluginManifest::entries();
+		for( PluginManifest::EntryList::ConstIterator it = entries.begin();
+												it != entries.end(); ++it )
 		{
-			printf( "LMMS plugin %s does not have a "
-				"plugin descriptor named %s!\n",
-				f.absoluteFilePath().toUtf8().constData(),
-					desc_name.toUtf8().constData() );
-			continue;
+			Descriptor * plugin_desc = PluginManifest::descriptor( *it );
+			if( plugin_desc != NULL )
+			{
+				descriptors.push_back( *plugin_desc );
+			}
 		}
-		_plugin_descs.push_back( *plugin_desc );
+		initialized = true;
 	}
 
+	_plugin_descs += descriptors;
 }
 
 
@@ -0,0 +1,334 @@
+/*
+ * PluginManifest.cpp - cached information about available plugins
+ *
+ * Copyright (c) 2014 Tobias Doerffel <tobydox/at/users.sourceforge.net>
+ *
+ * This file is part of Linux MultiMedia Studio - http://lmms.sourceforge.net
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QLibrary>
+
+#include <cstdio>
+
+#include "PluginManifest.h"
+#include "config_mgr.h"
+
+
+// increase whenever the layout of an entry changes
+static const quint32 ManifestMagic = 0x4c4d4d50;	// "LMMP"
+static const quint32 ManifestVersion = 1;
+
+
+PluginManifest::EntryList PluginManifest::s_entries;
+bool PluginManifest::s_initialized = false;
+
+
+static QDataStream & operator<<( QDataStream & s,
+									const PluginManifest::Entry & e )
+{
+	s << e.name << e.displayName << e.description << e.author
+		<< e.supportedFileTypes << e.fileName << e.size
+		<< (quint32) e.lastModified << (qint32) e.version
+		<< (qint32) e.type << e.hasSubPlugins;
+	return s;
+}
+
+
+
+
+static QDataStream & operator>>( QDataStream & s,
+									PluginManifest::Entry & e )
+{
+	quint32 lastModified;
+	qint32 version;
+	qint32 type;
+	s >> e.name >> e.displayName >> e.description >> e.author
+		>> e.supportedFileTypes >> e.fileName >> e.size
+		>> lastModified >> version >> type >> e.hasSubPlugins;
+	e.lastModified = lastModified;
+	e.version = version;
+	e.type = static_cast<Plugin::PluginTypes>( type );
+	return s;
+}
+
+
+
+
+const PluginManifest::EntryList & PluginManifest::entries()
+{
+	if( !s_initialized )
+	{
+		refresh();
+	}
+	return s_entries;
+}
+
+
+
+
+void PluginManifest::refresh()
+{
+	EntryList cachedEntries;
+	bool changed = !load( cachedEntries );
+
+	QHash<QString, Entry> cache;
+	foreach( const Entry & e, cachedEntries )
+	{
+		cache[e.fileName] = e;
+	}
+
+	const QFileInfoList files = pluginFiles();
+	if( files.size() != cachedEntries.size() )
+	{
+		changed = true;
+	}
+
+	s_entries.clear();
+
+	bool librariesLoaded = false;
+	foreach( const QFileInfo & f, files )
+	{
+		QHash<QString, Entry>::ConstIterator it =
+									cache.find( f.absoluteFilePath() );
+		if( it != cache.end() && it->size == f.size() &&
+				it->lastModified == f.lastModified().toTime_t() )
+		{
+			s_entries << *it;
+			continue;
+		}
+
+		changed = true;
+
+		// new or modified plugin - we have to load it once
+		QLibrary lib( f.absoluteFilePath() );
+		if( lib.load() == false && !librariesLoaded )
+		{
+			// maybe it depends on another plugin library
+			loadLibraryPlugins();
+			librariesLoaded = true;
+		}
+		if( lib.isLoaded() == false && lib.load() == false )
+		{
+			// do not cache anything so we try again next time
+			continue;
+		}
+
+		Entry e;
+		e.fileName = f.absoluteFilePath();
+		e.size = f.size();
+		e.lastModified = f.lastModified().toTime_t();
+
+		const Plugin::Descriptor * desc = resolveDescriptor( lib, f );
+		if( desc != NULL )
+		{
+			e.name = desc->name;
+			e.displayName = desc->displayName;
+			e.description = desc->description;
+			e.author = desc->author;
+			e.supportedFileTypes = desc->supportedFileTypes;
+			e.version = desc->version;
+			e.type = desc->type;
+			e.hasSubPlugins = desc->subPluginFeatures != NULL;
+		}
+		// else keep entry with empty name so we know that this file is
+		// not a valid plugin and do not have to load it again
+
+		s_entries << e;
+	}
+
+	s_initialized = true;
+
+	if( changed )
+	{
+		save();
+	}
+}
+
+
+
+
+QFileInfoList PluginManifest::pluginFiles()
+{
+	QDir directory( configManager::inst()->pluginDir() );
+#ifdef LMMS_BUILD_WIN32
+	return directory.entryInfoList( QStringList( "*.dll" ) );
+#else
+	return directory.entryInfoList( QStringList( "lib*.so" ) );
+#endif
+}
+
+
+
+
+Plugin::Descriptor * PluginManifest::descriptor( const Entry & e )
+{
+	// skip files known not to be a plugin
+	if( e.name.isEmpty() )
+	{
+		return NULL;
+	}
+
+	QLibrary lib( e.fileName );
+	if( lib.load() == false )
+	{
+		// maybe it depends on another plugin library
+		loadLibraryPlugins();
+		if( lib.load() == false )
+		{
+			return NULL;
+		}
+	}
+
+	return resolveDescriptor( lib, QFileInfo( e.fileName ) );
+}
+
+
+
+
+void PluginManifest::descriptorsOfType( Plugin::PluginTypes type,
+										Plugin::DescriptorList & descs )
+{
+	const EntryList & e = entries();
+	for( EntryList::ConstIterator it = e.begin(); it != e.end(); ++it )
+	{
+		if( it->type != type )
+		{
+			continue;
+		}
+		const Plugin::Descriptor * desc = descriptor( *it );
+		if( desc != NULL )
+		{
+			descs.push_back( *desc );
+		}
+	}
+}
+
+
+
+
+Plugin::Descriptor * PluginManifest::resolveDescriptor( QLibrary & lib,
+													const QFileInfo & file )
+{
+	if( lib.resolve( "lmms_plugin_main" ) == NULL )
+	{
+		return NULL;
+	}
+
+	QString desc_name = file.fileName().section( '.', 0, 0 ) +
+							"_plugin_descriptor";
+	if( desc_name.left( 3 ) == "lib" )
+	{
+		desc_name = desc_name.mid( 3 );
+	}
+	Plugin::Descriptor * plugin_desc =
+		(Plugin::Descriptor *) lib.resolve( desc_name.toUtf8().constData() );
+	if( plugin_desc == NULL )
+	{
+		printf( "LMMS plugin %s does not have a "
+			"plugin descriptor named %s!\n",
+			file.absoluteFilePath().toUtf8().constData(),
+				desc_name.toUtf8().constData() );
+	}
+	return plugin_desc;
+}
+
+
+
+
+void PluginManifest::loadLibraryPlugins()
+{
+	if( s_initialized )
+	{
+		foreach( const Entry & e, s_entries )
+		{
+			if( e.type == Plugin::Library )
+			{
+				QLibrary( e.fileName ).load();
+			}
+		}
+		return;
+	}
+
+	// we do not know which files are libraries yet, so load everything
+	foreach( const QFileInfo & f, pluginFiles() )
+	{
+		QLibrary( f.absoluteFilePath() ).load();
+	}
+}
+
+
+
+
+QString PluginManifest::manifestFile()
+{
+	return configManager::inst()->cacheDir() + "plugins.manifest";
+}
+
+
+
+
+bool PluginManifest::load( EntryList & entries )
+{
+	QFile f( manifestFile() );
+	if( !f.open( QFile::ReadOnly ) )
+	{
+		return false;
+	}
+
+	QDataStream s( &f );
+	s.setVersion( QDataStream::Qt_4_0 );
+
+	quint32 magic, version;
+	QString pluginDir;
+	s >> magic >> version >> pluginDir;
+	if( magic != ManifestMagic || version != ManifestVersion ||
+			pluginDir != configManager::inst()->pluginDir() )
+	{
+		return false;
+	}
+
+	s >> entries;
+
+	return s.status() == QDataStream::Ok;
+}
+
+
+
+
+void PluginManifest::save()
+{
+	QDir().mkpath( configManager::inst()->cacheDir() );
+
+	QFile f( manifestFile() );
+	if( !f.open( QFile::WriteOnly | QFile::Truncate ) )
+	{
+		return;
+	}
+
+	QDataStream s( &f );
+	s.setVersion( QDataStream::Qt_4_0 );
+	s << ManifestMagic << ManifestVersion << configManager::inst()->pluginDir()
+		<< s_entries;
+}
+
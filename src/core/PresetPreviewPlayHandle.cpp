@@ -177,15 +177,9 @@ PresetPreviewPlayHandle::PresetPreviewPlayHandle( const QString & _preset_file,
 
 PresetPreviewPlayHandle::~PresetPreviewPlayHandle()
 {
-	s_previewTC->lockData();
-	// not muted by other preset-preview-handle?
-	if( !m_previewNote->isMuted() )
-	{
-		// then set according state
-		s_previewTC->setPreviewNote( NULL );
-	}
+	// usually done by mixer already
+	unlink();
 	delete m_previewNote;
-	s_previewTC->unlockData();
 }
 
 
@@ -199,6 +193,38 @@ void PresetPreviewPlayHandle::play( sampleFrame * _working_buffer )
 
 
 
+void PresetPreviewPlayHandle::appendSubPlayHandles( PlayHandleList & _list )
+{
+	m_previewNote->appendSubPlayHandles( _list );
+}
+
+
+
+
+void PresetPreviewPlayHandle::releaseFinishedSubPlayHandles()
+{
+	m_previewNote->releaseFinishedSubPlayHandles();
+}
+
+
+
+
+void PresetPreviewPlayHandle::unlink()
+{
+	s_previewTC->lockData();
+	// not replaced by other preset-preview-handle?
+	if( s_previewTC->previewNote() == m_previewNote )
+	{
+		// then set according state
+		s_previewTC->setPreviewNote( NULL );
+	}
+	m_previewNote->unlink();
+	s_previewTC->unlockData();
+}
+
+
+
+
 bool PresetPreviewPlayHandle::isFinished() const
 {
 	return m_previewNote->isMuted();
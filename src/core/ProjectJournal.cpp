@@ -25,6 +25,8 @@
 #include <cstdlib>
 
 #include "ProjectJournal.h"
+#include "AutomatableModel.h"
+#include "config_mgr.h"
 #include "engine.h"
 #include "JournallingObject.h"
 #include "song.h"
@@ -32,10 +34,23 @@
 
 ProjectJournal::ProjectJournal() :
 	m_joIDs(),
+	m_joIDsMutex(),
 	m_undoCheckPoints(),
 	m_redoCheckPoints(),
-	m_journalling( false )
+	m_memoryUsage( 0 ),
+	m_maxMemoryUsage( DefaultMaxMemoryUsage * 1024 * 1024 ),
+	m_revision( 0 ),
+	m_journalling( false ),
+	m_interactionDepth( 0 ),
+	m_interaction( 0 ),
+	m_lastInteraction( 0 ),
+	m_mergeWithPrevious( false )
 {
+	const int maxMB = configManager::inst()->value( "app", "journalsize" ).toInt();
+	if( maxMB > 0 )
+	{
+		setMaxMemoryUsage( maxMB * 1024 * 1024 );
+	}
 }
 
 
@@ -50,65 +65,296 @@ ProjectJournal::~ProjectJournal()
 
 void ProjectJournal::undo()
 {
-	while( !m_undoCheckPoints.isEmpty() )
+	step( m_undoCheckPoints, m_redoCheckPoints );
+}
+
+
+
+
+void ProjectJournal::redo()
+{
+	step( m_redoCheckPoints, m_undoCheckPoints );
+}
+
+
+
+
+void ProjectJournal::addJournalCheckPoint( JournallingObject *jo )
+{
+	markModified();
+
+	if( isJournalling() )
+	{
+		clearCheckPoints( m_redoCheckPoints );
+
+		CheckPoint c = createCheckPoint( CheckPoint::Snapshot, jo );
+		c.interaction = m_interaction;
+		pushCheckPoint( m_undoCheckPoints, c );
+	}
+}
+
+
+
+
+void ProjectJournal::addValueCheckPoint( AutomatableModel *model, float oldValue )
+{
+	markModified();
+
+	if( !isJournalling() )
 	{
-		CheckPoint c = m_undoCheckPoints.pop();
-		JournallingObject *jo = m_joIDs[c.joID];
+		return;
+	}
+
+	clearCheckPoints( m_redoCheckPoints );
 
-		if( jo )
+	if( !m_undoCheckPoints.isEmpty() )
+	{
+		CheckPoint & last = m_undoCheckPoints.last();
+		if( m_interaction != 0 && last.interaction == m_interaction )
 		{
-			DataFile curState( DataFile::JournalData );
-			jo->saveState( curState, curState.content() );
-			m_redoCheckPoints.push( CheckPoint( c.joID, curState ) );
-
-			bool prev = isJournalling();
-			setJournalling( false );
-			jo->restoreState( c.data.content().firstChildElement() );
-			setJournalling( prev );
-			engine::getSong()->setModified();
-			break;
+			// model already changed within this interaction - keep the
+			// value from before it started
+			if( lastStepChanges( model->id() ) )
+			{
+				last.lastChange.restart();
+				return;
+			}
+		}
+		else if( m_mergeWithPrevious && last.interaction != 0 &&
+				last.lastChange.isValid() &&
+				last.lastChange.elapsed() < ValueChangeMergeInterval &&
+				lastStepChanges( model->id() ) )
+		{
+			// still the same edit - continue its step, so changes of
+			// linked models end up there as well
+			m_interaction = last.interaction;
+			last.lastChange.restart();
+			return;
 		}
 	}
+
+	CheckPoint c( CheckPoint::ValueChange, model->id() );
+	c.interaction = m_interaction;
+	c.value = oldValue;
+	c.lastChange.start();
+	pushCheckPoint( m_undoCheckPoints, c );
 }
 
 
 
-void ProjectJournal::redo()
+
+void ProjectJournal::beginInteraction( bool _mergeWithPrevious )
+{
+	if( m_interactionDepth++ == 0 )
+	{
+		m_interaction = ++m_lastInteraction;
+		m_mergeWithPrevious = _mergeWithPrevious;
+	}
+}
+
+
+
+
+void ProjectJournal::endInteraction()
 {
-	while( !m_redoCheckPoints.isEmpty() )
+	if( m_interactionDepth > 0 && --m_interactionDepth == 0 )
 	{
-		CheckPoint c = m_redoCheckPoints.pop();
-		JournallingObject *jo = m_joIDs[c.joID];
+		m_interaction = 0;
+		m_mergeWithPrevious = false;
+	}
+}
+
+
+
 
-		if( jo )
+bool ProjectJournal::lastStepChanges( jo_id_t _id ) const
+{
+	const int interaction = m_undoCheckPoints.last().interaction;
+	for( int i = m_undoCheckPoints.size() - 1; i >= 0; --i )
+	{
+		const CheckPoint & c = m_undoCheckPoints[i];
+		if( c.interaction != interaction )
 		{
-			DataFile curState( DataFile::JournalData );
-			jo->saveState( curState, curState.content() );
-			m_undoCheckPoints.push( CheckPoint( c.joID, curState ) );
-
-			bool prev = isJournalling();
-			setJournalling( false );
-			jo->restoreState( c.data.content().firstChildElement() );
-			setJournalling( prev );
-			engine::getSong()->setModified();
+			break;
+		}
+		if( c.type == CheckPoint::ValueChange && c.joID == _id )
+		{
+			return true;
+		}
+		if( interaction == 0 )
+		{
+			// entries without interaction are steps on their own
 			break;
 		}
 	}
+	return false;
 }
 
 
 
 
-void ProjectJournal::addJournalCheckPoint( JournallingObject *jo )
+void ProjectJournal::setMaxMemoryUsage( int bytes )
 {
-	if( isJournalling() )
-	{
-		m_redoCheckPoints.clear();
+	m_maxMemoryUsage = qMax( bytes, 0 );
+	enforceMemoryLimit();
+}
+
+
 
+
+ProjectJournal::CheckPoint ProjectJournal::createCheckPoint(
+						CheckPoint::Types type, JournallingObject * jo ) const
+{
+	CheckPoint c( type, jo->id() );
+	c.lastChange.start();
+
+	if( type == CheckPoint::ValueChange )
+	{
+		c.value = static_cast<AutomatableModel *>( jo )->m_value;
+	}
+	else
+	{
 		DataFile dataFile( DataFile::JournalData );
 		jo->saveState( dataFile, dataFile.content() );
+		c.data = qCompress( dataFile.toByteArray( 0 ) );
+	}
 
-		m_undoCheckPoints.push( CheckPoint( jo->id(), dataFile ) );
+	return c;
+}
+
+
+
+
+void ProjectJournal::restoreCheckPoint( const CheckPoint & c, JournallingObject * jo )
+{
+	bool prev = isJournalling();
+	setJournalling( false );
+
+	if( c.type == CheckPoint::ValueChange )
+	{
+		static_cast<AutomatableModel *>( jo )->setValue( c.value );
+	}
+	else
+	{
+		DataFile dataFile( qUncompress( c.data ) );
+		jo->restoreState( dataFile.content().firstChildElement() );
+	}
+
+	setJournalling( prev );
+}
+
+
+
+
+bool ProjectJournal::step( CheckPointList & from, CheckPointList & to )
+{
+	bool changed = false;
+	int interaction = 0;
+
+	while( !from.isEmpty() )
+	{
+		// a step consists of all entries of an interaction
+		if( changed && ( interaction == 0 ||
+					from.last().interaction != interaction ) )
+		{
+			break;
+		}
+
+		CheckPoint c = popCheckPoint( from );
+		JournallingObject *jo = journallingObject( c.joID );
+
+		if( jo == NULL )
+		{
+			continue;
+		}
+
+		if( c.type == CheckPoint::ValueChange )
+		{
+			AutomatableModel * m = dynamic_cast<AutomatableModel *>( jo );
+			// skip entries which wouldn't change anything (e.g. a knob
+			// has been clicked but not moved or a linked model has
+			// been restored along with another one already)
+			if( m == NULL || m->m_value == c.value )
+			{
+				continue;
+			}
+		}
+
+		CheckPoint current = createCheckPoint( c.type, jo );
+		current.interaction = c.interaction;
+		pushCheckPoint( to, current );
+		restoreCheckPoint( c, jo );
+
+		interaction = c.interaction;
+		changed = true;
+	}
+
+	if( !changed )
+	{
+		return false;
+	}
+
+	// a following edit must never be merged into an entry which has
+	// been moved by undo/redo or is now on top of the undo-list
+	to.last().lastChange = QTime();
+	if( !from.isEmpty() )
+	{
+		from.last().lastChange = QTime();
+	}
+
+	markModified();
+	engine::getSong()->setModified();
+	return true;
+}
+
+
+
+
+void ProjectJournal::pushCheckPoint( CheckPointList & list, const CheckPoint & c )
+{
+	list.append( c );
+	m_memoryUsage += c.memoryUsage();
+
+	enforceMemoryLimit();
+}
+
+
+
+
+ProjectJournal::CheckPoint ProjectJournal::popCheckPoint( CheckPointList & list )
+{
+	CheckPoint c = list.takeLast();
+	m_memoryUsage -= c.memoryUsage();
+	return c;
+}
+
+
+
+
+void ProjectJournal::clearCheckPoints( CheckPointList & list )
+{
+	for( CheckPointList::ConstIterator it = list.begin(); it != list.end(); ++it )
+	{
+		m_memoryUsage -= it->memoryUsage();
+	}
+	list.clear();
+}
+
+
+
+
+void ProjectJournal::enforceMemoryLimit()
+{
+	// drop oldest undo-steps first, then the ones farthest away in redo-list
+	// - always keep at least the most recent entry
+	while( m_memoryUsage > m_maxMemoryUsage && m_undoCheckPoints.size() > 1 )
+	{
+		m_memoryUsage -= m_undoCheckPoints.takeFirst().memoryUsage();
+	}
+
+	while( m_memoryUsage > m_maxMemoryUsage && m_redoCheckPoints.size() > 1 )
+	{
+		m_memoryUsage -= m_redoCheckPoints.takeFirst().memoryUsage();
 	}
 }
 
@@ -119,6 +365,7 @@ jo_id_t ProjectJournal::allocID( JournallingObject * _obj )
 {
 	const jo_id_t EO_ID_MAX = (1 << 23)-1;
 	jo_id_t id;
+	QMutexLocker ml( &m_joIDsMutex );
 	while( m_joIDs.contains( id =
 			static_cast<jo_id_t>( (jo_id_t)rand()*(jo_id_t)rand() % 
 								 EO_ID_MAX ) ) )
@@ -136,6 +383,7 @@ jo_id_t ProjectJournal::allocID( JournallingObject * _obj )
 void ProjectJournal::reallocID( const jo_id_t _id, JournallingObject * _obj )
 {
 	//printf("realloc %d %d\n", _id, _obj );
+	QMutexLocker ml( &m_joIDsMutex );
 //	if( m_joIDs.contains( _id ) )
 	{
 		m_joIDs[_id] = _obj;
@@ -147,9 +395,10 @@ void ProjectJournal::reallocID( const jo_id_t _id, JournallingObject * _obj )
 
 void ProjectJournal::clearJournal()
 {
-	m_undoCheckPoints.clear();
-	m_redoCheckPoints.clear();
+	clearCheckPoints( m_undoCheckPoints );
+	clearCheckPoints( m_redoCheckPoints );
 
+	QMutexLocker ml( &m_joIDsMutex );
 	for( JoIdMap::Iterator it = m_joIDs.begin(); it != m_joIDs.end(); )
 	{
 		if( it.value() == NULL )
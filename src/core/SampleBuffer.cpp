@@ -30,6 +30,7 @@
 #include <QtCore/QBuffer>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QThread>
 #include <QtGui/QMessageBox>
 #include <QtGui/QPainter>
 
@@ -64,6 +65,30 @@
 #include "FileDialog.h"
 
 
+
+// builds peak pyramid of a SampleBuffer without blocking the GUI
+class SamplePeakBuilder : public QThread
+{
+public:
+	SamplePeakBuilder( SampleBuffer * _buf ) :
+		QThread(),
+		m_buffer( _buf )
+	{
+	}
+
+
+private:
+	virtual void run()
+	{
+		m_buffer->buildPeaks();
+	}
+
+	SampleBuffer * m_buffer;
+
+} ;
+
+
+
 SampleBuffer::SampleBuffer( const QString & _audio_file,
 							bool _is_base64_data ) :
 	m_audioFile( ( _is_base64_data == true ) ? "" : _audio_file ),
@@ -78,7 +103,11 @@ SampleBuffer::SampleBuffer( const QString & _audio_file,
 	m_amplification( 1.0f ),
 	m_reversed( false ),
 	m_frequency( BaseFreq ),
-	m_sampleRate( engine::mixer()->baseSampleRate() )
+	m_sampleRate( engine::mixer()->baseSampleRate() ),
+	m_peakBuilder( NULL ),
+	m_abortPeakBuilder( false ),
+	m_encodedData(),
+	m_encodedDataSampleRate( 0 )
 {
 	if( _is_base64_data == true )
 	{
@@ -103,7 +132,11 @@ SampleBuffer::SampleBuffer( const sampleFrame * _data, const f_cnt_t _frames ) :
 	m_amplification( 1.0f ),
 	m_reversed( false ),
 	m_frequency( BaseFreq ),
-	m_sampleRate( engine::mixer()->baseSampleRate() )
+	m_sampleRate( engine::mixer()->baseSampleRate() ),
+	m_peakBuilder( NULL ),
+	m_abortPeakBuilder( false ),
+	m_encodedData(),
+	m_encodedDataSampleRate( 0 )
 {
 	if( _frames > 0 )
 	{
@@ -130,7 +163,11 @@ SampleBuffer::SampleBuffer( const f_cnt_t _frames ) :
 	m_amplification( 1.0f ),
 	m_reversed( false ),
 	m_frequency( BaseFreq ),
-	m_sampleRate( engine::mixer()->baseSampleRate() )
+	m_sampleRate( engine::mixer()->baseSampleRate() ),
+	m_peakBuilder( NULL ),
+	m_abortPeakBuilder( false ),
+	m_encodedData(),
+	m_encodedDataSampleRate( 0 )
 {
 	if( _frames > 0 )
 	{
@@ -146,6 +183,8 @@ SampleBuffer::SampleBuffer( const f_cnt_t _frames ) :
 
 SampleBuffer::~SampleBuffer()
 {
+	stopPeakBuilder();
+
 	delete[] m_origData;
 	delete[] m_data;
 }
@@ -157,6 +196,11 @@ SampleBuffer::~SampleBuffer()
 
 void SampleBuffer::update( bool _keep_settings )
 {
+	// peaks are outdated now and builder must not access old data anymore
+	stopPeakBuilder();
+
+	m_encodedData.clear();
+
 	const bool lock = ( m_data != NULL );
 	if( lock )
 	{
@@ -803,32 +847,188 @@ void SampleBuffer::visualize( QPainter & _p, const QRect & _dr,
 	const float y_space = h*0.25f;
 	const int nb_frames = focus_on_range ? _to_frame - _from_frame : m_frames;
 
+	const int xb = _dr.x();
+	const int first = focus_on_range ? _from_frame : 0;
+	const int last = focus_on_range ? _to_frame : m_frames;
+
+	// only draw what's actually visible
+	const int x0 = qMax( xb, _clip.x() );
+	const int x1 = qMin( xb + w, _clip.x() + _clip.width() );
+	if( w <= 0 || x0 >= x1 || nb_frames <= 0 )
+	{
+		return;
+	}
+
+	const double frames_per_px = double( nb_frames ) / w;
+
+	if( frames_per_px >= PeakBlockFrames )
+	{
+		m_peakLock.lock();
+		if( !m_peaks.isEmpty() )
+		{
+			// pick coarsest level which still has at least one
+			// peak per pixel
+			int level = 0;
+			while( level + 1 < m_peaks.size() &&
+				( PeakBlockFrames << ( level + 1 ) ) <=
+								frames_per_px )
+			{
+				++level;
+			}
+			const PeakLevel & peaks = m_peaks[level];
+			const f_cnt_t block_frames = PeakBlockFrames << level;
+
+			QVector<QLine> lines;
+			lines.reserve( x1 - x0 );
+			for( int x = x0; x < x1; ++x )
+			{
+				const f_cnt_t f0 = first + static_cast<f_cnt_t>(
+						( x - xb ) * frames_per_px );
+				const f_cnt_t f1 = first + static_cast<f_cnt_t>(
+						( x - xb + 1 ) * frames_per_px );
+				const int p0 = f0 / block_frames;
+				const int p1 = qMin<int>( peaks.size(),
+					qMax<int>( p0 + 1, f1 / block_frames ) );
+				if( p0 >= p1 )
+				{
+					break;
+				}
+				sample_t min = peaks[p0].min;
+				sample_t max = peaks[p0].max;
+				for( int p = p0 + 1; p < p1; ++p )
+				{
+					min = qMin( min, peaks[p].min );
+					max = qMax( max, peaks[p].max );
+				}
+				lines.push_back( QLine(
+					x, (int)( yb - max * y_space ),
+					x, (int)( yb - min * y_space ) ) );
+			}
+			m_peakLock.unlock();
+
+			_p.drawLines( lines );
+			return;
+		}
+		m_peakLock.unlock();
+
+		if( m_peakBuilder == NULL )
+		{
+			m_peakBuilder = new SamplePeakBuilder( this );
+			m_peakBuilder->start( QThread::LowPriority );
+		}
+	}
+
+	// draw sample values directly - in case peaks are not available yet
+	// just pick one frame per pixel
 	if( nb_frames < 60000 )
 	{
 		_p.setRenderHint( QPainter::Antialiasing );
 		QColor c = _p.pen().color();
 		_p.setPen( QPen( c, 0.7 ) );
 	}
-	const int fpp = tLimit<int>( nb_frames / w, 1, 20 );
-	QPoint * l = new QPoint[nb_frames / fpp + 1];
+	const int fpp = frames_per_px >= PeakBlockFrames ?
+				static_cast<int>( frames_per_px ) :
+				tLimit<int>( nb_frames / w, 1, 20 );
+	const int from = first + static_cast<int>( ( x0 - xb ) *
+							frames_per_px );
+	const int to = qMin<int>( last, first + static_cast<int>(
+				( x1 - xb ) * frames_per_px ) + fpp + 1 );
+	if( to <= from )
+	{
+		return;
+	}
+	QPoint * l = new QPoint[( to - from ) / fpp + 1];
 	int n = 0;
-	const int xb = _dr.x();
-	const int first = focus_on_range ? _from_frame : 0;
-	const int last = focus_on_range ? _to_frame : m_frames;
-	for( int frame = first; frame < last; frame += fpp )
+	for( int frame = from; frame < to; frame += fpp )
 	{
 		l[n] = QPoint( xb + ( (frame - first) * double( w ) / nb_frames ),
 			(int)( yb - ( ( m_data[frame][0]+m_data[frame][1] ) *
 								y_space ) ) );
 		++n;
 	}
-	_p.drawPolyline( l, nb_frames / fpp );
+	_p.drawPolyline( l, n );
 	delete[] l;
 }
 
 
 
 
+void SampleBuffer::buildPeaks()
+{
+	QVector<PeakLevel> peaks;
+
+	PeakLevel level( ( m_frames + PeakBlockFrames - 1 ) /
+							PeakBlockFrames );
+	for( int i = 0; i < level.size(); ++i )
+	{
+		if( m_abortPeakBuilder )
+		{
+			return;
+		}
+		const f_cnt_t start = i * PeakBlockFrames;
+		const f_cnt_t end = qMin( start + PeakBlockFrames, m_frames );
+		Peak peak;
+		peak.min = peak.max = m_data[start][0] + m_data[start][1];
+		for( f_cnt_t f = start + 1; f < end; ++f )
+		{
+			const sample_t s = m_data[f][0] + m_data[f][1];
+			peak.min = qMin( peak.min, s );
+			peak.max = qMax( peak.max, s );
+		}
+		level[i] = peak;
+	}
+	peaks.push_back( level );
+
+	// every further level merges two neighbouring peaks
+	while( level.size() > 1 && !m_abortPeakBuilder )
+	{
+		PeakLevel next( ( level.size() + 1 ) / 2 );
+		for( int i = 0; i < next.size(); ++i )
+		{
+			const Peak & a = level[i*2];
+			const Peak & b = ( i*2+1 < level.size() ) ?
+							level[i*2+1] : a;
+			next[i].min = qMin( a.min, b.min );
+			next[i].max = qMax( a.max, b.max );
+		}
+		peaks.push_back( next );
+		level = next;
+	}
+
+	if( m_abortPeakBuilder )
+	{
+		return;
+	}
+
+	m_peakLock.lock();
+	m_peaks = peaks;
+	m_peakLock.unlock();
+
+	emit peaksReady();
+}
+
+
+
+
+void SampleBuffer::stopPeakBuilder()
+{
+	if( m_peakBuilder != NULL )
+	{
+		m_abortPeakBuilder = true;
+		m_peakBuilder->wait();
+		delete m_peakBuilder;
+		m_peakBuilder = NULL;
+		m_abortPeakBuilder = false;
+	}
+
+	m_peakLock.lock();
+	m_peaks.clear();
+	m_peakLock.unlock();
+}
+
+
+
+
 QString SampleBuffer::openAudioFile() const
 {
 	FileDialog ofd( NULL, tr( "Open audio file" ) );
@@ -969,8 +1169,15 @@ void flacStreamEncoderMetadataCallback( const FLAC__StreamEncoder *,
 
 
 
-QString & SampleBuffer::toBase64( QString & _dst ) const
+QByteArray SampleBuffer::toData() const
 {
+	if( !m_encodedData.isEmpty() &&
+		m_encodedDataSampleRate == engine::mixer()->sampleRate() )
+	{
+		return m_encodedData;
+	}
+	m_encodedDataSampleRate = engine::mixer()->sampleRate();
+
 #ifdef LMMS_HAVE_FLAC_STREAM_ENCODER_H
 	const f_cnt_t FRAMES_PER_BUF = 1152;
 
@@ -1017,16 +1224,26 @@ QString & SampleBuffer::toBase64( QString & _dst ) const
 	printf("%d %d\n", frame_cnt, (int)ba_writer.size() );
 	ba_writer.close();
 
-	base64::encode( ba_writer.buffer().data(), ba_writer.buffer().size(),
-									_dst );
+	m_encodedData = ba_writer.buffer();
+	return m_encodedData;
 
 
 #else	/* LMMS_HAVE_FLAC_STREAM_ENCODER_H */
 
-	base64::encode( (const char *) m_data,
-					m_frames * sizeof( sampleFrame ), _dst );
+	m_encodedData = QByteArray( (const char *) m_data,
+					m_frames * sizeof( sampleFrame ) );
+	return m_encodedData;
 
 #endif	/* LMMS_HAVE_FLAC_STREAM_ENCODER_H */
+}
+
+
+
+
+QString & SampleBuffer::toBase64( QString & _dst ) const
+{
+	const QByteArray data = toData();
+	base64::encode( data.constData(), data.size(), _dst );
 
 	return _dst;
 }
@@ -1178,13 +1395,17 @@ void flacStreamDecoderErrorCallback( const FLAC__StreamDecoder *,
 
 void SampleBuffer::loadFromBase64( const QString & _data )
 {
-	char * dst = NULL;
-	int dsize = 0;
-	base64::decode( _data, &dst, &dsize );
+	loadFromData( QByteArray::fromBase64( _data.toUtf8() ) );
+}
 
+
+
+
+void SampleBuffer::loadFromData( const QByteArray & _data )
+{
 #ifdef LMMS_HAVE_FLAC_STREAM_DECODER_H
 
-	QByteArray orig_data = QByteArray::fromRawData( dst, dsize );
+	QByteArray orig_data = _data;
 	QBuffer ba_reader( &orig_data );
 	ba_reader.open( QBuffer::ReadOnly );
 
@@ -1224,15 +1445,14 @@ void SampleBuffer::loadFromBase64( const QString & _data )
 
 #else /* LMMS_HAVE_FLAC_STREAM_DECODER_H */
 
-	m_origFrames = dsize / sizeof( sampleFrame );
+	m_origFrames = _data.size() / sizeof( sampleFrame );
 	delete[] m_origData;
 	m_origData = new sampleFrame[m_origFrames];
-	memcpy( m_origData, dst, dsize );
+	memcpy( m_origData, _data.constData(),
+					m_origFrames * sizeof( sampleFrame ) );
 
 #endif
 
-	delete[] dst;
-
 	m_audioFile = QString();
 	update();
 }
@@ -1351,6 +1571,18 @@ SampleBuffer::handleState::~handleState()
 
 
 
+void SampleBuffer::handleState::reset()
+{
+	m_frameIndex = 0;
+	if( m_resamplingData != NULL )
+	{
+		src_reset( m_resamplingData );
+	}
+}
+
+
+
+
 #include "moc_SampleBuffer.cxx"
 
 
@@ -86,10 +86,25 @@ SamplePlayHandle::SamplePlayHandle( SampleTCO* tco ) :
 
 SamplePlayHandle::~SamplePlayHandle()
 {
+	// usually done by mixer already
+	unlink();
+
 	sharedObject::unref( m_sampleBuffer );
-	if( m_ownAudioPort )
+}
+
+
+
+
+void SamplePlayHandle::unlink()
+{
+	// delete our audio port here with mixer locked instead of when being
+	// finally deleted in another thread
+	if( m_ownAudioPort && m_audioPort != NULL )
 	{
+		engine::mixer()->lock();
 		delete m_audioPort;
+		m_audioPort = NULL;
+		engine::mixer()->unlock();
 	}
 }
 
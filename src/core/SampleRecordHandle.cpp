@@ -28,13 +28,14 @@
 #include "engine.h"
 #include "InstrumentTrack.h"
 #include "pattern.h"
-#include "SampleBuffer.h"
+#include "SampleStreamWriter.h"
 #include "SampleTrack.h"
 
 
 
 SampleRecordHandle::SampleRecordHandle( SampleTCO* tco ) :
 	PlayHandle( TypeSamplePlayHandle ),
+	m_writer( tco->startRecording() ),
 	m_framesRecorded( 0 ),
 	m_minLength( tco->length() ),
 	m_track( tco->getTrack() ),
@@ -48,19 +49,30 @@ SampleRecordHandle::SampleRecordHandle( SampleTCO* tco ) :
 
 SampleRecordHandle::~SampleRecordHandle()
 {
-	if( !m_buffers.empty() )
+	// usually done by mixer already
+	unlink();
+}
+
+
+
+
+void SampleRecordHandle::unlink()
+{
+	if( m_tco == NULL )
 	{
-		SampleBuffer* sb;
-		createSampleBuffer( &sb );
-		m_tco->setSampleBuffer( sb );
+		return;
 	}
-	
-	while( !m_buffers.empty() )
+
+	if( m_writer != NULL )
 	{
-		delete[] m_buffers.front().first;
-		m_buffers.erase( m_buffers.begin() );
+		m_writer->stop();
+		m_writer = NULL;
 	}
-	m_tco->setRecord( false );
+	// closing and loading the take is up to the TCO in GUI thread rather
+	// than blocking here while holding the mixer
+	QMetaObject::invokeMethod( m_tco, "finishRecording",
+						Qt::QueuedConnection );
+	m_tco = NULL;
 }
 
 
@@ -68,9 +80,14 @@ SampleRecordHandle::~SampleRecordHandle()
 
 void SampleRecordHandle::play( sampleFrame * /*_working_buffer*/ )
 {
+	if( m_writer == NULL )
+	{
+		return;
+	}
+
 	const sampleFrame * recbuf = engine::mixer()->inputBuffer();
 	const f_cnt_t frames = engine::mixer()->inputBufferFrames();
-	writeBuffer( recbuf, frames );
+	m_writer->write( recbuf, frames );
 	m_framesRecorded += frames;
 
 	MidiTime len = (tick_t)( m_framesRecorded / engine::framesPerTick() );
@@ -107,48 +124,3 @@ f_cnt_t SampleRecordHandle::framesRecorded() const
 
 
 
-
-void SampleRecordHandle::createSampleBuffer( SampleBuffer** sampleBuf )
-{
-	const f_cnt_t frames = framesRecorded();
-	// create buffer to store all recorded buffers in
-	sampleFrame * data = new sampleFrame[frames];
-	// make sure buffer is cleaned up properly at the end...
-	sampleFrame * data_ptr = data;
-
-#ifdef LMMS_DEBUG
-	assert( data != NULL );
-#endif
-	// now copy all buffers into big buffer
-	for( bufferList::const_iterator it = m_buffers.begin();
-						it != m_buffers.end(); ++it )
-	{
-		memcpy( data_ptr, ( *it ).first, ( *it ).second *
-							sizeof( sampleFrame ) );
-		data_ptr += ( *it ).second;
-	}
-	// create according sample-buffer out of big buffer
-	*sampleBuf = new SampleBuffer( data, frames );
-	( *sampleBuf)->setSampleRate( engine::mixer()->inputSampleRate() );
-	delete[] data;
-}
-
-
-
-
-void SampleRecordHandle::writeBuffer( const sampleFrame * _ab,
-					const f_cnt_t _frames )
-{
-	sampleFrame * buf = new sampleFrame[_frames];
-	for( f_cnt_t frame = 0; frame < _frames; ++frame )
-	{
-		for( ch_cnt_t chnl = 0; chnl < DEFAULT_CHANNELS; ++chnl )
-		{
-			buf[frame][chnl] = _ab[frame][chnl];
-		}
-	}
-	m_buffers.push_back( qMakePair( buf, _frames ) );
-}
-
-
-
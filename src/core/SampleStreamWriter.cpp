@@ -0,0 +1,211 @@
+/*
+ * SampleStreamWriter.cpp - streams recorded audio to disk in background
+ *
+ * Copyright (c) 2014 Tobias Doerffel <tobydox/at/users.sourceforge.net>
+ *
+ * This file is part of Linux MultiMedia Studio - http://lmms.sourceforge.net
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+
+#include <cstring>
+
+#include "SampleStreamWriter.h"
+#include "config_mgr.h"
+
+
+// how many seconds of audio the ring can hold before frames get dropped
+static const int RING_SECONDS = 4;
+
+// how often the writer thread empties the ring
+static const int FLUSH_INTERVAL_MS = 20;
+
+
+
+SampleStreamWriter::SampleStreamWriter( const QString & _file,
+					sample_rate_t _sample_rate ) :
+	QThread(),
+	m_fileName( _file ),
+	m_sndFile( NULL ),
+	m_ring( NULL ),
+	m_ringSize( _sample_rate * RING_SECONDS ),
+	m_readPos( 0 ),
+	m_writePos( 0 ),
+	m_framesWritten( 0 ),
+	m_framesDropped( 0 ),
+	m_quit( false )
+{
+	SF_INFO si;
+	memset( &si, 0, sizeof( si ) );
+	si.samplerate = _sample_rate;
+	si.channels = DEFAULT_CHANNELS;
+	si.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+
+	m_sndFile = sf_open(
+#ifdef LMMS_BUILD_WIN32
+				m_fileName.toLocal8Bit().constData(),
+#else
+				m_fileName.toUtf8().constData(),
+#endif
+				SFM_WRITE, &si );
+	if( m_sndFile == NULL )
+	{
+		qWarning( "SampleStreamWriter: could not open %s for writing",
+					m_fileName.toUtf8().constData() );
+		return;
+	}
+	sf_set_string( m_sndFile, SF_STR_SOFTWARE, "LMMS" );
+	// rewrite header after every write so the file is always valid
+	sf_command( m_sndFile, SFC_SET_UPDATE_HEADER_AUTO, NULL, SF_TRUE );
+
+	m_ring = new sampleFrame[m_ringSize];
+
+	start( QThread::LowPriority );
+}
+
+
+
+
+SampleStreamWriter::~SampleStreamWriter()
+{
+	finish();
+	delete[] m_ring;
+}
+
+
+
+
+QString SampleStreamWriter::newRecordingFile()
+{
+	const QString dir = configManager::inst()->userSamplesDir() +
+								"recordings/";
+	QDir().mkpath( dir );
+
+	const QString base = dir + "recording-" +
+		QDateTime::currentDateTime().toString( "yyyyMMdd-hhmmss" );
+	QString file = base + ".wav";
+	for( int i = 2; QFileInfo( file ).exists(); ++i )
+	{
+		file = base + "-" + QString::number( i ) + ".wav";
+	}
+	return file;
+}
+
+
+
+
+void SampleStreamWriter::write( const sampleFrame * _ab,
+						const f_cnt_t _frames )
+{
+	if( m_ring == NULL || m_quit )
+	{
+		return;
+	}
+
+	// one slot always stays empty so full and empty ring can be told apart
+	const f_cnt_t readPos = m_readPos.fetchAndAddOrdered( 0 );
+	f_cnt_t writePos = m_writePos;
+	const f_cnt_t space = ( readPos - writePos - 1 + m_ringSize ) %
+								m_ringSize;
+	const f_cnt_t frames = qMin( _frames, space );
+
+	f_cnt_t done = 0;
+	while( done < frames )
+	{
+		const f_cnt_t chunk = qMin( frames - done,
+						m_ringSize - writePos );
+		memcpy( m_ring + writePos, _ab + done,
+						chunk * sizeof( sampleFrame ) );
+		done += chunk;
+		writePos = ( writePos + chunk ) % m_ringSize;
+	}
+	m_writePos.fetchAndStoreOrdered( writePos );
+
+	m_framesWritten += frames;
+	if( frames < _frames )
+	{
+		m_framesDropped.fetchAndAddOrdered( _frames - frames );
+	}
+}
+
+
+
+
+void SampleStreamWriter::stop()
+{
+	m_quit = true;
+}
+
+
+
+
+void SampleStreamWriter::finish()
+{
+	if( m_sndFile == NULL )
+	{
+		return;
+	}
+
+	m_quit = true;
+	wait();
+
+	flush();
+	sf_close( m_sndFile );
+	m_sndFile = NULL;
+
+	if( m_framesDropped > 0 )
+	{
+		qWarning( "SampleStreamWriter: dropped %d frames while "
+				"recording to %s", (int) m_framesDropped,
+					m_fileName.toUtf8().constData() );
+	}
+}
+
+
+
+
+void SampleStreamWriter::run()
+{
+	while( !m_quit )
+	{
+		flush();
+		msleep( FLUSH_INTERVAL_MS );
+	}
+}
+
+
+
+
+void SampleStreamWriter::flush()
+{
+	f_cnt_t readPos = m_readPos;
+	const f_cnt_t writePos = m_writePos.fetchAndAddOrdered( 0 );
+
+	while( readPos != writePos )
+	{
+		const f_cnt_t chunk = ( writePos > readPos ) ?
+						writePos - readPos :
+						m_ringSize - readPos;
+		sf_writef_float( m_sndFile, m_ring[readPos], chunk );
+		readPos = ( readPos + chunk ) % m_ringSize;
+	}
+	m_readPos.fetchAndStoreOrdered( readPos );
+}
@@ -35,6 +35,7 @@ AudioPort::AudioPort( const QString & _name, bool _has_effect_chain ) :
 				engine::mixer()->framesPerPeriod()] ),
 	m_extOutputEnabled( false ),
 	m_nextFxChannel( 0 ),
+	m_lastOutputSlot( -1 ),
 	m_name( "unnamed port" ),
 	m_effects( _has_effect_chain ? new EffectChain( NULL ) : NULL )
 {
@@ -26,6 +26,7 @@
 
 #include "AudioSampleRecorder.h"
 #include "SampleBuffer.h"
+#include "SampleStreamWriter.h"
 #include "debug.h"
 
 
@@ -34,9 +35,14 @@ AudioSampleRecorder::AudioSampleRecorder( const ch_cnt_t _channels,
 							bool & _success_ful,
 							Mixer * _mixer ) :
 	AudioDevice( _channels, _mixer ),
-	m_buffers()
+	m_writer( new SampleStreamWriter(
+				SampleStreamWriter::newRecordingFile(),
+							sampleRate() ) ),
+	m_buffer( NULL ),
+	m_bufferSize( mixer()->framesPerPeriod() )
 {
-	_success_ful = true;
+	m_buffer = new sampleFrame[m_bufferSize];
+	_success_ful = m_writer->isOpen();
 }
 
 
@@ -44,11 +50,8 @@ AudioSampleRecorder::AudioSampleRecorder( const ch_cnt_t _channels,
 
 AudioSampleRecorder::~AudioSampleRecorder()
 {
-	while( !m_buffers.empty() )
-	{
-		delete[] m_buffers.front().first;
-		m_buffers.erase( m_buffers.begin() );
-	}
+	delete m_writer;
+	delete[] m_buffer;
 }
 
 
@@ -56,13 +59,7 @@ AudioSampleRecorder::~AudioSampleRecorder()
 
 f_cnt_t AudioSampleRecorder::framesRecorded() const
 {
-	f_cnt_t frames = 0;
-	for( BufferList::ConstIterator it = m_buffers.begin();
-						it != m_buffers.end(); ++it )
-	{
-		frames += ( *it ).second;
-	}
-	return frames;
+	return m_writer->framesWritten();
 }
 
 
@@ -70,27 +67,9 @@ f_cnt_t AudioSampleRecorder::framesRecorded() const
 
 void AudioSampleRecorder::createSampleBuffer( SampleBuffer** sampleBuf )
 {
-	const f_cnt_t frames = framesRecorded();
-	// create buffer to store all recorded buffers in
-	sampleFrame * data = new sampleFrame[frames];
-	// make sure buffer is cleaned up properly at the end...
-	sampleFrame * data_ptr = data;
-
-#ifdef LMMS_DEBUG
-	assert( data != NULL );
-#endif
-	// now copy all buffers into big buffer
-	for( BufferList::ConstIterator it = m_buffers.begin();
-						it != m_buffers.end(); ++it )
-	{
-		memcpy( data_ptr, ( *it ).first, ( *it ).second *
-							sizeof( sampleFrame ) );
-		data_ptr += ( *it ).second;
-	}
-	// create according sample-buffer out of big buffer
-	*sampleBuf = new SampleBuffer( data, frames );
-	( *sampleBuf )->setSampleRate( sampleRate() );
-	delete[] data;
+	// close file and load what has been recorded
+	m_writer->finish();
+	*sampleBuf = new SampleBuffer( m_writer->fileName() );
 }
 
 
@@ -99,16 +78,20 @@ void AudioSampleRecorder::createSampleBuffer( SampleBuffer** sampleBuf )
 void AudioSampleRecorder::writeBuffer( const surroundSampleFrame * _ab,
 					const fpp_t _frames, const float )
 {
-	sampleFrame * buf = new sampleFrame[_frames];
-	for( fpp_t frame = 0; frame < _frames; ++frame )
+	for( fpp_t done = 0; done < _frames; done += m_bufferSize )
 	{
-		for( ch_cnt_t chnl = 0; chnl < DEFAULT_CHANNELS; ++chnl )
+		const fpp_t frames = qMin<fpp_t>( _frames - done, m_bufferSize );
+		for( fpp_t frame = 0; frame < frames; ++frame )
 		{
-			buf[frame][chnl] = _ab[frame][chnl];
+			for( ch_cnt_t chnl = 0; chnl < DEFAULT_CHANNELS; ++chnl )
+			{
+				m_buffer[frame][chnl] = _ab[done + frame][chnl];
+			}
 		}
+		m_writer->write( m_buffer, frames );
 	}
-	m_buffers.push_back( qMakePair( buf, _frames ) );
 }
 
 
 
+
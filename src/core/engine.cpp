@@ -41,6 +41,7 @@
 #include "ProjectJournal.h"
 #include "project_notes.h"
 #include "Plugin.h"
+#include "PluginManifest.h"
 #include "SongEditor.h"
 #include "song.h"
 
@@ -157,16 +158,15 @@ void engine::updateFramesPerTick()
 
 void engine::initPluginFileHandling()
 {
-	Plugin::DescriptorList pluginDescriptors;
-	Plugin::getDescriptorsOfAvailPlugins( pluginDescriptors );
-	for( Plugin::DescriptorList::ConstIterator it = pluginDescriptors.begin();
-										it != pluginDescriptors.end(); ++it )
+	// use manifest so we do not have to load all plugins at startup
+	const PluginManifest::EntryList & entries = PluginManifest::entries();
+	for( PluginManifest::EntryList::ConstIterator it = entries.begin();
+												it != entries.end(); ++it )
 	{
 		if( it->type == Plugin::Instrument )
 		{
 			const QStringList & ext =
-				QString( it->supportedFileTypes ).
-							split( QChar( ',' ) );
+				it->supportedFileTypes.split( QChar( ',' ) );
 			for( QStringList::const_iterator itExt = ext.begin();
 						itExt != ext.end(); ++itExt )
 			{
@@ -25,20 +25,135 @@
  */
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QDataStream>
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
+#include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QLibrary>
 
 #include <math.h>
+#include <string.h>
 
 #include "config_mgr.h"
 #include "ladspa_manager.h"
 
 
 
+// increase whenever format of index changes
+static const quint32 LadspaIndexMagic = 0x4c414458;	// "LADX"
+static const quint32 LadspaIndexVersion = 1;
+
+
+
+
+static void freeIndexedDescriptor( const LADSPA_Descriptor * _descriptor )
+{
+	delete[] _descriptor->Label;
+	delete[] _descriptor->Name;
+	delete[] _descriptor->Maker;
+	delete[] _descriptor->Copyright;
+	for( unsigned long port = 0; port < _descriptor->PortCount; ++port )
+	{
+		delete[] _descriptor->PortNames[port];
+	}
+	delete[] _descriptor->PortDescriptors;
+	delete[] _descriptor->PortNames;
+	delete[] _descriptor->PortRangeHints;
+	delete _descriptor;
+}
+
+
+
+
+static LADSPA_Descriptor * readIndexedDescriptor( QDataStream & _in )
+{
+	quint32 uniqueID, portCount;
+	qint32 properties;
+	QByteArray label, name, maker, copyright;
+	_in >> uniqueID >> label >> name >> maker >> copyright
+					>> properties >> portCount;
+	if( _in.status() != QDataStream::Ok )
+	{
+		return NULL;
+	}
+
+	LADSPA_Descriptor * d = new LADSPA_Descriptor;
+	memset( d, 0, sizeof( *d ) );
+	d->UniqueID = uniqueID;
+	d->Label = qstrdup( label.constData() );
+	d->Name = qstrdup( name.constData() );
+	d->Maker = qstrdup( maker.constData() );
+	d->Copyright = qstrdup( copyright.constData() );
+	d->Properties = properties;
+
+	LADSPA_PortDescriptor * portDescriptors =
+					new LADSPA_PortDescriptor[portCount];
+	char * * portNames = new char *[portCount];
+	LADSPA_PortRangeHint * portRangeHints =
+					new LADSPA_PortRangeHint[portCount];
+	for( quint32 port = 0; port < portCount; ++port )
+	{
+		qint32 portDescriptor, hintDescriptor;
+		QByteArray portName;
+		float lowerBound, upperBound;
+		_in >> portDescriptor >> portName >> hintDescriptor
+						>> lowerBound >> upperBound;
+		portDescriptors[port] = portDescriptor;
+		portNames[port] = qstrdup( portName.constData() );
+		portRangeHints[port].HintDescriptor = hintDescriptor;
+		portRangeHints[port].LowerBound = lowerBound;
+		portRangeHints[port].UpperBound = upperBound;
+	}
+	d->PortCount = portCount;
+	d->PortDescriptors = portDescriptors;
+	d->PortNames = portNames;
+	d->PortRangeHints = portRangeHints;
+
+	if( _in.status() != QDataStream::Ok )
+	{
+		freeIndexedDescriptor( d );
+		return NULL;
+	}
+
+	return d;
+}
+
+
+
+
+static void writeIndexedDescriptor( QDataStream & _out,
+					const LADSPA_Descriptor * _descriptor )
+{
+	_out << (quint32) _descriptor->UniqueID
+		<< QByteArray( _descriptor->Label )
+		<< QByteArray( _descriptor->Name )
+		<< QByteArray( _descriptor->Maker )
+		<< QByteArray( _descriptor->Copyright )
+		<< (qint32) _descriptor->Properties
+		<< (quint32) _descriptor->PortCount;
+	for( unsigned long port = 0; port < _descriptor->PortCount; ++port )
+	{
+		_out << (qint32) _descriptor->PortDescriptors[port]
+			<< QByteArray( _descriptor->PortNames[port] )
+			<< (qint32) _descriptor->PortRangeHints[port].HintDescriptor
+			<< (float) _descriptor->PortRangeHints[port].LowerBound
+			<< (float) _descriptor->PortRangeHints[port].UpperBound;
+	}
+}
+
+
+
+
 ladspaManager::ladspaManager()
 {
+	// information about all libraries found at last run - libraries which
+	// have not changed since then do not have to be loaded at all
+	libraryInfoMap index;
+	loadIndex( index );
+
+	bool indexChanged = false;
+
 	QStringList ladspaDirectories = QString( getenv( "LADSPA_PATH" ) ).
 								split( LADSPA_PATH_SEPERATOR );
 	ladspaDirectories += configManager::inst()->ladspaDir().split( ',' );
@@ -73,25 +188,81 @@ ladspaManager::ladspaManager()
 				continue;
 			}
 
-			QLibrary plugin_lib( f.absoluteFilePath() );
+			const QString path = f.absoluteFilePath();
+			if( m_libraries.contains( path ) )
+			{
+				continue;
+			}
+
+			libraryInfoMap::ConstIterator indexed = index.find( path );
+			if( indexed != index.end() &&
+				indexed->size == f.size() &&
+				indexed->lastModified == f.lastModified().toTime_t() )
+			{
+				m_libraries[path] = *indexed;
+				addPlugins( *indexed, NULL, f );
+				continue;
+			}
+
+			indexChanged = true;
+
+			QLibrary plugin_lib( path );
 
 			if( plugin_lib.load() == true )
 			{
 				LADSPA_Descriptor_Function descriptorFunction =
 			( LADSPA_Descriptor_Function ) plugin_lib.resolve(
 							"ladspa_descriptor" );
+				// also remember libraries without LADSPA plug-ins
+				// so we do not load them again next time
+				libraryInfo library;
+				library.size = f.size();
+				library.lastModified = f.lastModified().toTime_t();
 				if( descriptorFunction != NULL )
 				{
-					addPlugins( descriptorFunction,
-							f.fileName() );
+					const LADSPA_Descriptor * descriptor;
+					for( long pluginIndex = 0;
+						( descriptor = descriptorFunction( pluginIndex ) ) != NULL;
+								++pluginIndex )
+					{
+						library.descriptors << descriptor;
+					}
 				}
+				m_libraries[path] = library;
+				addPlugins( library, descriptorFunction, f );
 			}
 			else
 			{
 				qWarning() << plugin_lib.errorString();
+				// remember libraries which failed to load as well so
+				// we do not try again (and rewrite the index) unless
+				// they change
+				libraryInfo library;
+				library.size = f.size();
+				library.lastModified = f.lastModified().toTime_t();
+				m_libraries[path] = library;
+			}
+		}
+	}
+
+	// free indexed descriptors of libraries which changed or disappeared
+	for( libraryInfoMap::ConstIterator it = index.begin();
+						it != index.end(); ++it )
+	{
+		if( !m_libraries.contains( it.key() ) ||
+				m_libraries[it.key()].fromIndex == false )
+		{
+			foreach( const LADSPA_Descriptor * d, it->descriptors )
+			{
+				freeIndexedDescriptor( d );
 			}
 		}
 	}
+
+	if( indexChanged || index.size() != m_libraries.size() )
+	{
+		saveIndex();
+	}
 	
 	l_ladspa_key_t keys = m_ladspaManagerMap.keys();
 	for( l_ladspa_key_t::iterator it = keys.begin();
@@ -112,6 +283,18 @@ ladspaManager::~ladspaManager()
 	{
 		delete it.value();
 	}
+
+	for( libraryInfoMap::ConstIterator it = m_libraries.begin();
+						it != m_libraries.end(); ++it )
+	{
+		if( it->fromIndex )
+		{
+			foreach( const LADSPA_Descriptor * d, it->descriptors )
+			{
+				freeIndexedDescriptor( d );
+			}
+		}
+	}
 }
 
 
@@ -133,17 +316,17 @@ ladspaManagerDescription * ladspaManager::getDescription(
 
 
 
-void ladspaManager::addPlugins(
+void ladspaManager::addPlugins( const libraryInfo & _library,
 		LADSPA_Descriptor_Function _descriptor_func,
-						const QString & _file )
+						const QFileInfo & _file )
 {
-	const LADSPA_Descriptor * descriptor;
-
-	for( long pluginIndex = 0;
-		( descriptor = _descriptor_func( pluginIndex ) ) != NULL;
+	for( int pluginIndex = 0; pluginIndex < _library.descriptors.size();
 								++pluginIndex )
 	{
-		ladspa_key_t key( _file, QString( descriptor->Label ) );
+		const LADSPA_Descriptor * descriptor =
+					_library.descriptors[pluginIndex];
+		ladspa_key_t key( _file.fileName(),
+					QString( descriptor->Label ) );
 		if( m_ladspaManagerMap.contains( key ) )
 		{
 			continue;
@@ -152,6 +335,7 @@ void ladspaManager::addPlugins(
 		ladspaManagerDescription * plugIn = 
 				new ladspaManagerDescription;
 		plugIn->descriptorFunction = _descriptor_func;
+		plugIn->filePath = _file.absoluteFilePath();
 		plugIn->index = pluginIndex;
 		plugIn->inputChannels = getPluginInputs( descriptor );
 		plugIn->outputChannels = getPluginOutputs( descriptor );
@@ -182,6 +366,169 @@ void ladspaManager::addPlugins(
 
 
 
+const LADSPA_Descriptor * ladspaManager::metaDescriptor(
+						const ladspa_key_t & _plugin )
+{
+	const ladspaManagerDescription * plugIn = m_ladspaManagerMap[_plugin];
+	if( plugIn->descriptorFunction != NULL )
+	{
+		return( plugIn->descriptorFunction( plugIn->index ) );
+	}
+	return( m_libraries[plugIn->filePath].descriptors[plugIn->index] );
+}
+
+
+
+
+const LADSPA_Descriptor * ladspaManager::loadedDescriptor(
+						const ladspa_key_t & _plugin )
+{
+	ladspaManagerDescription * plugIn = m_ladspaManagerMap.value( _plugin );
+	if( plugIn == NULL )
+	{
+		return( NULL );
+	}
+
+	if( plugIn->descriptorFunction == NULL )
+	{
+		QMutexLocker ml( &m_loadMutex );
+		if( plugIn->descriptorFunction != NULL )
+		{
+			// loaded by another thread meanwhile
+			return( plugIn->descriptorFunction( plugIn->index ) );
+		}
+
+		QLibrary plugin_lib( plugIn->filePath );
+		if( plugin_lib.load() == false )
+		{
+			qWarning() << plugin_lib.errorString();
+			return( NULL );
+		}
+		LADSPA_Descriptor_Function descriptorFunction =
+			( LADSPA_Descriptor_Function ) plugin_lib.resolve(
+							"ladspa_descriptor" );
+		if( descriptorFunction == NULL )
+		{
+			return( NULL );
+		}
+
+		// all plug-ins of this library are available now
+		for( ladspaManagerMapType::ConstIterator it =
+						m_ladspaManagerMap.constBegin();
+					it != m_ladspaManagerMap.constEnd(); ++it )
+		{
+			if( it.value()->filePath == plugIn->filePath )
+			{
+				it.value()->descriptorFunction =
+							descriptorFunction;
+			}
+		}
+	}
+
+	return( plugIn->descriptorFunction( plugIn->index ) );
+}
+
+
+
+
+QString ladspaManager::indexFile()
+{
+	return( configManager::inst()->cacheDir() + "ladspa.index" );
+}
+
+
+
+
+void ladspaManager::loadIndex( libraryInfoMap & _index )
+{
+	QFile f( indexFile() );
+	if( !f.open( QFile::ReadOnly ) )
+	{
+		return;
+	}
+
+	QDataStream in( &f );
+	in.setVersion( QDataStream::Qt_4_0 );
+
+	quint32 magic, version, libraryCount;
+	in >> magic >> version >> libraryCount;
+	if( magic != LadspaIndexMagic || version != LadspaIndexVersion )
+	{
+		return;
+	}
+
+	for( quint32 i = 0; i < libraryCount &&
+				in.status() == QDataStream::Ok; ++i )
+	{
+		QString path;
+		libraryInfo library;
+		quint32 lastModified, descriptorCount;
+		in >> path >> library.size >> lastModified >> descriptorCount;
+		library.lastModified = lastModified;
+		library.fromIndex = true;
+
+		for( quint32 d = 0; d < descriptorCount; ++d )
+		{
+			const LADSPA_Descriptor * descriptor =
+						readIndexedDescriptor( in );
+			if( descriptor == NULL )
+			{
+				break;
+			}
+			library.descriptors << descriptor;
+		}
+		_index[path] = library;
+	}
+
+	if( in.status() != QDataStream::Ok )
+	{
+		// corrupt index - just discard everything
+		for( libraryInfoMap::ConstIterator it = _index.begin();
+						it != _index.end(); ++it )
+		{
+			foreach( const LADSPA_Descriptor * d, it->descriptors )
+			{
+				freeIndexedDescriptor( d );
+			}
+		}
+		_index.clear();
+	}
+}
+
+
+
+
+void ladspaManager::saveIndex()
+{
+	QDir().mkpath( configManager::inst()->cacheDir() );
+
+	QFile f( indexFile() );
+	if( !f.open( QFile::WriteOnly | QFile::Truncate ) )
+	{
+		return;
+	}
+
+	QDataStream out( &f );
+	out.setVersion( QDataStream::Qt_4_0 );
+
+	out << LadspaIndexMagic << LadspaIndexVersion
+				<< (quint32) m_libraries.size();
+
+	for( libraryInfoMap::ConstIterator it = m_libraries.begin();
+						it != m_libraries.end(); ++it )
+	{
+		out << it.key() << it->size << (quint32) it->lastModified
+				<< (quint32) it->descriptors.size();
+		foreach( const LADSPA_Descriptor * d, it->descriptors )
+		{
+			writeIndexedDescriptor( out, d );
+		}
+	}
+}
+
+
+
+
 uint16_t ladspaManager::getPluginInputs( 
 		const LADSPA_Descriptor * _descriptor )
 {
@@ -246,11 +593,8 @@ QString ladspaManager::getLabel( const ladspa_key_t & _plugin )
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
-		const LADSPA_Descriptor * descriptor = 
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+		const LADSPA_Descriptor * descriptor =
+						metaDescriptor( _plugin );
 		return( QString( descriptor->Label ) );
 	}
 	else
@@ -267,11 +611,8 @@ bool ladspaManager::hasRealTimeDependency(
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		return( LADSPA_IS_REALTIME( descriptor->Properties ) );
 	}
 	else
@@ -287,11 +628,8 @@ bool ladspaManager::isInplaceBroken( const ladspa_key_t &  _plugin )
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		return( LADSPA_IS_INPLACE_BROKEN( descriptor->Properties ) );
 	}
 	else
@@ -308,11 +646,8 @@ bool ladspaManager::isRealTimeCapable(
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		return( LADSPA_IS_HARD_RT_CAPABLE( descriptor->Properties ) );
 	}
 	else
@@ -328,11 +663,8 @@ QString ladspaManager::getName( const ladspa_key_t & _plugin )
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		return( QString( descriptor->Name ) );
 	}
 	else
@@ -348,11 +680,8 @@ QString ladspaManager::getMaker( const ladspa_key_t & _plugin )
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		return( QString( descriptor->Maker ) );
 	}
 	else
@@ -368,11 +697,8 @@ QString ladspaManager::getCopyright( const ladspa_key_t & _plugin )
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		return( QString( descriptor->Copyright ) );
 	}
 	else
@@ -388,11 +714,8 @@ uint32_t ladspaManager::getPortCount( const ladspa_key_t & _plugin )
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		return( descriptor->PortCount );
 	}
 	else
@@ -410,11 +733,8 @@ bool ladspaManager::isPortInput( const ladspa_key_t & _plugin,
 	if( m_ladspaManagerMap.contains( _plugin ) 
 		&& _port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		
 		return( LADSPA_IS_PORT_INPUT
 				( descriptor->PortDescriptors[_port] ) );
@@ -434,11 +754,8 @@ bool ladspaManager::isPortOutput( const ladspa_key_t & _plugin,
 	if( m_ladspaManagerMap.contains( _plugin ) 
 		   && _port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		
 		return( LADSPA_IS_PORT_OUTPUT
 				( descriptor->PortDescriptors[_port] ) );
@@ -458,11 +775,8 @@ bool ladspaManager::isPortAudio( const ladspa_key_t & _plugin,
 	if( m_ladspaManagerMap.contains( _plugin ) 
 		   && _port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		
 		return( LADSPA_IS_PORT_AUDIO
 				( descriptor->PortDescriptors[_port] ) );
@@ -482,11 +796,8 @@ bool ladspaManager::isPortControl( const ladspa_key_t & _plugin,
 	if( m_ladspaManagerMap.contains( _plugin ) 
 		   && _port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		
 		return( LADSPA_IS_PORT_CONTROL
 				( descriptor->PortDescriptors[_port] ) );
@@ -507,11 +818,8 @@ bool ladspaManager::areHintsSampleRateDependent(
 	if( m_ladspaManagerMap.contains( _plugin ) 
 		   && _port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		LADSPA_PortRangeHintDescriptor hintDescriptor =
 			descriptor->PortRangeHints[_port].HintDescriptor;
 		return( LADSPA_IS_HINT_SAMPLE_RATE ( hintDescriptor ) );
@@ -531,11 +839,8 @@ float ladspaManager::getLowerBound( const ladspa_key_t & _plugin,
 	if( m_ladspaManagerMap.contains( _plugin ) 
 		   && _port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		LADSPA_PortRangeHintDescriptor hintDescriptor =
 			descriptor->PortRangeHints[_port].HintDescriptor;
 		if( LADSPA_IS_HINT_BOUNDED_BELOW( hintDescriptor ) )
@@ -561,11 +866,8 @@ float ladspaManager::getUpperBound( const ladspa_key_t & _plugin,									uint32
 	if( m_ladspaManagerMap.contains( _plugin ) 
 		   && _port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		LADSPA_PortRangeHintDescriptor hintDescriptor =
 			descriptor->PortRangeHints[_port].HintDescriptor;
 		if( LADSPA_IS_HINT_BOUNDED_ABOVE( hintDescriptor ) )
@@ -592,11 +894,8 @@ bool ladspaManager::isPortToggled( const ladspa_key_t & _plugin,
 	if( m_ladspaManagerMap.contains( _plugin ) 
 		   && _port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		LADSPA_PortRangeHintDescriptor hintDescriptor =
 			descriptor->PortRangeHints[_port].HintDescriptor;
 		return( LADSPA_IS_HINT_TOGGLED( hintDescriptor ) );
@@ -616,11 +915,8 @@ float ladspaManager::getDefaultSetting( const ladspa_key_t & _plugin,
 	if( m_ladspaManagerMap.contains( _plugin ) 
 		   && _port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		LADSPA_PortRangeHintDescriptor hintDescriptor =
 			descriptor->PortRangeHints[_port].HintDescriptor;
 		switch( hintDescriptor & LADSPA_HINT_DEFAULT_MASK ) 
@@ -703,11 +999,8 @@ bool ladspaManager::isLogarithmic( const ladspa_key_t & _plugin,
 	if( m_ladspaManagerMap.contains( _plugin ) 
 		   && _port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		LADSPA_PortRangeHintDescriptor hintDescriptor =
 			descriptor->PortRangeHints[_port].HintDescriptor;
 		return( LADSPA_IS_HINT_LOGARITHMIC( hintDescriptor ) );
@@ -727,11 +1020,8 @@ bool ladspaManager::isInteger( const ladspa_key_t & _plugin,
 	if( m_ladspaManagerMap.contains( _plugin ) 
 		   && _port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 		LADSPA_PortRangeHintDescriptor hintDescriptor =
 			descriptor->PortRangeHints[_port].HintDescriptor;
 		return( LADSPA_IS_HINT_INTEGER( hintDescriptor ) );
@@ -751,11 +1041,8 @@ QString ladspaManager::getPortName( const ladspa_key_t & _plugin,
 	if( m_ladspaManagerMap.contains( _plugin ) &&
 					_port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						metaDescriptor( _plugin );
 
 		return( QString( descriptor->PortNames[_port] ) );
 	}
@@ -773,11 +1060,12 @@ const void * ladspaManager::getImplementationData(
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						loadedDescriptor( _plugin );
+		if( descriptor == NULL )
+		{
+			return( NULL );
+		}
 		return( descriptor->ImplementationData );
 	}
 	else
@@ -794,11 +1082,12 @@ const LADSPA_Descriptor * ladspaManager::getDescriptor(
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						loadedDescriptor( _plugin );
+		if( descriptor == NULL )
+		{
+			return( NULL );
+		}
 		return( descriptor );
 	}
 	else
@@ -816,11 +1105,12 @@ LADSPA_Handle ladspaManager::instantiate(
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						loadedDescriptor( _plugin );
+		if( descriptor == NULL )
+		{
+			return( NULL );
+		}
 		return( ( descriptor->instantiate )
 						( descriptor, _sample_rate ) );
 	}
@@ -841,11 +1131,12 @@ bool ladspaManager::connectPort( const ladspa_key_t & _plugin,
 	if( m_ladspaManagerMap.contains( _plugin ) 
 		&& _port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						loadedDescriptor( _plugin );
+		if( descriptor == NULL )
+		{
+			return( false );
+		}
 		if( descriptor->connect_port != NULL )
 		{
 			( descriptor->connect_port )
@@ -864,11 +1155,12 @@ bool ladspaManager::activate( const ladspa_key_t & _plugin,
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						loadedDescriptor( _plugin );
+		if( descriptor == NULL )
+		{
+			return( false );
+		}
 		if( descriptor->activate != NULL )
 		{
 			( descriptor->activate ) ( _instance );
@@ -887,11 +1179,12 @@ bool ladspaManager::run( const ladspa_key_t & _plugin,
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						loadedDescriptor( _plugin );
+		if( descriptor == NULL )
+		{
+			return( false );
+		}
 		if( descriptor->run != NULL )
 		{
 			( descriptor->run ) ( _instance, _sample_count );
@@ -910,11 +1203,12 @@ bool ladspaManager::runAdding( const ladspa_key_t & _plugin,
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						loadedDescriptor( _plugin );
+		if( descriptor == NULL )
+		{
+			return( false );
+		}
 		if( descriptor->run_adding != NULL &&
 			  	descriptor->set_run_adding_gain != NULL )
 		{
@@ -934,11 +1228,12 @@ bool ladspaManager::setRunAddingGain( const ladspa_key_t & _plugin,
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						loadedDescriptor( _plugin );
+		if( descriptor == NULL )
+		{
+			return( false );
+		}
 		if( descriptor->run_adding != NULL &&
 				  descriptor->set_run_adding_gain != NULL )
 		{
@@ -958,11 +1253,12 @@ bool ladspaManager::deactivate( const ladspa_key_t & _plugin,
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						loadedDescriptor( _plugin );
+		if( descriptor == NULL )
+		{
+			return( false );
+		}
 		if( descriptor->deactivate != NULL )
 		{
 			( descriptor->deactivate ) ( _instance );
@@ -980,11 +1276,12 @@ bool ladspaManager::cleanup( const ladspa_key_t & _plugin,
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
 		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+						loadedDescriptor( _plugin );
+		if( descriptor == NULL )
+		{
+			return( false );
+		}
 		if( descriptor->cleanup != NULL )
 		{
 			( descriptor->cleanup ) ( _instance );
@@ -88,10 +88,7 @@ note::note( const note & _note ) :
 
 note::~note()
 {
-	if( m_detuning )
-	{
-		sharedObject::unref( m_detuning );
-	}
+	releaseDetuning();
 }
 
 
@@ -240,3 +237,15 @@ bool note::hasDetuningInfo() const
 
 
 
+void note::releaseDetuning()
+{
+	if( m_detuning )
+	{
+		sharedObject::unref( m_detuning );
+		m_detuning = NULL;
+	}
+}
+
+
+
+
@@ -1004,7 +1004,21 @@ void song::loadProject( const QString & _file_name )
 bool song::saveProjectFile( const QString & _filename )
 {
 	DataFile dataFile( DataFile::SongProject );
+	if( dataFile.nameWithExtension( _filename ).section( '.', -1 ) == "mmpb" )
+	{
+		// store samples directly in binary project without base64 encoding
+		dataFile.setKeepEmbeddedDataRaw();
+	}
+	saveProjectData( dataFile );
+
+	return dataFile.writeFile( _filename );
+}
+
 
+
+
+void song::saveProjectData( DataFile & dataFile )
+{
 	m_tempoModel.saveSettings( dataFile, dataFile.head(), "bpm" );
 	m_timeSigModel.saveSettings( dataFile, dataFile.head(), "timesig" );
 	m_masterVolumeModel.saveSettings( dataFile, dataFile.head(), "mastervol" );
@@ -1026,8 +1040,6 @@ bool song::saveProjectFile( const QString & _filename )
 	}
 
 	saveControllerStates( dataFile, dataFile.content() );
-
-    return dataFile.writeFile( _filename );
 }
 
 
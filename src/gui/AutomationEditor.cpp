@@ -2204,12 +2204,14 @@ void AutomationEditor::pasteValues()
 	QMutexLocker m( &m_patternMutex );
 	if( validPattern() && !m_valuesToCopy.isEmpty() )
 	{
+		m_pattern->beginBatchEdit();
 		for( timeMap::iterator it = m_valuesToCopy.begin();
 					it != m_valuesToCopy.end(); ++it )
 		{
 			m_pattern->putValue( it.key() + m_currentPosition,
 								it.value() );
 		}
+		m_pattern->commitBatchEdit();
 
 		// we only have to do the following lines if we pasted at
 		// least one value...
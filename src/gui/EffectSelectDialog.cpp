@@ -28,6 +28,7 @@
 
 #include "gui_templates.h"
 #include "embed.h"
+#include "PluginManifest.h"
 
 
 EffectSelectDialog::EffectSelectDialog( QWidget * _parent ) :
@@ -42,7 +43,7 @@ EffectSelectDialog::EffectSelectDialog( QWidget * _parent ) :
 	setWindowIcon( embed::getIconPixmap( "setup_audio" ) );
 
 	// query effects
-	Plugin::getDescriptorsOfAvailPlugins( m_pluginDescriptors );
+	PluginManifest::descriptorsOfType( Plugin::Effect, m_pluginDescriptors );
 
 	EffectKeyList subPluginEffectKeys;
 
@@ -22,11 +22,15 @@
  *
  */
 
+#include <QtCore/QMap>
 #include <QtGui/QButtonGroup>
+#include <QtGui/QContextMenuEvent>
 #include <QtGui/QInputDialog>
 #include <QtGui/QLayout>
 #include <QtGui/QMdiArea>
 #include <QtGui/QMdiSubWindow>
+#include <QtGui/QMenu>
+#include <QtGui/QMessageBox>
 #include <QtGui/QPainter>
 #include <QtGui/QPushButton>
 #include <QtGui/QToolButton>
@@ -98,6 +102,11 @@ public:
 		m_mv->setCurrentFxLine( this );
 	}
 
+	virtual void contextMenuEvent( QContextMenuEvent * _ev )
+	{
+		m_mv->showSendsMenu( this, _ev->globalPos() );
+	}
+
 	virtual void mouseDoubleClickEvent( QMouseEvent * )
 	{
 		bool ok;
@@ -123,10 +132,15 @@ private:
 
 
 
+// number of FX lines per bank
+const int FxLinesPerBank = 16;
+
+
 FxMixerView::FxMixerView() :
 	QWidget(),
 	ModelView( NULL, this ),
-	SerializingObjectHook()
+	SerializingObjectHook(),
+	m_currentFxLine( NULL )
 {
 	FxMixer * m = engine::fxMixer();
 	m->setHook( this );
@@ -151,105 +165,52 @@ FxMixerView::FxMixerView() :
 	m_fxRacksLayout->setMargin( 0 );
 
 	// main-layout
-	QHBoxLayout * ml = new QHBoxLayout;
-	ml->setMargin( 0 );
-	ml->setSpacing( 0 );
-	ml->addSpacing( 6 );
-
-
-	QHBoxLayout * banks[NumFxChannels/16];
-	for( int i = 0; i < NumFxChannels/16; ++i )
-	{
-		QWidget * w = new QWidget( this );
-		banks[i] = new QHBoxLayout( w );
-		banks[i]->setMargin( 5 );
-		banks[i]->setSpacing( 1 );
-		m_fxLineBanks->addWidget( w );
-	}
+	m_mainLayout = new QHBoxLayout;
+	m_mainLayout->setMargin( 0 );
+	m_mainLayout->setSpacing( 0 );
+	m_mainLayout->addSpacing( 6 );
+
+	// master channel
+	addChannelView();
+	m_mainLayout->addWidget( m_fxChannelViews[0].m_fxLine );
+	m_mainLayout->addSpacing( 10 );
+
+	// bank selectors - buttons are added along with banks
+	QVBoxLayout * l = new QVBoxLayout;
+	l->addSpacing( 10 );
+	m_bankButtons = new QButtonGroup( this );
+	m_bankButtons->setExclusive( true );
+	m_bankButtonsLayout = new QVBoxLayout;
+	m_bankButtonsLayout->setSpacing( 0 );
+	l->addLayout( m_bankButtonsLayout );
+
+	QToolButton * addBtn = new QToolButton;
+	addBtn->setText( "+" );
+	toolTip::add( addBtn, tr( "Add new FX channel" ) );
+	connect( addBtn, SIGNAL( clicked() ), this, SLOT( addChannel() ) );
+	l->addWidget( addBtn );
+	l->addSpacing( 10 );
+	m_mainLayout->addLayout( l );
+	connect( m_bankButtons, SIGNAL( buttonClicked( int ) ),
+			m_fxLineBanks, SLOT( setCurrentIndex( int ) ) );
+
+	m_mainLayout->addLayout( m_fxLineBanks );
+	m_mainLayout->addLayout( m_fxRacksLayout );
+
+	setLayout( m_mainLayout );
+
+	updateChannelViews();
 
-	for( int i = 0; i < NumFxChannels+1; ++i )
-	{
-		FxChannelView * cv = &m_fxChannelViews[i];
-		if( i == 0 )
-		{
-			cv->m_fxLine = new FxLine( NULL, this,
-						m->m_fxChannels[i]->m_name  );
-			ml->addWidget( cv->m_fxLine );
-			ml->addSpacing( 10 );
-		}
-		else
-		{
-			const int bank = (i-1) / 16;
-			cv->m_fxLine = new FxLine( NULL, this,
-						m->m_fxChannels[i]->m_name );
-			banks[bank]->addWidget( cv->m_fxLine );
-		}
-		LcdWidget* l = new LcdWidget( 2, cv->m_fxLine );
-		l->setValue( i );
-		l->move( 3, 4 );
-		l->setMarginWidth( 1 );
-
-
-		cv->m_fader = new fader( &m->m_fxChannels[i]->m_volumeModel,
-						tr( "FX Fader %1" ).arg( i ),
-								cv->m_fxLine );
-		cv->m_fader->move( 15-cv->m_fader->width()/2,
-						cv->m_fxLine->height()-
-						cv->m_fader->height()-5 );
-
-		cv->m_muteBtn = new pixmapButton( cv->m_fxLine, tr( "Mute" ) );
-		cv->m_muteBtn->setModel( &m->m_fxChannels[i]->m_muteModel );
-		cv->m_muteBtn->setActiveGraphic(
-					embed::getIconPixmap( "led_off" ) );
-		cv->m_muteBtn->setInactiveGraphic(
-					embed::getIconPixmap( "led_green" ) );
-		cv->m_muteBtn->setCheckable( true );
-		cv->m_muteBtn->move( 9,  cv->m_fader->y()-16);
-		toolTip::add( cv->m_muteBtn, tr( "Mute this FX channel" ) );
-
-		cv->m_rackView = new EffectRackView(
-				&m->m_fxChannels[i]->m_fxChain, this );
-		cv->m_rackView->setMinimumWidth( 244 );
-
-		m_fxRacksLayout->addWidget( cv->m_rackView );
-		if( i == 0 )
-		{
-			QVBoxLayout * l = new QVBoxLayout;
-			l->addSpacing( 10 );
-			QButtonGroup * g = new QButtonGroup( this );
-			m_bankButtons = g;
-			g->setExclusive( true );
-			for( int j = 0; j < 4; ++j )
-			{
-				QToolButton * btn = new QToolButton;
-				btn->setText( QString( 'A'+j ) );
-				btn->setCheckable( true );
-				btn->setSizePolicy( QSizePolicy::Preferred,
-						QSizePolicy::Expanding );
-				l->addWidget( btn );
-				g->addButton( btn, j );
-				btn->setChecked( j == 0);
-			}
-			l->addSpacing( 10 );
-			ml->addLayout( l );
-			connect( g, SIGNAL( buttonClicked( int ) ),
-				m_fxLineBanks, SLOT( setCurrentIndex( int ) ) );
-		}
-	}
-
-	ml->addLayout( m_fxLineBanks );
-	ml->addLayout( m_fxRacksLayout );
-
-	setLayout( ml );
-	updateGeometry();
-
-	m_fxLineBanks->setCurrentIndex( 0 );
 	setCurrentFxLine( m_fxChannelViews[0].m_fxLine );
 
 	// timer for updating faders
 	connect( engine::mainWindow(), SIGNAL( periodicUpdate() ),
 					this, SLOT( updateFaders() ) );
 
+	// channels are created on demand (e.g. when loading a project)
+	connect( m, SIGNAL( dataChanged() ),
+					this, SLOT( updateChannelViews() ) );
+
 
 	// add ourself to workspace
 	QMdiSubWindow * subWin =
@@ -270,6 +231,164 @@ FxMixerView::FxMixerView() :
 
 
 
+void FxMixerView::addChannelView()
+{
+	FxMixer * m = engine::fxMixer();
+	const int i = m_fxChannelViews.size();
+
+	FxChannelView cv;
+	if( i == 0 )
+	{
+		cv.m_fxLine = new FxLine( NULL, this, m->m_fxChannels[i]->m_name );
+	}
+	else
+	{
+		// add a new bank if required
+		const int bank = ( i - 1 ) / FxLinesPerBank;
+		while( bank >= m_banks.size() )
+		{
+			addBank();
+		}
+		cv.m_fxLine = new FxLine( NULL, this, m->m_fxChannels[i]->m_name );
+		m_banks[bank]->addWidget( cv.m_fxLine );
+	}
+
+	LcdWidget* l = new LcdWidget( 3, cv.m_fxLine );
+	l->setValue( i );
+	l->move( 3, 4 );
+	l->setMarginWidth( 1 );
+
+
+	cv.m_fader = new fader( &m->m_fxChannels[i]->m_volumeModel,
+					tr( "FX Fader %1" ).arg( i ),
+							cv.m_fxLine );
+	cv.m_fader->move( 15-cv.m_fader->width()/2,
+					cv.m_fxLine->height()-
+					cv.m_fader->height()-5 );
+
+	cv.m_muteBtn = new pixmapButton( cv.m_fxLine, tr( "Mute" ) );
+	cv.m_muteBtn->setModel( &m->m_fxChannels[i]->m_muteModel );
+	cv.m_muteBtn->setActiveGraphic(
+				embed::getIconPixmap( "led_off" ) );
+	cv.m_muteBtn->setInactiveGraphic(
+				embed::getIconPixmap( "led_green" ) );
+	cv.m_muteBtn->setCheckable( true );
+	cv.m_muteBtn->move( 9,  cv.m_fader->y()-16);
+	toolTip::add( cv.m_muteBtn, tr( "Mute this FX channel" ) );
+
+	cv.m_rackView = new EffectRackView(
+			&m->m_fxChannels[i]->m_fxChain, this );
+	cv.m_rackView->setMinimumWidth( 244 );
+
+	m_fxRacksLayout->addWidget( cv.m_rackView );
+
+	if( i > 0 )
+	{
+		cv.m_fxLine->show();
+	}
+
+	m_fxChannelViews.push_back( cv );
+}
+
+
+
+
+void FxMixerView::removeChannelView()
+{
+	FxChannelView cv = m_fxChannelViews.last();
+	m_fxChannelViews.pop_back();
+
+	if( m_currentFxLine == cv.m_fxLine )
+	{
+		m_currentFxLine = m_fxChannelViews[0].m_fxLine;
+		m_fxRacksLayout->setCurrentIndex( 0 );
+	}
+
+	m_fxRacksLayout->removeWidget( cv.m_rackView );
+	delete cv.m_rackView;
+	delete cv.m_fxLine;
+
+	// remove banks which became empty
+	const int banksNeeded = ( m_fxChannelViews.size() - 1 +
+					FxLinesPerBank - 1 ) / FxLinesPerBank;
+	while( m_banks.size() > qMax( banksNeeded, 1 ) )
+	{
+		QWidget * w = m_banks.last()->parentWidget();
+		m_banks.pop_back();
+		m_fxLineBanks->removeWidget( w );
+		delete w;
+
+		QAbstractButton * btn = m_bankButtons->button( m_banks.size() );
+		m_bankButtons->removeButton( btn );
+		delete btn;
+	}
+}
+
+
+
+
+void FxMixerView::updateChannelViews()
+{
+	const int numChannels = engine::fxMixer()->numChannels();
+	while( m_fxChannelViews.size() < numChannels )
+	{
+		addChannelView();
+	}
+	while( m_fxChannelViews.size() > numChannels )
+	{
+		removeChannelView();
+	}
+
+	// always provide at least one (possibly empty) bank
+	if( m_banks.isEmpty() )
+	{
+		addBank();
+	}
+
+	if( m_bankButtons->checkedButton() == NULL && m_bankButtons->button( 0 ) )
+	{
+		m_bankButtons->button( 0 )->setChecked( true );
+		m_fxLineBanks->setCurrentIndex( 0 );
+	}
+
+	updateGeometry();
+}
+
+
+
+
+void FxMixerView::addBank()
+{
+	const int bank = m_banks.size();
+
+	QWidget * w = new QWidget( this );
+	QHBoxLayout * b = new QHBoxLayout( w );
+	b->setMargin( 5 );
+	b->setSpacing( 1 );
+	b->setAlignment( Qt::AlignLeft );
+	m_fxLineBanks->addWidget( w );
+	m_banks.push_back( b );
+
+	QToolButton * btn = new QToolButton;
+	btn->setText( bank < 26 ? QString( 'A'+bank ) :
+					QString::number( bank+1 ) );
+	btn->setCheckable( true );
+	btn->setSizePolicy( QSizePolicy::Preferred, QSizePolicy::Expanding );
+	m_bankButtonsLayout->addWidget( btn );
+	m_bankButtons->addButton( btn, bank );
+}
+
+
+
+
+void FxMixerView::addChannel()
+{
+	setCurrentFxLine( engine::fxMixer()->createChannel() );
+}
+
+
+
+
 FxMixerView::~FxMixerView()
 {
 }
@@ -296,7 +415,7 @@ void FxMixerView::loadSettings( const QDomElement & _this )
 void FxMixerView::setCurrentFxLine( FxLine * _line )
 {
 	m_currentFxLine = _line;
-	for( int i = 0; i < NumFxChannels+1; ++i )
+	for( int i = 0; i < m_fxChannelViews.size(); ++i )
 	{
 		if( m_fxChannelViews[i].m_fxLine == _line )
 		{
@@ -310,11 +429,100 @@ void FxMixerView::setCurrentFxLine( FxLine * _line )
 
 void FxMixerView::setCurrentFxLine( int _line )
 {
-	if ( _line >= 0 && _line < NumFxChannels+1 )
+	if ( _line >= 0 && _line < m_fxChannelViews.size() )
 	{
 		setCurrentFxLine( m_fxChannelViews[_line].m_fxLine );
 
-		m_bankButtons->button( (_line-1) / 16 )->click();
+		if( _line > 0 )
+		{
+			m_bankButtons->button( (_line-1) / FxLinesPerBank )->click();
+		}
+	}
+}
+
+
+
+
+void FxMixerView::showSendsMenu( FxLine * _line, const QPoint & _pos )
+{
+	FxMixer * m = engine::fxMixer();
+
+	int ch = 0;
+	while( ch < m_fxChannelViews.size() &&
+				m_fxChannelViews[ch].m_fxLine != _line )
+	{
+		++ch;
+	}
+	// master can't be sent anywhere
+	if( ch == 0 || ch >= m_fxChannelViews.size() )
+	{
+		return;
+	}
+
+	QMenu menu( this );
+	QAction * addSendAction = menu.addAction( tr( "Add send..." ) );
+	QMap<QAction *, fx_ch_t> amountActions;
+	QMap<QAction *, fx_ch_t> removeActions;
+
+	const FxSendVector & sends = m->m_fxChannels[ch]->m_sends;
+	if( !sends.isEmpty() )
+	{
+		menu.addSeparator();
+	}
+	for( FxSendVector::ConstIterator it = sends.begin(); it != sends.end(); ++it )
+	{
+		const fx_ch_t target = ( *it )->m_target;
+		QMenu * sendMenu = menu.addMenu( tr( "Send to %1 (%2%)" ).
+				arg( m->m_fxChannels[target]->m_name ).
+				arg( qRound( ( *it )->m_amountModel.value() * 100 ) ) );
+		amountActions[sendMenu->addAction( tr( "Change amount..." ) )] = target;
+		removeActions[sendMenu->addAction( tr( "Remove" ) )] = target;
+	}
+
+	QAction * a = menu.exec( _pos );
+	if( a == NULL )
+	{
+		return;
+	}
+
+	bool ok;
+	if( a == addSendAction )
+	{
+		const int target = QInputDialog::getInteger( this,
+				tr( "Add send" ),
+				tr( "Send output of this channel to FX channel:" ),
+				0, 0, m->numChannels() - 1, 1, &ok );
+		if( ok && !m->addSend( ch, target ) )
+		{
+			QMessageBox::warning( this, tr( "Add send" ),
+				tr( "Sending to this channel is not possible as "
+					"it would create a feedback loop." ) );
+		}
+	}
+	else if( amountActions.contains( a ) )
+	{
+		const fx_ch_t target = amountActions[a];
+		for( FxSendVector::ConstIterator it = sends.begin(); it != sends.end(); ++it )
+		{
+			if( ( *it )->m_target != target )
+			{
+				continue;
+			}
+			const double amount = QInputDialog::getDouble( this,
+					tr( "Send amount" ),
+					tr( "Amount of send (in percent):" ),
+					( *it )->m_amountModel.value() * 100,
+					0, 200, 0, &ok );
+			if( ok )
+			{
+				( *it )->m_amountModel.setValue( amount / 100 );
+			}
+			break;
+		}
+	}
+	else if( removeActions.contains( a ) )
+	{
+		m->removeSend( ch, removeActions[a] );
 	}
 }
 
@@ -323,7 +531,7 @@ void FxMixerView::setCurrentFxLine( int _line )
 
 void FxMixerView::clear()
 {
-	for( int i = 0; i <= NumFxChannels; ++i )
+	for( int i = 0; i < m_fxChannelViews.size(); ++i )
 	{
 		m_fxChannelViews[i].m_rackView->clearViews();
 	}
@@ -335,7 +543,7 @@ void FxMixerView::clear()
 void FxMixerView::updateFaders()
 {
 	FxMixer * m = engine::fxMixer();
-	for( int i = 0; i < NumFxChannels+1; ++i )
+	for( int i = 0; i < m_fxChannelViews.size() && i < m->numChannels(); ++i )
 	{
 		const float opl = m_fxChannelViews[i].m_fader->getPeak_L();
 		const float opr = m_fxChannelViews[i].m_fader->getPeak_R();
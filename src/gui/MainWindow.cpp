@@ -40,6 +40,7 @@
 #include "bb_editor.h"
 #include "SongEditor.h"
 #include "song.h"
+#include "DataFile.h"
 #include "PianoRoll.h"
 #include "embed.h"
 #include "engine.h"
@@ -53,6 +54,7 @@
 #include "SideBar.h"
 #include "config_mgr.h"
 #include "Mixer.h"
+#include "PluginManifest.h"
 #include "PluginView.h"
 #include "project_notes.h"
 #include "setup_dialog.h"
@@ -73,7 +75,9 @@ MainWindow::MainWindow() :
 	m_templatesMenu( NULL ),
 	m_recentlyOpenedProjectsMenu( NULL ),
 	m_toolsMenu( NULL ),
-	m_autoSaveTimer( this )
+	m_autoSaveTimer( this ),
+	m_autoSaveThread(),
+	m_autoSaveRevision( -1 )
 {
 	setAttribute( Qt::WA_DeleteOnClose );
 
@@ -98,7 +102,7 @@ MainWindow::MainWindow() :
 	sideBar->appendTab( new fileBrowser(
 				configManager::inst()->userProjectsDir() + "*" +
 				configManager::inst()->factoryProjectsDir(),
-					"*.mmp *.mmpz *.xml *.mid *.flp",
+					"*.mmp *.mmpz *.mmpb *.xml *.mid *.flp",
 							tr( "My projects" ),
 					embed::getIconPixmap( "project_file" ).transformed( QTransform().rotate( 90 ) ),
 							splitter ) );
@@ -295,17 +299,13 @@ void MainWindow::finalize()
 
 	m_toolsMenu = new QMenu( this );
 	Plugin::DescriptorList pluginDescriptors;
-	Plugin::getDescriptorsOfAvailPlugins( pluginDescriptors );
+	PluginManifest::descriptorsOfType( Plugin::Tool, pluginDescriptors );
 	for( Plugin::DescriptorList::ConstIterator it = pluginDescriptors.begin();
 										it != pluginDescriptors.end(); ++it )
 	{
-		if( it->type == Plugin::Tool )
-		{
-			m_toolsMenu->addAction( it->logo->pixmap(),
-							it->displayName );
-			m_tools.push_back( ToolPlugin::instantiate( it->name,
+		m_toolsMenu->addAction( it->logo->pixmap(), it->displayName );
+		m_tools.push_back( ToolPlugin::instantiate( it->name,
 					/*this*/NULL )->createView( this ) );
-		}
 	}
 	if( !m_toolsMenu->isEmpty() )
 	{
@@ -706,7 +706,7 @@ void MainWindow::openProject()
 {
 	if( mayChangeProject() )
 	{
-		FileDialog ofd( this, tr( "Open project" ), "", tr( "LMMS (*.mmp *.mmpz)" ) );
+		FileDialog ofd( this, tr( "Open project" ), "", tr( "LMMS (*.mmp *.mmpz *.mmpb)" ) );
 
 		ofd.setDirectory( configManager::inst()->userProjectsDir() );
 		ofd.setFileMode( FileDialog::ExistingFiles );
@@ -770,6 +770,7 @@ bool MainWindow::saveProjectAs()
 {
 	VersionedSaveDialog sfd( this, tr( "Save project" ), "",
 			tr( "LMMS Project (*.mmpz *.mmp);;"
+				"LMMS Binary Project (*.mmpb);;"
 				"LMMS Project Template (*.mpt)" ) );
 	QString f = engine::getSong()->projectFileName();
 	if( f != "" )
@@ -985,9 +986,14 @@ void MainWindow::closeEvent( QCloseEvent * _ce )
 {
 	if( mayChangeProject() )
 	{
+		// make sure no auto-save in progress re-creates the recovery
+		// file after we deleted it
+		m_autoSaveTimer.stop();
+		m_autoSaveThread.wait();
+
 		// delete recovery file
 		QDir working(configManager::inst()->workingDir());
-		working.remove("recover.mmp");
+		working.remove("recover.mmpz");
 		_ce->accept();
 	}
 	else
@@ -1129,16 +1135,34 @@ void MainWindow::browseHelp()
 
 void MainWindow::autoSave()
 {
-	if( !( engine::getSong()->isPlaying() ||
-			engine::getSong()->isExporting() ) )
-	{
-		QDir work(configManager::inst()->workingDir());
-		engine::getSong()->saveProjectFile(work.absoluteFilePath("recover.mmp"));
-	}
-	else
+	if( engine::getSong()->isExporting() || m_autoSaveThread.isRunning() )
 	{
 		// try again in 10 seconds
 		QTimer::singleShot( 10*1000, this, SLOT( autoSave() ) );
+		return;
+	}
+
+	// nothing changed since last auto-save?
+	const int revision = engine::projectJournal()->revision();
+	if( !engine::getSong()->isModified() || revision == m_autoSaveRevision )
+	{
+		return;
+	}
+
+	// only take a snapshot of the project's settings here as models must
+	// not change while being saved - embedded sample data is kept raw and
+	// encoded samples are cached, so unchanged samples cost nothing;
+	// base64-encoding, generating the XML, compressing and writing it is
+	// done in background
+	DataFile * dataFile = new DataFile( DataFile::SongProject );
+	dataFile->setKeepEmbeddedDataRaw();
+	engine::getSong()->saveProjectData( *dataFile );
+
+	QDir work(configManager::inst()->workingDir());
+	if( m_autoSaveThread.save( dataFile,
+							work.absoluteFilePath("recover.mmpz") ) )
+	{
+		m_autoSaveRevision = revision;
 	}
 }
 
@@ -1754,11 +1754,13 @@ void PianoRoll::mousePressEvent( QMouseEvent * _me )
 						if( newNotes.size() != 0 )
 						{
 							//put notes from vector into piano roll
+							m_pattern->beginBatchEdit();
 							for( int i=0; i<newNotes.size(); ++i)
 							{
 								note * newNote = m_pattern->addNote( newNotes[i] );
 								newNote->setSelected( false );
 							}
+							m_pattern->commitBatchEdit();
 
 							// added new notes, so must update engine, song, etc
 							engine::getSong()->setModified();
@@ -3698,6 +3700,7 @@ void PianoRoll::pasteNotes()
 			m_pattern->addJournalCheckPoint();
 		}
 
+		m_pattern->beginBatchEdit();
 		for( int i = 0; !list.item( i ).isNull(); ++i )
 		{
 			// create the note
@@ -3711,6 +3714,7 @@ void PianoRoll::pasteNotes()
 			// add to pattern
 			m_pattern->addNote( cur_note );
 		}
+		m_pattern->commitBatchEdit();
 
 		// we only have to do the following lines if we pasted at
 		// least one note...
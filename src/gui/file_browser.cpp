@@ -954,7 +954,7 @@ void fileItem::determineFileType( void )
 	m_handling = NotSupported;
 
 	const QString ext = extension();
-	if( ext == "mmp" || ext == "mpt" || ext == "mmpz" )
+	if( ext == "mmp" || ext == "mpt" || ext == "mmpz" || ext == "mmpb" )
 	{
 		m_type = ProjectFile;
 		m_handling = LoadAsProject;
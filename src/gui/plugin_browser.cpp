@@ -35,9 +35,11 @@
 #include "string_pair_drag.h"
 
 
-bool pluginBefore( const Plugin::Descriptor& d1, const Plugin::Descriptor& d2 )
+bool pluginBefore( const PluginManifest::Entry& e1,
+					const PluginManifest::Entry& e2 )
 {
-	return qstricmp( d1.displayName, d2.displayName ) < 0 ? true : false;
+	return QString::compare( e1.displayName, e2.displayName,
+										Qt::CaseInsensitive ) < 0;
 }
 
 
@@ -67,11 +69,13 @@ pluginBrowser::pluginBrowser( QWidget * _parent ) :
 	hint->setWordWrap( true );
 	view_layout->addWidget( hint );
 
-	Plugin::getDescriptorsOfAvailPlugins( m_pluginDescriptors );
-	qSort( m_pluginDescriptors.begin(), m_pluginDescriptors.end(), pluginBefore );
+	// use manifest so instrument libraries are not loaded before their
+	// logos are actually shown
+	PluginManifest::EntryList entries = PluginManifest::entries();
+	qSort( entries.begin(), entries.end(), pluginBefore );
 
-	for( Plugin::DescriptorList::ConstIterator it = m_pluginDescriptors.begin();
-										it != m_pluginDescriptors.end(); ++it )
+	for( PluginManifest::EntryList::ConstIterator it = entries.begin();
+												it != entries.end(); ++it )
 	{
 		if( it->type == Plugin::Instrument )
 		{
@@ -97,12 +101,13 @@ pluginBrowser::~pluginBrowser()
 
 
 
-pluginDescWidget::pluginDescWidget( const Plugin::Descriptor & _pd,
+pluginDescWidget::pluginDescWidget( const PluginManifest::Entry & _pe,
 							QWidget * _parent ) :
 	QWidget( _parent ),
 	m_updateTimer( this ),
-	m_pluginDescriptor( _pd ),
-	m_logo( _pd.logo->pixmap() ),
+	m_pluginEntry( _pe ),
+	m_logo(),
+	m_logoLoaded( false ),
 	m_mouseOver( false ),
 	m_targetHeight( 24 )
 {
@@ -122,6 +127,24 @@ pluginDescWidget::~pluginDescWidget()
 
 
 
+const QPixmap & pluginDescWidget::logo()
+{
+	if( !m_logoLoaded )
+	{
+		const Plugin::Descriptor * desc =
+					PluginManifest::descriptor( m_pluginEntry );
+		if( desc != NULL && desc->logo != NULL )
+		{
+			m_logo = desc->logo->pixmap();
+		}
+		m_logoLoaded = true;
+	}
+	return m_logo;
+}
+
+
+
+
 void pluginDescWidget::paintEvent( QPaintEvent * )
 {
 	const QColor fill_color = m_mouseOver ? QColor( 224, 224, 224 ) :
@@ -133,17 +156,17 @@ void pluginDescWidget::paintEvent( QPaintEvent * )
 	const int s = 16 + ( 32 * ( tLimit( height(), 24, 60 ) - 24 ) ) /
 								( 60 - 24 );
 	const QSize logo_size( s, s );
-	QPixmap logo = m_logo.scaled( logo_size, Qt::KeepAspectRatio,
+	QPixmap scaled_logo = logo().scaled( logo_size, Qt::KeepAspectRatio,
 						Qt::SmoothTransformation );
 	p.setPen( QColor( 64, 64, 64 ) );
 	p.drawRect( 0, 0, rect().right(), rect().bottom() );
-	p.drawPixmap( 4, 4, logo );
+	p.drawPixmap( 4, 4, scaled_logo );
 
 	QFont f = pointSize<8>( p.font() );
 	f.setBold( true );
 	p.setFont( f );
 	p.drawText( 10 + logo_size.width(), 15,
-					m_pluginDescriptor.displayName );
+					m_pluginEntry.displayName );
 
 	if( height() > 24 || m_mouseOver )
 	{
@@ -152,7 +175,7 @@ void pluginDescWidget::paintEvent( QPaintEvent * )
 		QRect br;
 		p.drawText( 10 + logo_size.width(), 20, width() - 58 - 5, 999,
 							Qt::TextWordWrap,
-			pluginBrowser::tr( m_pluginDescriptor.description ),
+			pluginBrowser::tr( m_pluginEntry.description.toUtf8().constData() ),
 								&br );
 		if( m_mouseOver )
 		{
@@ -191,8 +214,8 @@ void pluginDescWidget::mousePressEvent( QMouseEvent * _me )
 {
 	if( _me->button() == Qt::LeftButton )
 	{
-		new stringPairDrag( "instrument", m_pluginDescriptor.name,
-								m_logo, this );
+		new stringPairDrag( "instrument", m_pluginEntry.name,
+								logo(), this );
 		leaveEvent( _me );
 	}
 }
@@ -34,6 +34,7 @@
 #include "LcdSpinBox.h"
 #include "caption_menu.h"
 #include "engine.h"
+#include "ProjectJournal.h"
 #include "embed.h"
 #include "gui_templates.h"
 #include "templates.h"
@@ -105,6 +106,9 @@ void LcdSpinBox::mousePressEvent( QMouseEvent* event )
 		m_origMousePos = event->globalPos();
 		QApplication::setOverrideCursor( Qt::BlankCursor );
 
+		// the whole drag is undone at once
+		engine::projectJournal()->beginInteraction();
+
 		AutomatableModel *thisModel = model();
 		if( thisModel )
 		{
@@ -150,6 +154,7 @@ void LcdSpinBox::mouseReleaseEvent( QMouseEvent* )
 		QCursor::setPos( m_origMousePos );
 		QApplication::restoreOverrideCursor();
 
+		engine::projectJournal()->endInteraction();
 		m_mouseMoving = false;
 	}
 }
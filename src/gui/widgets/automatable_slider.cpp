@@ -31,6 +31,7 @@
 #include "caption_menu.h"
 #include "embed.h"
 #include "engine.h"
+#include "ProjectJournal.h"
 #include "MainWindow.h"
 
 
@@ -76,6 +77,8 @@ void automatableSlider::mousePressEvent( QMouseEvent * _me )
 	   ! ( _me->modifiers() & Qt::ControlModifier ) )
 	{
 		m_showStatus = true;
+		// the whole drag (including linked models) is undone at once
+		engine::projectJournal()->beginInteraction();
 		QSlider::mousePressEvent( _me );
 	}
 	else
@@ -89,6 +92,10 @@ void automatableSlider::mousePressEvent( QMouseEvent * _me )
 
 void automatableSlider::mouseReleaseEvent( QMouseEvent * _me )
 {
+	if( m_showStatus )
+	{
+		engine::projectJournal()->endInteraction();
+	}
 	m_showStatus = false;
 	QSlider::mouseReleaseEvent( _me );
 }
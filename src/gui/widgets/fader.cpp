@@ -53,6 +53,7 @@
 #include "fader.h"
 #include "embed.h"
 #include "engine.h"
+#include "ProjectJournal.h"
 #include "caption_menu.h"
 #include "config_mgr.h"
 #include "text_float.h"
@@ -140,6 +141,10 @@ void fader::mousePressEvent( QMouseEvent* mouseEvent )
 			m_moveStartPoint = mouseEvent->globalY();
 			m_startValue = model()->value();
 
+			// the whole drag (including linked models) is undone at
+			// once
+			engine::projectJournal()->beginInteraction();
+
 			mouseEvent->accept();
 		}
 		else
@@ -178,6 +183,12 @@ void fader::mouseDoubleClickEvent( QMouseEvent* mouseEvent )
 
 void fader::mouseReleaseEvent( QMouseEvent * _me )
 {
+	if( m_moveStartPoint >= 0 )
+	{
+		engine::projectJournal()->endInteraction();
+		m_moveStartPoint = -1;
+	}
+
 	s_textFloat->hide();
 }
 
@@ -467,6 +467,9 @@ void knob::mousePressEvent( QMouseEvent * _me )
 			! ( _me->modifiers() & Qt::ControlModifier ) &&
 			! ( _me->modifiers() & Qt::ShiftModifier ) )
 	{
+		// the whole drag (including linked models) is undone at once
+		engine::projectJournal()->beginInteraction();
+
 		AutomatableModel *thisModel = model();
 		if( thisModel )
 		{
@@ -531,6 +534,10 @@ void knob::mouseReleaseEvent( QMouseEvent* event )
 		}
 	}
 
+	if( m_buttonPressed )
+	{
+		engine::projectJournal()->endInteraction();
+	}
 	m_buttonPressed = false;
 
 	emit sliderReleased();
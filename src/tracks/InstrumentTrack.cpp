@@ -106,7 +106,7 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	m_panningModel( DefaultPanning, PanningLeft, PanningRight, 0.1f, this, tr( "Panning" ) ),
 	m_pitchModel( 0, MinPitchDefault, MaxPitchDefault, 1, this, tr( "Pitch" ) ),
 	m_pitchRangeModel( 1, 1, 24, this, tr( "Pitch range" ) ),
-	m_effectChannelModel( 0, 0, NumFxChannels, this, tr( "FX channel" ) ),
+	m_effectChannelModel( 0, 0, engine::fxMixer()->numChannels()-1, this, tr( "FX channel" ) ),
 	m_instrument( NULL ),
 	m_soundShaping( this ),
 	m_arpeggio( this ),
@@ -125,6 +125,11 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	connect( &m_pitchRangeModel, SIGNAL( dataChanged() ),
 				this, SLOT( updatePitchRange() ) );
 
+	// FX channels are created on demand so keep range of FX channel
+	// model up to date
+	connect( engine::fxMixer(), SIGNAL( dataChanged() ),
+				this, SLOT( updateEffectChannelRange() ) );
+
 	for( int i = 0; i < NumKeys; ++i )
 	{
 		m_notes[i] = NULL;
@@ -169,6 +174,9 @@ void InstrumentTrack::processAudioBuffer( sampleFrame* buf, const fpp_t frames,
 		// at least pass one silent buffer to allow
 		if( m_silentBuffersProcessed )
 		{
+			// no sound anymore - let instrument go to sleep if it has
+			// no active voices either
+			m_instrument->updateSleepState( true );
 			// skip further processing
 			return;
 		}
@@ -177,6 +185,7 @@ void InstrumentTrack::processAudioBuffer( sampleFrame* buf, const fpp_t frames,
 	else
 	{
 		m_silentBuffersProcessed = false;
+		m_instrument->updateSleepState( false );
 	}
 
 	// if effects "went to sleep" because there was no input, wake them up
@@ -337,9 +346,13 @@ void InstrumentTrack::processInEvent( const MidiEvent& event, const MidiTime& ti
 			break;
 	}
 
-	if( eventHandled == false && instrument()->handleMidiEvent( event, time ) == false )
+	if( eventHandled == false )
 	{
-		qWarning( "InstrumentTrack: unhandled MIDI event %d", event.type() );
+		instrument()->wakeUp();
+		if( instrument()->handleMidiEvent( event, time ) == false )
+		{
+			qWarning( "InstrumentTrack: unhandled MIDI event %d", event.type() );
+		}
 	}
 
 	engine::mixer()->unlock();
@@ -356,6 +369,9 @@ void InstrumentTrack::processOutEvent( const MidiEvent& event, const MidiTime& t
 		return;
 	}
 
+	// instrument might have gone to sleep as it didn't produce any sound
+	m_instrument->wakeUp();
+
 	const MidiEvent transposedEvent = applyMasterKey( event );
 	const int key = transposedEvent.key();
 
@@ -538,6 +554,39 @@ void InstrumentTrack::updatePitchRange()
 
 
 
+void InstrumentTrack::updateEffectChannelRange()
+{
+	m_effectChannelModel.setRange( 0, engine::fxMixer()->numChannels()-1 );
+}
+
+
+
+
+void InstrumentTrack::wakeUpInstrument()
+{
+	if( m_instrument != NULL )
+	{
+		m_instrument->wakeUp();
+	}
+}
+
+
+
+
+void InstrumentTrack::connectInstrumentModels()
+{
+	// changing a parameter of a sleeping instrument might make it produce
+	// sound again so wake it up
+	QList<AutomatableModel *> models = m_instrument->findChildren<AutomatableModel *>();
+	for( QList<AutomatableModel *>::Iterator it = models.begin(); it != models.end(); ++it )
+	{
+		connect( *it, SIGNAL( dataChanged() ), this, SLOT( wakeUpInstrument() ) );
+	}
+}
+
+
+
+
 int InstrumentTrack::masterKey( int _midi_key ) const
 {
 	int key = m_baseNoteModel.value() - engine::getSong()->masterPitch();
@@ -706,6 +755,9 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 	m_panningModel.loadSettings( thisElement, "pan" );
 	m_pitchRangeModel.loadSettings( thisElement, "pitchrange" );
 	m_pitchModel.loadSettings( thisElement, "pitch" );
+	// FX mixer is restored after tracks so make sure the channel we're
+	// routed to exists already
+	engine::fxMixer()->ensureChannelExists( thisElement.attribute( "fxch" ).toInt() );
 	m_effectChannelModel.loadSettings( thisElement, "fxch" );
 	m_baseNoteModel.loadSettings( thisElement, "basenote" );
 
@@ -743,6 +795,7 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 				m_instrument = NULL;
 				m_instrument = Instrument::instantiate( node.toElement().attribute( "name" ), this );
 				m_instrument->restoreState( node.firstChildElement() );
+				connectInstrumentModels();
 
 				emit instrumentChanged();
 			}
@@ -760,6 +813,7 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 				{
 					m_instrument->restoreState( node.toElement() );
 				}
+				connectInstrumentModels();
 				emit instrumentChanged();
 			}
 		}
@@ -780,6 +834,8 @@ Instrument * InstrumentTrack::loadInstrument( const QString & _plugin_name )
 	m_instrument = Instrument::instantiate( _plugin_name, this );
 	engine::mixer()->unlock();
 
+	connectInstrumentModels();
+
 	setName( m_instrument->displayName() );
 	emit instrumentChanged();
 
@@ -1190,7 +1246,7 @@ InstrumentTrackWindow::InstrumentTrackWindow( InstrumentTrackView * _itv ) :
 	basicControlsLayout->addStretch();
 
 	// setup spinbox for selecting FX-channel
-	m_effectChannelNumber = new fxLineLcdSpinBox( 2, NULL, tr( "FX channel" ) );
+	m_effectChannelNumber = new fxLineLcdSpinBox( 3, NULL, tr( "FX channel" ) );
 	m_effectChannelNumber->setLabel( tr( "FX" ) );
 
 	basicControlsLayout->addWidget( m_effectChannelNumber );
@@ -23,6 +23,7 @@
  *
  */
 
+#include <QtCore/QFile>
 #include <QtXml/QDomElement>
 #include <QtGui/QDropEvent>
 #include <QtGui/QMenu>
@@ -41,26 +42,37 @@
 #include "AudioPort.h"
 #include "SamplePlayHandle.h"
 #include "SampleRecordHandle.h"
+#include "SampleStreamWriter.h"
 #include "string_pair_drag.h"
 #include "knob.h"
 #include "MainWindow.h"
 #include "EffectRackView.h"
 #include "track_label_button.h"
 #include "config_mgr.h"
+#include "DataFile.h"
 
 
 SampleTCO::SampleTCO( track * _track ) :
 	trackContentObject( _track ),
-	m_sampleBuffer( new SampleBuffer )
+	m_sampleBuffer( new SampleBuffer ),
+	m_recordWriter( NULL ),
+	m_recordWriterInUse( false )
 {
 	saveJournallingState( false );
 	setSampleFile( "" );
 	restoreJournallingState();
 
+	// views need to redraw once waveform peaks have been calculated
+	connect( m_sampleBuffer, SIGNAL( peaksReady() ),
+					this, SIGNAL( sampleChanged() ) );
+
 	// we need to receive bpm-change-events, because then we have to
 	// change length of this TCO
 	connect( engine::getSong(), SIGNAL( tempoChanged( bpm_t ) ),
 					this, SLOT( updateLength( bpm_t ) ) );
+
+	connect( &m_recordModel, SIGNAL( dataChanged() ),
+					this, SLOT( updateRecordWriter() ) );
 }
 
 
@@ -68,6 +80,12 @@ SampleTCO::SampleTCO( track * _track ) :
 
 SampleTCO::~SampleTCO()
 {
+	if( m_recordWriter != NULL )
+	{
+		const QString file = m_recordWriter->fileName();
+		delete m_recordWriter;
+		QFile::remove( file );
+	}
 	sharedObject::unref( m_sampleBuffer );
 }
 
@@ -91,8 +109,11 @@ const QString & SampleTCO::sampleFile() const
 
 void SampleTCO::setSampleBuffer( SampleBuffer* sb )
 {
+	m_sampleBuffer->disconnect( this );
 	sharedObject::unref( m_sampleBuffer );
 	m_sampleBuffer = sb;
+	connect( m_sampleBuffer, SIGNAL( peaksReady() ),
+					this, SIGNAL( sampleChanged() ) );
 	updateLength();
 
 	emit sampleChanged();
@@ -120,6 +141,88 @@ void SampleTCO::toggleRecord()
 
 
 
+SampleStreamWriter * SampleTCO::startRecording()
+{
+	// we're called with mixer locked, so no need to lock anything here
+	if( m_recordWriter == NULL || m_recordWriterInUse ||
+						!m_recordWriter->isOpen() )
+	{
+		return NULL;
+	}
+	m_recordWriterInUse = true;
+	return m_recordWriter;
+}
+
+
+
+
+void SampleTCO::finishRecording()
+{
+	if( m_recordWriter == NULL )
+	{
+		return;
+	}
+
+	engine::mixer()->lock();
+	SampleStreamWriter * writer = m_recordWriter;
+	m_recordWriter = NULL;
+	m_recordWriterInUse = false;
+	engine::mixer()->unlock();
+
+	writer->finish();
+	if( writer->framesWritten() > 0 )
+	{
+		setSampleFile( writer->fileName() );
+	}
+	else
+	{
+		QFile::remove( writer->fileName() );
+	}
+	delete writer;
+
+	setRecord( false );
+}
+
+
+
+
+void SampleTCO::updateRecordWriter()
+{
+	if( isRecord() && m_recordWriter == NULL )
+	{
+		SampleStreamWriter * writer = new SampleStreamWriter(
+					SampleStreamWriter::newRecordingFile(),
+					engine::mixer()->inputSampleRate() );
+		engine::mixer()->lock();
+		m_recordWriter = writer;
+		m_recordWriterInUse = false;
+		engine::mixer()->unlock();
+	}
+	else if( !isRecord() && m_recordWriter != NULL )
+	{
+		engine::mixer()->lock();
+		// a running SampleRecordHandle keeps recording and cleans up
+		// through finishRecording()
+		SampleStreamWriter * writer = m_recordWriterInUse ?
+							NULL : m_recordWriter;
+		if( writer != NULL )
+		{
+			m_recordWriter = NULL;
+		}
+		engine::mixer()->unlock();
+
+		if( writer != NULL )
+		{
+			const QString file = writer->fileName();
+			delete writer;
+			QFile::remove( file );
+		}
+	}
+}
+
+
+
+
 void SampleTCO::updateLength( bpm_t )
 {
 	changeLength( sampleLength() );
@@ -151,8 +254,7 @@ void SampleTCO::saveSettings( QDomDocument & _doc, QDomElement & _this )
 	_this.setAttribute( "src", sampleFile() );
 	if( sampleFile() == "" )
 	{
-		QString s;
-		_this.setAttribute( "data", m_sampleBuffer->toBase64( s ) );
+		DataFile::setEmbeddedData( _this, "data", m_sampleBuffer->toData() );
 	}
 	// TODO: start- and end-frame
 }
@@ -167,9 +269,9 @@ void SampleTCO::loadSettings( const QDomElement & _this )
 		movePosition( _this.attribute( "pos" ).toInt() );
 	}
 	setSampleFile( _this.attribute( "src" ) );
-	if( sampleFile().isEmpty() && _this.hasAttribute( "data" ) )
+	if( sampleFile().isEmpty() && DataFile::hasEmbeddedData( _this, "data" ) )
 	{
-		m_sampleBuffer->loadFromBase64( _this.attribute( "data" ) );
+		m_sampleBuffer->loadFromData( DataFile::embeddedData( _this, "data" ) );
 	}
 	changeLength( _this.attribute( "len" ).toInt() );
 	setMuted( _this.attribute( "muted" ).toInt() );
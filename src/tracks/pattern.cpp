@@ -62,7 +62,8 @@ pattern::pattern( InstrumentTrack * _instrument_track ) :
 	trackContentObject( _instrument_track ),
 	m_instrumentTrack( _instrument_track ),
 	m_patternType( BeatPattern ),
-	m_steps( MidiTime::stepsPerTact() )
+	m_steps( MidiTime::stepsPerTact() ),
+	m_batchEditDepth( 0 )
 {
 	setName( _instrument_track->name() );
 	init();
@@ -75,7 +76,8 @@ pattern::pattern( const pattern & _pat_to_copy ) :
 	trackContentObject( _pat_to_copy.m_instrumentTrack ),
 	m_instrumentTrack( _pat_to_copy.m_instrumentTrack ),
 	m_patternType( _pat_to_copy.m_patternType ),
-	m_steps( _pat_to_copy.m_steps )
+	m_steps( _pat_to_copy.m_steps ),
+	m_batchEditDepth( 0 )
 {
 	for( NoteVector::ConstIterator it = _pat_to_copy.m_notes.begin();
 					it != _pat_to_copy.m_notes.end(); ++it )
@@ -174,6 +176,13 @@ note * pattern::addNote( const note & _new_note, const bool _quant_pos )
 		new_note->quantizePos( engine::pianoRoll()->quantization() );
 	}
 
+	if( m_batchEditDepth > 0 )
+	{
+		// mixer is locked already, commitBatchEdit() sorts
+		m_notes.push_back( new_note );
+		return new_note;
+	}
+
 	engine::mixer()->lock();
 	if( m_notes.size() == 0 || m_notes.back()->pos() <= new_note->pos() )
 	{
@@ -274,6 +283,47 @@ void pattern::rearrangeAllNotes()
 
 
 
+
+static bool notePosLessThan( const note * _lhs, const note * _rhs )
+{
+	return _lhs->pos() < _rhs->pos();
+}
+
+
+
+
+void pattern::beginBatchEdit()
+{
+	if( m_batchEditDepth++ == 0 )
+	{
+		engine::mixer()->lock();
+	}
+}
+
+
+
+
+void pattern::commitBatchEdit()
+{
+	if( m_batchEditDepth == 0 || --m_batchEditDepth > 0 )
+	{
+		return;
+	}
+
+	// keep notes at same position in the order they were added
+	qStableSort( m_notes.begin(), m_notes.end(), notePosLessThan );
+	engine::mixer()->unlock();
+
+	checkType();
+	changeLength( length() );
+
+	emit dataChanged();
+
+	updateBBTrack();
+}
+
+
+
 void pattern::clearNotes()
 {
 	engine::mixer()->lock();